@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "../XMapLib_Keyboard/KeyboardBatchTranslationEngine.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestBatchTranslationEngine)
+	{
+		TEST_METHOD(PrimaryTest)
+		{
+			using namespace std::chrono_literals;
+			constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+			constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
+			constexpr std::size_t JobCount{ 37 };
+			constexpr std::size_t StreamLength{ 200 };
+
+			// The stream is recorded an update per millisecond, the repeat and reset delays are judged against the recorded time points, so the
+			// events do not depend on how fast the batch runs: a down, repeats at 10, 20, 30 and 40 ms, the up at 50 ms and the reset at 60 ms.
+			const auto GetTranslator = []()
+			{
+				return sds::KeyboardTranslator{ std::vector{
+					sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .DelayBeforeFirstRepeat = 9500us, .DelayForRepeats = 9500us },
+					sds::CBActionMap{ .ButtonVirtualKeycode = buttonB, .DelayBeforeFirstRepeat = 9500us, .DelayForRepeats = 9500us } } };
+			};
+			const auto startTime = TimeManagement::Clock_t::now();
+			std::vector<sds::RecordedStateUpdate> stream;
+			for (std::size_t i{}; i < StreamLength; ++i)
+				stream.emplace_back(sds::RecordedStateUpdate{ .TimePoint = startTime + i * 1ms, .DownKeys = i < 50 ? sds::StateUpdate_t{ buttonA, buttonB } : sds::StateUpdate_t{} });
+
+			std::vector<sds::KeyboardTranslator<>> translators;
+			std::vector<sds::BatchTranslationJob<sds::KeyboardTranslator<>>> jobs;
+			translators.reserve(JobCount);
+			for (std::size_t i{}; i < JobCount; ++i)
+			{
+				translators.emplace_back(GetTranslator());
+				jobs.emplace_back(translators.back(), stream);
+			}
+
+			sds::BatchTranslationEngine<sds::KeyboardTranslator<>> engine{ 4 };
+			const auto stats = engine.Run(jobs);
+			Assert::IsTrue(stats.JobCount == JobCount);
+			Assert::IsTrue(stats.UpdateCount == JobCount * StreamLength, L"Not every state update was translated.");
+			Assert::IsTrue(stats.EventCount == JobCount * 2 * 7, L"Events not judged against the recorded time points.");
+			Assert::IsTrue(std::ranges::all_of(translators, [](auto& t) { return t.GetMappingState(0).IsInitialState() && t.GetMappingState(1).IsInitialState(); }));
+
+			const auto eventsPerSecond = stats.GetEventsPerSecond();
+			Logger::WriteMessage(std::vformat("Batch events/s: {}, stolen jobs: {}\n", std::make_format_args(eventsPerSecond, stats.StolenJobCount)).c_str());
+		}
+	};
+}
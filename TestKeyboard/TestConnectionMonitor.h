@@ -0,0 +1,131 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardConnectionMonitor.h"
+#include "../XMapLib_Keyboard/KeyboardScriptedBackends.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestConnectionMonitor)
+	{
+		struct ScheduleClock
+		{
+			static inline TimeManagement::TimePoint_t Now{};
+			static auto now() noexcept -> TimeManagement::TimePoint_t { return Now; }
+		};
+
+		// Connection probe of a pad on slot 0 that the test plugs in and pulls out.
+		struct SwitchedConnectionProbe
+		{
+			std::shared_ptr<std::atomic<bool>> IsPadPresent{ std::make_shared<std::atomic<bool>>() };
+			[[nodiscard]] auto IsConnected(const std::size_t playerId) const -> bool { return playerId == 0 && IsPadPresent->load(); }
+		};
+
+		// Waits for the monitor thread to publish the connected flag, false on timeout.
+		template<typename Monitor_t>
+		static auto WaitForConnected(const Monitor_t& monitor, const std::size_t playerId, const bool isConnected) -> bool
+		{
+			const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+			while (monitor.IsConnected(playerId) != isConnected)
+			{
+				if (std::chrono::steady_clock::now() > endTime)
+					return false;
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+			}
+			return true;
+		}
+
+		// Waits for the monitor thread to perform the number of probes, false on timeout.
+		template<typename Monitor_t>
+		static auto WaitForProbeCount(const Monitor_t& monitor, const std::uint64_t probeCount) -> bool
+		{
+			const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+			while (monitor.GetProbeCount() < probeCount)
+			{
+				if (std::chrono::steady_clock::now() > endTime)
+					return false;
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+			}
+			return true;
+		}
+	public:
+		TEST_METHOD(BackoffScheduleTest)
+		{
+			using namespace std::chrono_literals;
+			const auto startTime = TimeManagement::Clock_t::now();
+			// Player 0 connects at 35ms, drops out at 500ms and is back at 520ms. Player 1 never connects.
+			sds::ScriptedConnectionProbe<ScheduleClock> probe{ {
+				{ .Offset = 35ms, .PlayerId = 0, .IsConnected = true },
+				{ .Offset = 500ms, .PlayerId = 0, .IsConnected = false },
+				{ .Offset = 520ms, .PlayerId = 0, .IsConnected = true } }, startTime };
+			sds::ConnectionProbeSchedule schedule{ 2, sds::ConnectionBackoff{ .InitialDelay = 10ms, .MaxDelay = 80ms }, startTime };
+
+			for (auto offset = 0ms; offset <= 1000ms; offset += 1ms)
+			{
+				ScheduleClock::Now = startTime + offset;
+				// The polling loop finds the pad gone.
+				if (offset == 500ms)
+					schedule.SetDisconnected(0, ScheduleClock::Now);
+				schedule.ProbeDue(probe, ScheduleClock::Now);
+
+				if (offset == 69ms)
+					Assert::IsFalse(schedule.IsConnected(0), L"Connected before the probe due at 70ms.");
+				if (offset == 70ms)
+					Assert::IsTrue(schedule.IsConnected(0), L"Not connected at the probe due at 70ms.");
+				if (offset == 529ms)
+					Assert::IsFalse(schedule.IsConnected(0));
+				if (offset == 530ms)
+					Assert::IsTrue(schedule.IsConnected(0), L"Not re-connected at the probe due at 530ms.");
+			}
+			// Player 0 probed at 0, 10, 30 and 70ms, then at 510 and 530ms. Player 1 at 0, 10, 30, 70 and 150ms, then every 80ms.
+			Assert::IsTrue(probe.GetProbeCount(0) == 6, L"Connected slot probed, or backoff wrong.");
+			Assert::IsTrue(probe.GetProbeCount(1) == 15, L"Backoff of the empty slot wrong.");
+			Assert::IsTrue(schedule.GetProbeCount() == 21);
+			Assert::IsTrue(schedule.GetNextProbeTime() == startTime + 1030ms);
+			Assert::IsFalse(schedule.IsConnected(1));
+		}
+
+		TEST_METHOD(MonitorThreadTest)
+		{
+			using namespace std::chrono_literals;
+			SwitchedConnectionProbe probe;
+			const auto isPadPresent = probe.IsPadPresent;
+			isPadPresent->store(true);
+			sds::ControllerConnectionMonitor monitor{ std::move(probe), 2, sds::ConnectionBackoff{ .InitialDelay = 1ms, .MaxDelay = 8ms } };
+			Assert::IsTrue(WaitForConnected(monitor, 0, true), L"Connection not published.");
+			Assert::IsFalse(monitor.IsConnected(1));
+			Assert::IsFalse(monitor.IsConnected(4), L"Slot not monitored reported connected.");
+
+			// The pad is pulled out, the reported disconnection is seen at once and is not overwritten by the monitor thread's publishing
+			// while it goes on probing (slot 1 as well).
+			isPadPresent->store(false);
+			monitor.ReportDisconnected(0);
+			Assert::IsFalse(monitor.IsConnected(0));
+			Assert::IsTrue(WaitForProbeCount(monitor, monitor.GetProbeCount() + 6));
+			Assert::IsFalse(monitor.IsConnected(0), L"Reported disconnection overwritten.");
+
+			// Plugged back in, the reported slot is probed and found connected again.
+			isPadPresent->store(true);
+			Assert::IsTrue(WaitForConnected(monitor, 0, true), L"Reported slot not re-probed.");
+			monitor.Stop();
+			Assert::IsTrue(monitor.GetProbeCount() > 2);
+		}
+
+		TEST_METHOD(InvalidConfigurationTest)
+		{
+			using namespace std::chrono_literals;
+			const auto startTime = TimeManagement::Clock_t::now();
+			Assert::ExpectException<std::runtime_error>([&]() { sds::ConnectionProbeSchedule schedule{ 0, {}, startTime }; });
+			Assert::ExpectException<std::runtime_error>([&]() { sds::ConnectionProbeSchedule schedule{ sds::controllercodes::MaxPlayerCount + 1, {}, startTime }; });
+			Assert::ExpectException<std::runtime_error>([&]() { sds::ConnectionProbeSchedule schedule{ 1, sds::ConnectionBackoff{ .InitialDelay = 0ms }, startTime }; });
+			Assert::ExpectException<std::runtime_error>([&]() { sds::ConnectionProbeSchedule schedule{ 1, sds::ConnectionBackoff{ .InitialDelay = 10ms, .MaxDelay = 5ms }, startTime }; });
+		}
+	};
+}
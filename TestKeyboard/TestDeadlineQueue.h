@@ -0,0 +1,62 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "../XMapLib_Keyboard/KeyboardDeadlineQueue.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestDeadlineQueue)
+	{
+		TEST_METHOD(PrimaryTest)
+		{
+			using namespace std::chrono_literals;
+			const auto startTime = TimeManagement::Clock_t::now();
+
+			sds::DeadlineQueue dq{ 4 };
+			Assert::IsFalse(dq.GetEarliestDeadline().has_value());
+			Assert::IsTrue(dq.PopElapsed(startTime + 1h).none());
+
+			dq.Schedule(0, startTime + 10ms);
+			dq.Schedule(1, startTime + 5ms);
+			dq.Schedule(2, startTime + 20ms);
+			Assert::IsTrue(dq.GetEarliestDeadline() == startTime + 5ms);
+
+			// Nothing has passed yet, and a deadline is not passed at exactly the deadline.
+			Assert::IsTrue(dq.PopElapsed(startTime).none());
+			Assert::IsTrue(dq.PopElapsed(startTime + 5ms).none());
+
+			const auto elapsed = dq.PopElapsed(startTime + 11ms);
+			Assert::IsTrue(elapsed.count() == 2);
+			Assert::IsTrue(elapsed[0] && elapsed[1]);
+			Assert::IsTrue(dq.GetEarliestDeadline() == startTime + 20ms);
+
+			// Re-scheduling supersedes the earlier deadline, cancelling removes it.
+			dq.Schedule(2, startTime + 30ms);
+			Assert::IsTrue(dq.PopElapsed(startTime + 25ms).none());
+			dq.Cancel(2);
+			Assert::IsFalse(dq.GetEarliestDeadline().has_value());
+		}
+
+		TEST_METHOD(CoalescingTest)
+		{
+			using namespace std::chrono_literals;
+			const auto startTime = TimeManagement::Clock_t::now();
+
+			sds::DeadlineQueue dq{ 4 };
+			dq.SetCoalescingSlack(2ms);
+			dq.Schedule(0, startTime + 10ms);
+			dq.Schedule(1, startTime + 11ms);
+			dq.Schedule(3, startTime + 20ms);
+
+			// Within the slack of the earliest deadline, nothing is serviced.
+			Assert::IsTrue(dq.PopElapsed(startTime + 11500us).none());
+
+			// Slack has run out for the earliest, both passed deadlines are serviced together.
+			const auto elapsed = dq.PopElapsed(startTime + 12500us);
+			Assert::IsTrue(elapsed.count() == 2);
+			Assert::IsTrue(elapsed[0] && elapsed[1]);
+		}
+	};
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardEvdevDecoder.h"
+#include "../XMapLib_Keyboard/KeyboardStateDecoder.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestEvdevDecoder)
+	{
+		static constexpr sds::KeyboardSettings ksp;
+
+		static constexpr auto Key(const std::uint16_t code, const std::int32_t value) -> sds::EvdevEvent
+		{
+			return { .Type = sds::evdevcodes::EventKey, .Code = code, .Value = value };
+		}
+
+		static constexpr auto Abs(const std::uint16_t code, const std::int32_t value) -> sds::EvdevEvent
+		{
+			return { .Type = sds::evdevcodes::EventAbs, .Code = code, .Value = value };
+		}
+
+		static constexpr auto Syn(const std::uint16_t code = sds::evdevcodes::SynReport) -> sds::EvdevEvent
+		{
+			return { .Type = sds::evdevcodes::EventSyn, .Code = code };
+		}
+
+		static auto GetSortedDownKeys(const sds::ControllerState& state)
+		{
+			const auto downKeys = sds::GetDownVirtualKeycodesRange(ksp, state);
+			std::vector<sds::keyboardtypes::VirtualKey_t> sortedKeys(downKeys.begin(), downKeys.end());
+			std::ranges::sort(sortedKeys);
+			return sortedKeys;
+		}
+	public:
+		TEST_METHOD(ButtonsAndAxesTest)
+		{
+			using namespace sds::evdevcodes;
+			sds::EvdevStateDecoder decoder;
+			sds::ControllerStateBuffer_t states;
+			const std::array events{ Key(ButtonA, 1), Key(ButtonY, 1), Key(ButtonSelect, 1), Key(ButtonLeftShoulder, 1), Key(ButtonRightThumb, 1),
+				Key(ButtonTriggerHappy2, 1), Abs(AxisX, -20000), Abs(AxisY, 20000), Abs(AxisRx, 0), Abs(AxisRy, -32768),
+				Abs(AxisZ, 255), Abs(AxisRz, 10), Abs(AxisHat0Y, 1), Syn() };
+			Assert::IsTrue(decoder.Decode(events, states) == 1 && states.size() == 1);
+
+			const sds::ControllerState expectedState{ .PacketNumber = 1,
+				.Buttons = static_cast<std::uint16_t>(sds::controllercodes::A | sds::controllercodes::Y | sds::controllercodes::Back | sds::controllercodes::LeftShoulder
+					| sds::controllercodes::RightThumb | sds::controllercodes::DpadRight | sds::controllercodes::DpadDown),
+				.LeftTrigger = 255, .RightTrigger = 10, .LeftStickX = -20000, .LeftStickY = -20001, .RightStickX = 0, .RightStickY = 32767 };
+			Assert::IsTrue(states.front() == expectedState, L"Events not decoded to the expected state.");
+			Assert::IsTrue(decoder.GetState() == expectedState);
+			// The down keys are those of the decoders, the left stick down-left and the right stick up, the right trigger below the threshold.
+			auto expectedKeys = std::vector{ ksp.ButtonA, ksp.ButtonY, ksp.ButtonBack, ksp.ButtonShoulderLeft, ksp.ThumbRightClick,
+				ksp.DpadRight, ksp.DpadDown, ksp.LeftTrigger, ksp.LeftThumbstickDownLeft, ksp.RightThumbstickUp };
+			std::ranges::sort(expectedKeys);
+			Assert::IsTrue(GetSortedDownKeys(states.front()) == expectedKeys, L"Down keys not those of the state decoders.");
+		}
+
+		TEST_METHOD(ReportsInOrderTest)
+		{
+			using namespace sds::evdevcodes;
+			sds::EvdevStateDecoder decoder;
+			sds::ControllerStateBuffer_t states;
+			// A tap within the batch is two states, a report that changes nothing is not reported.
+			const std::array tapEvents{ Key(ButtonB, 1), Syn(), Key(ButtonB, 2), Syn(), Key(ButtonB, 0), Syn(), Abs(AxisZ, 0), Syn() };
+			Assert::IsTrue(decoder.Decode(tapEvents, states) == 2);
+			Assert::IsTrue(states[0].Buttons == sds::controllercodes::B && states[1].Buttons == 0, L"Tap within the batch lost.");
+			Assert::IsTrue(states[0].PacketNumber == 1 && states[1].PacketNumber == 2);
+
+			// A report spanning two batches is reported by the second.
+			states.clear();
+			const std::array firstEvents{ Key(ButtonStart, 1), Abs(AxisHat0X, -1) };
+			const std::array secondEvents{ Key(ButtonX, 1), Syn() };
+			Assert::IsTrue(decoder.Decode(firstEvents, states) == 0);
+			Assert::IsTrue(decoder.Decode(secondEvents, states) == 1);
+			Assert::IsTrue(states.front().Buttons == (sds::controllercodes::Start | sds::controllercodes::DpadLeft | sds::controllercodes::X));
+
+			// Disconnection releases everything, and is a changed state.
+			decoder.Reset();
+			Assert::IsTrue(decoder.GetState() == sds::ControllerState{ .PacketNumber = 4 });
+		}
+
+		TEST_METHOD(AxisScalingTest)
+		{
+			using namespace sds::evdevcodes;
+			// A stick with an 8 bit range, an Xbox One pad's 10 bit triggers.
+			sds::EvdevStateDecoder decoder{ sds::EvdevAxisRanges{ .LeftStickX = { 0, 255 }, .LeftStickY = { 0, 255 }, .LeftTrigger = { 0, 1023 }, .RightTrigger = { 0, 1023 } } };
+			sds::ControllerStateBuffer_t states;
+			const std::array events{ Abs(AxisX, 255), Abs(AxisY, 0), Abs(AxisZ, 1023), Abs(AxisRz, 512), Syn(),
+				Abs(AxisX, 0), Abs(AxisY, 255), Abs(AxisZ, 2000), Abs(AxisRz, -5), Syn() };
+			Assert::IsTrue(decoder.Decode(events, states) == 2);
+			Assert::IsTrue(states[0].LeftStickX == 32767 && states[0].LeftStickY == 32767, L"Stick maximum not scaled, or Y not inverted.");
+			Assert::IsTrue(states[0].LeftTrigger == 255 && states[0].RightTrigger == 127);
+			Assert::IsTrue(states[1].LeftStickX == -32768 && states[1].LeftStickY == -32768);
+			Assert::IsTrue(states[1].LeftTrigger == 255 && states[1].RightTrigger == 0, L"Value outside the range not clamped.");
+
+			// A digital trigger button is the trigger fully pressed.
+			states.clear();
+			const std::array buttonEvents{ Key(ButtonRightTrigger, 1), Syn() };
+			Assert::IsTrue(decoder.Decode(buttonEvents, states) == 1 && states.front().RightTrigger == 255);
+		}
+
+		TEST_METHOD(DroppedEventsTest)
+		{
+			using namespace sds::evdevcodes;
+			sds::EvdevStateDecoder decoder;
+			sds::ControllerStateBuffer_t states;
+			const std::array events{ Key(ButtonA, 1), Syn(), Key(ButtonB, 1), Syn(SynDropped), Key(ButtonX, 1), Key(ButtonA, 0), Syn(), Key(ButtonY, 1), Syn() };
+			Assert::IsTrue(decoder.Decode(events, states) == 2);
+			Assert::IsTrue(states[0].Buttons == sds::controllercodes::A);
+			// The partial report and the events up to the report ending the drop are discarded.
+			Assert::IsTrue(states[1].Buttons == (sds::controllercodes::A | sds::controllercodes::Y), L"Dropped events not discarded.");
+			Assert::IsTrue(decoder.TakeResyncRequest(), L"Resync not requested.");
+			Assert::IsFalse(decoder.TakeResyncRequest());
+
+			// The device's state read back, as events.
+			states.clear();
+			const std::array resyncEvents{ Key(ButtonA, 0), Key(ButtonY, 1), Key(ButtonX, 1), Abs(AxisX, 0), Syn() };
+			Assert::IsTrue(decoder.Decode(resyncEvents, states) == 1);
+			Assert::IsTrue(decoder.GetState().Buttons == (sds::controllercodes::X | sds::controllercodes::Y));
+		}
+
+		TEST_METHOD(InvalidRangesTest)
+		{
+			Assert::ExpectException<std::runtime_error>([]() { sds::EvdevStateDecoder decoder{ sds::EvdevAxisRanges{ .LeftStickX = { 0, 0 } } }; });
+			Assert::ExpectException<std::runtime_error>([]() { sds::EvdevStateDecoder decoder{ sds::EvdevAxisRanges{ .RightTrigger = { 255, 0 } } }; });
+		}
+	};
+}
@@ -60,5 +60,48 @@ namespace TestKeyboard
 			DoUpTestFor(4, false);
 			DoUpTestFor(3, false);
 		}
+
+		TEST_METHOD(MemberSlotTest)
+		{
+			sds::GroupActivationInfo gai;
+			const auto slotA = gai.AddMember(10);
+			const auto slotB = gai.AddMember(20);
+			const auto slotC = gai.AddMember(30);
+			Assert::IsTrue(gai.AddMember(20) == slotB, L"Member added twice.");
+
+			// C activated, B then A overtaken behind it.
+			Assert::IsFalse(gai.UpdateForMemberDown(slotA).second.has_value());
+			Assert::IsTrue(gai.UpdateForMemberDown(slotB).second == 10);
+			Assert::IsTrue(gai.UpdateForMemberDown(slotC).second == 20);
+			Assert::IsTrue(gai.IsMemberActivated(slotC) && gai.IsMemberOvertaken(slotA) && gai.IsMemberOvertaken(slotB));
+
+			// Removing from the middle keeps the order, the next in line is key-down'd when the activated key goes up.
+			Assert::IsFalse(gai.UpdateForMemberUp(slotB).has_value());
+			Assert::IsFalse(gai.IsMemberActivatedOrOvertaken(slotB));
+			Assert::IsTrue(gai.UpdateForMemberUp(slotC) == 10);
+			Assert::IsTrue(gai.IsMappingActivated(10));
+			Assert::IsFalse(gai.UpdateForMemberUp(slotA).has_value());
+			Assert::IsFalse(gai.IsAnyMappingActivated());
+		}
+
+		TEST_METHOD(MemberCountLimitTest)
+		{
+			sds::GroupActivationInfo gai;
+			for (int vk{ 1 }; vk <= static_cast<int>(sds::keyboardtypes::MaxMappingCount); ++vk)
+				std::ignore = gai.AddMember(vk);
+			Assert::ExpectException<std::runtime_error>([&]() { std::ignore = gai.AddMember(1000); });
+			Assert::ExpectException<std::runtime_error>([&]() { std::ignore = gai.UpdateForNewMatchingGroupingDown(1000); });
+			Assert::IsFalse(gai.GetMemberSlot(1000).has_value(), L"Rejected member added.");
+
+			// The last member is usable, a slot that is not a member is filtered and changes nothing.
+			const auto lastVk = static_cast<int>(sds::keyboardtypes::MaxMappingCount);
+			Assert::IsFalse(gai.UpdateForNewMatchingGroupingDown(lastVk).first);
+			Assert::IsTrue(gai.IsMappingActivated(lastVk));
+			constexpr sds::GroupActivationInfo::Slot_t OutsideSlot{ 200 };
+			Assert::IsTrue(gai.UpdateForMemberDown(OutsideSlot) == std::make_pair(true, std::optional<int>{}));
+			Assert::IsFalse(gai.UpdateForMemberUp(OutsideSlot).has_value());
+			Assert::IsFalse(gai.IsMemberOvertaken(OutsideSlot) || gai.IsMemberActivatedOrOvertaken(OutsideSlot));
+			Assert::IsTrue(gai.GetActivatedValue() == lastVk);
+		}
 	};
 }
\ No newline at end of file
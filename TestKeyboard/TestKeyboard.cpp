@@ -3,12 +3,32 @@
 #include "TestMappingProvider.h"
 #include "TestOvertakingFilter.h"
 #include "TestGroupActivationInfo.h"
+#include "TestDeadlineQueue.h"
+#include "TestZeroAllocation.h"
+#include "TestMultiPlayerTranslator.h"
+#include "TestBatchTranslationEngine.h"
+#include "TestTranslationPipeline.h"
+#include "TestLatestValuePoller.h"
+#include "TestPriorityOvertakingFilter.h"
+#include "TestStateDecoder.h"
+#include "TestStickQuantizer.h"
+#include "TestUnchangedInputGate.h"
+#include "TestConnectionMonitor.h"
+#include "TestKeystrokeDecoder.h"
+#include "TestEvdevDecoder.h"
 #include <filesystem>
 #include "../XMapLib_Keyboard/KeyboardOvertakingFilter.h"
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace TestKeyboard
 {
+    // Clock policy for the translator, time only advances when the test advances it.
+    struct FakeClock
+    {
+        static inline TimeManagement::TimePoint_t Now{};
+        static auto now() noexcept -> TimeManagement::TimePoint_t { return Now; }
+    };
+
 	TEST_CLASS(TestKeyboard)
 	{
         // Test translator with no exclusivity group filter.
@@ -17,8 +37,8 @@ namespace TestKeyboard
             using namespace std::chrono_literals;
             using namespace std::chrono;
 
-            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ XINPUT_GAMEPAD_A };
-            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ XINPUT_GAMEPAD_B };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
 
             auto maps1 = GetMapping(buttonA);
             auto maps2 = GetMapping(buttonB);
@@ -33,6 +53,169 @@ namespace TestKeyboard
             translations2();
 		}
 
+        // Test translator with the down state given as a dense mask, as produced by a mask producing poller.
+        TEST_METHOD(TranslatorMaskTest)
+        {
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonX{ sds::controllercodes::X };
+
+            auto maps1 = GetMapping(buttonA);
+            auto maps2 = GetMapping(buttonB);
+            maps2.append_range(maps1);
+            sds::KeyboardTranslator poller{ std::move(maps2) };
+
+            const auto& keyIndices = poller.GetKeyIndexMap();
+            Assert::IsTrue(keyIndices.GetIndexForVk(buttonB) == 0u);
+            Assert::IsTrue(keyIndices.GetIndexForVk(buttonA) == 1u);
+            Assert::IsFalse(keyIndices.GetIndexForVk(buttonX).has_value(), L"Unmapped VK has an index.");
+
+            // Unmapped VKs are dropped from the mask.
+            const auto downMask = keyIndices.GetDownMask(std::vector{ buttonA, buttonX });
+            Assert::IsTrue(downMask.count() == 1);
+
+            const auto translations1 = poller.GetUpdatedStateFromMask(downMask);
+            Assert::IsTrue(translations1.DownRequests.size() == 1, L"Translation count not 1.");
+            Assert::IsTrue(translations1.DownRequests.front().MappingVk == buttonA);
+            translations1();
+
+            const auto translations2 = poller.GetUpdatedStateFromMask({});
+            Assert::IsTrue(translations2.UpRequests.size() == 1, L"Empty mask not creating 1 translation after down.");
+            translations2();
+        }
+
+        // Test translator with an injected clock, all of the transitions are judged against the (fake) time of the update.
+        TEST_METHOD(TranslatorClockPolicyTest)
+        {
+            using namespace std::chrono_literals;
+
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            std::vector<sds::CBActionMap> mappings{ sds::CBActionMap{
+                .ButtonVirtualKeycode = buttonA,
+                .UsesInfiniteRepeat = true,
+                .DelayBeforeFirstRepeat = 10ms,
+                .DelayForRepeats = 5ms } };
+            sds::KeyboardTranslator<sds::KeyboardOvertakingFilter, FakeClock> poller{ std::move(mappings) };
+
+            FakeClock::Now += 1s;
+            auto translations = poller({ buttonA });
+            Assert::IsTrue(translations.DownRequests.size() == 1);
+            translations();
+
+            // Not elapsed at exactly the delay.
+            FakeClock::Now += 10ms;
+            translations = poller({ buttonA });
+            Assert::IsTrue(translations.RepeatRequests.empty());
+
+            FakeClock::Now += 1ns;
+            translations = poller({ buttonA });
+            Assert::IsTrue(translations.RepeatRequests.size() == 1, L"First repeat not sent after delay.");
+            translations();
+
+            // Time point overload, the repeat delay is measured from the time of the update that produced the repeat.
+            translations = poller.GetUpdatedState({ buttonA }, FakeClock::Now + 5ms);
+            Assert::IsTrue(translations.RepeatRequests.empty());
+            translations = poller.GetUpdatedState({ buttonA }, FakeClock::Now + 5ms + 1ns);
+            Assert::IsTrue(translations.RepeatRequests.size() == 1, L"Repeat not sent after delay.");
+            translations();
+
+            translations = poller.GetUpdatedState({}, FakeClock::Now + 6ms);
+            Assert::IsTrue(translations.UpRequests.size() == 1);
+            translations();
+        }
+
+        // Test the next deadline query, used to sleep until the next repeat or reset.
+        TEST_METHOD(TranslatorNextDeadlineTest)
+        {
+            using namespace std::chrono_literals;
+
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            std::vector<sds::CBActionMap> mappings{ sds::CBActionMap{
+                .ButtonVirtualKeycode = buttonA,
+                .UsesInfiniteRepeat = true,
+                .DelayBeforeFirstRepeat = 10ms,
+                .DelayForRepeats = 5ms } };
+            sds::KeyboardTranslator poller{ std::move(mappings) };
+            Assert::IsFalse(poller.GetNextDeadline().has_value(), L"Idle translator has a deadline.");
+
+            const auto startTime = TimeManagement::Clock_t::now();
+            poller.GetUpdatedState({ buttonA }, startTime)();
+            Assert::IsTrue(poller.GetNextDeadline() == startTime + 10ms, L"Next deadline not the first repeat.");
+            Assert::IsTrue(poller.GetUpdatedState({ buttonA }, startTime + 10ms).RepeatRequests.empty());
+
+            poller.GetUpdatedState({ buttonA }, startTime + 10ms + 1ns)();
+            Assert::IsTrue(poller.GetNextDeadline() == startTime + 15ms + 1ns, L"Next deadline not the repeat.");
+
+            // With slack, the deadline is serviced late.
+            poller.SetTimerCoalescingSlack(1ms);
+            Assert::IsTrue(poller.GetNextDeadline() == startTime + 16ms + 1ns);
+
+            poller.GetUpdatedState({}, startTime + 11ms)();
+            Assert::IsTrue(poller.GetNextDeadline() == startTime + 16ms + 1ns, L"Next deadline not the reset.");
+            poller.GetUpdatedState({}, startTime + 17ms)();
+            Assert::IsFalse(poller.GetNextDeadline().has_value(), L"Translator has a deadline after reset.");
+        }
+
+        // Test translator in event mode, the events are performed by the dispatcher.
+        TEST_METHOD(TranslatorEventTest)
+        {
+            using namespace std::chrono_literals;
+
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
+            int downCount{};
+            int upCount{};
+            std::vector<sds::CBActionMap> mappings{
+                sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .ExclusivityGrouping = 101, .OnDown = [&]() { ++downCount; }, .OnUp = [&]() { ++upCount; } },
+                sds::CBActionMap{ .ButtonVirtualKeycode = buttonB, .OnDown = [&]() { ++downCount; }, .OnUp = [&]() { ++upCount; } } };
+            sds::KeyboardTranslator poller{ std::move(mappings) };
+            const auto dispatcher = poller.GetEventDispatcher();
+            sds::TranslationEventBuffer_t events;
+
+            const auto startTime = TimeManagement::Clock_t::now();
+            poller.FillUpdatedEventsFromMask(sds::keyboardtypes::DownMask_t{ 0b11 }, startTime, events);
+            Assert::IsTrue(events.size() == 2, L"Event count not 2.");
+            Assert::IsTrue(events[0].MappingVk == buttonA && events[0].MappingIndex == 0u && events[0].ExclusivityGrouping == 101u);
+            Assert::IsTrue(events[1].MappingVk == buttonB && !events[1].ExclusivityGrouping.has_value());
+            Assert::IsTrue(std::ranges::all_of(events, [&](const auto& e) { return e.Transition == sds::TransitionKind::KeyDown && e.TimePoint == startTime; }));
+            Assert::IsTrue(downCount == 0, L"Callback called before dispatch.");
+            dispatcher(events);
+            Assert::IsTrue(downCount == 2);
+
+            // Events may be copied and dispatched elsewhere.
+            poller.FillUpdatedEventsFromMask({}, startTime + 1ms, events);
+            const std::vector<sds::TranslationEvent> copiedEvents{ events.begin(), events.end() };
+            Assert::IsTrue(copiedEvents.size() == 2 && copiedEvents.front().Transition == sds::TransitionKind::KeyUp);
+            dispatcher(copiedEvents);
+            Assert::IsTrue(upCount == 2);
+        }
+
+        // Test translators sharing one mapping profile, each with its own mapping state.
+        TEST_METHOD(TranslatorSharedProfileTest)
+        {
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            int downCount{};
+            const auto profile = std::make_shared<const sds::MappingProfile>(std::vector{
+                sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .OnDown = [&]() { ++downCount; } } });
+            sds::KeyboardTranslator first{ profile };
+            sds::KeyboardTranslator second{ profile };
+            Assert::IsTrue(profile.use_count() == 3, L"Profile not shared.");
+
+            const auto translations1 = first({ buttonA });
+            Assert::IsTrue(translations1.DownRequests.size() == 1);
+            translations1();
+            Assert::IsTrue(downCount == 1);
+            Assert::IsTrue(first.GetMappingState(0).IsDown());
+            Assert::IsTrue(second.GetMappingState(0).IsInitialState(), L"Translator state not independent.");
+            Assert::IsTrue(profile->GetMappingAt(0).LastAction.IsInitialState(), L"Profile state advanced.");
+
+            const auto translations2 = second({ buttonA });
+            Assert::IsTrue(translations2.DownRequests.size() == 1);
+            translations2();
+            Assert::IsTrue(downCount == 2);
+            Assert::IsTrue(first.GetCleanupActions().size() == 1 && second.GetCleanupActions().size() == 1);
+        }
+
         TEST_METHOD(TestMovingTranslator)
 		{
             auto translator = GetBuiltTranslator();
@@ -47,8 +230,8 @@ namespace TestKeyboard
             using namespace std::chrono_literals;
             using namespace std::chrono;
 
-            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ XINPUT_GAMEPAD_A };
-            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ XINPUT_GAMEPAD_B };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+            constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
 
             sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> stateUpdate{ buttonA, buttonB };
             sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> emptyState{};
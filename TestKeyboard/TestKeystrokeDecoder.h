@@ -0,0 +1,187 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardKeystrokeDecoder.h"
+#include "../XMapLib_Keyboard/KeyboardScriptedBackends.h"
+#include "../XMapLib_Keyboard/KeyboardTranslator.h"
+
+#include <bit>
+#include <utility>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestKeystrokeDecoder)
+	{
+		struct KeystrokeClock
+		{
+			static inline TimeManagement::TimePoint_t Now{};
+			static auto now() noexcept -> TimeManagement::TimePoint_t { return Now; }
+		};
+
+		static constexpr sds::KeyboardSettings ksp;
+
+		static constexpr auto Down(const sds::keyboardtypes::VirtualKey_t keystrokeVk, const std::uint8_t userIndex = 0) -> sds::ControllerKeystroke
+		{
+			return { .VirtualKey = keystrokeVk, .Flags = sds::controllercodes::keystroke::KeyDownFlag, .UserIndex = userIndex };
+		}
+
+		static constexpr auto Up(const sds::keyboardtypes::VirtualKey_t keystrokeVk, const std::uint8_t userIndex = 0) -> sds::ControllerKeystroke
+		{
+			return { .VirtualKey = keystrokeVk, .Flags = sds::controllercodes::keystroke::KeyUpFlag, .UserIndex = userIndex };
+		}
+
+		static constexpr auto KeyBit(const sds::keyboardtypes::VirtualKey_t controllerVk) -> sds::ControllerKeyMask_t
+		{
+			const auto virtualKeys = sds::GetControllerKeyVirtualKeycodes(ksp);
+			for (std::size_t bit{}; bit < virtualKeys.size(); ++bit)
+			{
+				if (virtualKeys[bit] == controllerVk)
+					return sds::ControllerKeyMask_t{ 1 } << bit;
+			}
+			return {};
+		}
+
+		// Translates the updates of a tick with the tick's time point, returns the (VK, transition) of each event in order.
+		template<typename Translator_t>
+		static auto TranslateUpdates(Translator_t& translator, const sds::ControllerKeyUpdates_t& updates, const TimeManagement::TimePoint_t timePoint)
+		{
+			const sds::ControllerKeyIndexTable keyTable{ translator.GetKeyIndexMap(), ksp };
+			std::vector<std::pair<sds::keyboardtypes::VirtualKey_t, sds::TransitionKind>> transitions;
+			sds::TranslationEventBuffer_t events;
+			for (const auto controllerKeys : updates)
+			{
+				translator.FillUpdatedEventsFromMask(keyTable.GetDownMask(controllerKeys), timePoint, events);
+				translator.GetEventDispatcher()(events);
+				for (const auto& event : events)
+					transitions.emplace_back(event.MappingVk, event.Transition);
+			}
+			return transitions;
+		}
+	public:
+		TEST_METHOD(ControllerKeyBitsTest)
+		{
+			// Each keystroke code is the controller key bit of the same key, as decoded from a state.
+			using namespace sds::controllercodes;
+			const std::array<std::pair<sds::keyboardtypes::VirtualKey_t, sds::keyboardtypes::VirtualKey_t>, 32> KeystrokeKeys{ {
+				{ keystroke::A, A }, { keystroke::B, B }, { keystroke::X, X }, { keystroke::Y, Y },
+				{ keystroke::RightShoulder, RightShoulder }, { keystroke::LeftShoulder, LeftShoulder },
+				{ keystroke::LeftTrigger, LeftTrigger }, { keystroke::RightTrigger, RightTrigger },
+				{ keystroke::DpadUp, DpadUp }, { keystroke::DpadDown, DpadDown }, { keystroke::DpadLeft, DpadLeft }, { keystroke::DpadRight, DpadRight },
+				{ keystroke::Start, Start }, { keystroke::Back, Back }, { keystroke::LeftThumb, LeftThumb }, { keystroke::RightThumb, RightThumb },
+				{ keystroke::LeftThumbstickFirst, LeftThumbstickUp }, { keystroke::LeftThumbstickFirst + 1, LeftThumbstickDown },
+				{ keystroke::LeftThumbstickFirst + 2, LeftThumbstickRight }, { keystroke::LeftThumbstickFirst + 3, LeftThumbstickLeft },
+				{ keystroke::LeftThumbstickFirst + 4, LeftThumbstickUpLeft }, { keystroke::LeftThumbstickFirst + 5, LeftThumbstickUpRight },
+				{ keystroke::LeftThumbstickFirst + 6, LeftThumbstickDownRight }, { keystroke::LeftThumbstickFirst + 7, LeftThumbstickDownLeft },
+				{ keystroke::RightThumbstickFirst, RightThumbstickUp }, { keystroke::RightThumbstickFirst + 1, RightThumbstickDown },
+				{ keystroke::RightThumbstickFirst + 2, RightThumbstickRight }, { keystroke::RightThumbstickFirst + 3, RightThumbstickLeft },
+				{ keystroke::RightThumbstickFirst + 4, RightThumbstickUpLeft }, { keystroke::RightThumbstickFirst + 5, RightThumbstickUpRight },
+				{ keystroke::RightThumbstickFirst + 6, RightThumbstickDownRight }, { keystroke::RightThumbstickFirst + 7, RightThumbstickDownLeft } } };
+
+			sds::ControllerKeyMask_t allKeys{};
+			for (const auto& [keystrokeVk, controllerVk] : KeystrokeKeys)
+			{
+				sds::KeystrokeDecoder decoder;
+				sds::ControllerKeyUpdates_t updates;
+				const std::array keystrokes{ Down(keystrokeVk) };
+				decoder.Decode(keystrokes, updates);
+				Assert::IsTrue(updates.size() == 1 && updates.front() == KeyBit(controllerVk), L"Keystroke code not the bit of its controller key.");
+				allKeys |= updates.front();
+			}
+			Assert::IsTrue(std::popcount(allKeys) == 32);
+		}
+
+		TEST_METHOD(TapWithinTickTest)
+		{
+			// A press and release queued in the same tick is a key-down update then a key-up update.
+			sds::KeyboardTranslator translator{ std::vector{ sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonA } } };
+			sds::KeystrokeDecoder decoder;
+			sds::ControllerKeyUpdates_t updates;
+			const std::array keystrokes{ Down(sds::controllercodes::keystroke::A), Up(sds::controllercodes::keystroke::A) };
+			decoder.Decode(keystrokes, updates);
+			Assert::IsTrue(updates.size() == 2 && updates[0] == KeyBit(ksp.ButtonA) && updates[1] == 0);
+
+			const auto transitions = TranslateUpdates(translator, updates, TimeManagement::Clock_t::now());
+			Assert::IsTrue(transitions.size() == 2, L"Tap shorter than the tick lost.");
+			Assert::IsTrue(transitions[0].second == sds::TransitionKind::KeyDown && transitions[1].second == sds::TransitionKind::KeyUp);
+
+			// With no keystroke, one update with the unchanged mask.
+			decoder.Decode({}, updates);
+			Assert::IsTrue(updates.size() == 1 && updates.front() == 0);
+		}
+
+		TEST_METHOD(ArrivalOrderTest)
+		{
+			// Two keys of a group pressed in the same tick, the one queued first goes down first and the second overtakes it.
+			for (const bool isAFirst : { true, false })
+			{
+				sds::KeyboardTranslator translator{ std::vector{
+					sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonA, .ExclusivityGrouping = 101 },
+					sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonB, .ExclusivityGrouping = 101 } }, sds::KeyboardOvertakingFilter{} };
+				sds::KeystrokeDecoder decoder;
+				sds::ControllerKeyUpdates_t updates;
+				auto keystrokes = std::array{ Down(sds::controllercodes::keystroke::A), Down(sds::controllercodes::keystroke::B) };
+				if (!isAFirst)
+					std::ranges::reverse(keystrokes);
+				decoder.Decode(keystrokes, updates);
+				Assert::IsTrue(updates.size() == 2);
+
+				const auto firstVk = isAFirst ? ksp.ButtonA : ksp.ButtonB;
+				const auto secondVk = isAFirst ? ksp.ButtonB : ksp.ButtonA;
+				const auto transitions = TranslateUpdates(translator, updates, TimeManagement::Clock_t::now());
+				Assert::IsTrue(transitions.size() == 3);
+				Assert::IsTrue(transitions[0] == std::pair{ firstVk, sds::TransitionKind::KeyDown }, L"First queued key not down first.");
+				Assert::IsTrue(transitions[1] == std::pair{ firstVk, sds::TransitionKind::KeyUp });
+				Assert::IsTrue(transitions[2] == std::pair{ secondVk, sds::TransitionKind::KeyDown });
+			}
+		}
+
+		TEST_METHOD(IgnoredKeystrokesTest)
+		{
+			sds::KeystrokeDecoder decoder{ 1 };
+			sds::ControllerKeyUpdates_t updates;
+			const sds::ControllerKeystroke repeat{ .VirtualKey = sds::controllercodes::keystroke::A,
+				.Flags = sds::controllercodes::keystroke::KeyDownFlag | sds::controllercodes::keystroke::RepeatFlag, .UserIndex = 1 };
+			// Another player's keystroke, an unknown code, a key-up of a key not down.
+			const std::array keystrokes{ Down(sds::controllercodes::keystroke::B, 0), Down(0x5818, 1), Up(sds::controllercodes::keystroke::X, 1),
+				Down(sds::controllercodes::keystroke::A, 1), repeat, Down(sds::controllercodes::keystroke::A, 1) };
+			decoder.Decode(keystrokes, updates);
+			Assert::IsTrue(updates.size() == 1 && updates.front() == KeyBit(ksp.ButtonA), L"Ignored keystroke changed the down keys.");
+
+			decoder.Reset();
+			Assert::IsTrue(decoder.GetDownKeys() == 0);
+			Assert::ExpectException<std::runtime_error>([]() { sds::KeystrokeDecoder invalidDecoder{ sds::controllercodes::MaxPlayerCount }; });
+		}
+
+		TEST_METHOD(ScriptedSourceTest)
+		{
+			using namespace std::chrono_literals;
+			const auto startTime = TimeManagement::Clock_t::now();
+			sds::ScriptedKeystrokeSource<KeystrokeClock> source{ {
+				{ .Offset = 13ms, .Keystroke = Up(sds::controllercodes::keystroke::X) },
+				{ .Offset = 3ms, .Keystroke = Down(sds::controllercodes::keystroke::Y) },
+				{ .Offset = 4ms, .Keystroke = Up(sds::controllercodes::keystroke::Y) },
+				{ .Offset = 12ms, .Keystroke = Down(sds::controllercodes::keystroke::X) } }, startTime };
+			static_assert(sds::KeystrokeSource_c<decltype(source)>);
+
+			sds::KeyboardTranslator translator{ std::vector{ sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonY }, sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonX } } };
+			sds::KeystrokeDecoder decoder;
+			sds::KeystrokeBuffer_t keystrokes;
+			sds::ControllerKeyUpdates_t updates;
+			std::size_t transitionCount{};
+			// Ticks 10ms apart, each tap is within a tick (of another key, a mapping's reset delay is longer than the test).
+			for (auto offset = 0ms; offset <= 20ms; offset += 10ms)
+			{
+				KeystrokeClock::Now = startTime + offset;
+				keystrokes.clear();
+				Assert::IsTrue(source.DrainKeystrokes(keystrokes));
+				Assert::IsTrue(keystrokes.size() == (offset == 0ms ? 0u : 2u), L"Keystrokes not drained by their offset.");
+				decoder.Decode(keystrokes, updates);
+				transitionCount += TranslateUpdates(translator, updates, KeystrokeClock::Now).size();
+			}
+			Assert::IsTrue(source.IsDone());
+			Assert::IsTrue(transitionCount == 4, L"Taps shorter than the tick not all translated.");
+		}
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "../XMapLib_Keyboard/KeyboardLatestValuePoller.h"
+#include "../XMapLib_Keyboard/KeyboardTripleBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestLatestValuePoller)
+	{
+		TEST_METHOD(TripleBufferTest)
+		{
+			sds::TripleBuffer<int> buffer;
+			Assert::IsFalse(buffer.Consume(), L"Consumed before publish.");
+			Assert::IsTrue(buffer.GetReadSlot() == 0);
+			buffer.Publish(1);
+			buffer.Publish(2);
+			buffer.Publish(3);
+			Assert::IsTrue(buffer.Consume());
+			Assert::IsTrue(buffer.GetReadSlot() == 3, L"Not the latest value.");
+			Assert::IsFalse(buffer.Consume(), L"Consumed the same value twice.");
+			Assert::IsTrue(buffer.GetReadSlot() == 3);
+			buffer.GetWriteSlot() = 4;
+			buffer.Publish();
+			Assert::IsTrue(buffer.Consume() && buffer.GetReadSlot() == 4);
+		}
+
+		TEST_METHOD(PollerThreadTest)
+		{
+			using namespace std::chrono_literals;
+			constexpr std::uint64_t SampleCount{ 50 };
+			// Each poll sets the next bit, so the mask identifies the sample.
+			std::size_t pollCount{};
+			sds::LatestValuePoller poller{ [&pollCount]()
+			{
+				sds::keyboardtypes::DownMask_t downMask;
+				downMask.set(pollCount++ % sds::keyboardtypes::MaxMappingCount);
+				return downMask;
+			} };
+
+			std::uint64_t lastSequenceNumber{};
+			while (lastSequenceNumber < SampleCount)
+			{
+				const auto& sample = poller.GetLatest();
+				Assert::IsTrue(sample.SequenceNumber >= lastSequenceNumber, L"Sample older than the last one taken.");
+				if (sample.SequenceNumber > 0)
+				{
+					Assert::IsTrue(sample.DownMask.test((sample.SequenceNumber - 1) % sds::keyboardtypes::MaxMappingCount), L"Sample torn.");
+					Assert::IsTrue(sample.AcquisitionTime <= TimeManagement::Clock_t::now());
+				}
+				lastSequenceNumber = sample.SequenceNumber;
+			}
+			poller.Stop();
+
+			const auto& stats = poller.GetStats();
+			Assert::IsTrue(stats.ConsumedCount > 0);
+			Assert::IsTrue(stats.ConsumedCount + stats.SkippedCount == lastSequenceNumber, L"Consumed plus skipped not the published count.");
+			Assert::IsTrue(stats.MaxQueueDelay >= 0ns && stats.TotalQueueDelay >= stats.MaxQueueDelay);
+		}
+	};
+}
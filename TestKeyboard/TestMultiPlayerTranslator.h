@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "../XMapLib_Keyboard/KeyboardMultiPlayerTranslator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestMultiPlayerTranslator)
+	{
+		TEST_METHOD(PrimaryTest)
+		{
+			using namespace std::chrono_literals;
+			constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+			constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
+
+			int downCount{};
+			int repeatCount{};
+			auto profile = std::make_shared<const sds::MappingProfile>(std::vector{
+				sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .UsesInfiniteRepeat = true, .OnDown = [&]() { ++downCount; }, .OnRepeat = [&]() { ++repeatCount; }, .DelayBeforeFirstRepeat = 10ms, .DelayForRepeats = 5ms },
+				sds::CBActionMap{ .ButtonVirtualKeycode = buttonB, .UsesInfiniteRepeat = false, .OnDown = [&]() { ++downCount; } } });
+			sds::MultiPlayerTranslator<> translator{ profile };
+			Assert::IsTrue(profile.use_count() == 2, L"Profile not shared.");
+
+			const auto& keyIndices = translator.GetKeyIndexMap();
+			sds::MultiPlayerTranslator<>::DownMasks_t downMasks{};
+			downMasks[0] = keyIndices.GetDownMask(std::vector{ buttonA });
+			downMasks[2] = keyIndices.GetDownMask(std::vector{ buttonA, buttonB });
+			sds::MultiPlayerTranslator<>::EventBuffers_t events;
+
+			const auto startTime = TimeManagement::Clock_t::now();
+			translator.FillUpdatedEvents(downMasks, startTime, events);
+			Assert::IsTrue(events[0].size() == 1 && events[1].empty() && events[2].size() == 2 && events[3].empty(), L"Per player event counts wrong.");
+			translator.DispatchEvents(events);
+			Assert::IsTrue(downCount == 3);
+			Assert::IsTrue(translator.GetMappingState(0, 0).IsDown());
+			Assert::IsTrue(translator.GetMappingState(1, 0).IsInitialState(), L"Player state not independent.");
+			Assert::IsTrue(translator.GetNextDeadline() == startTime + 10ms);
+
+			// Player 0 releases, player 2 is still held and repeats.
+			downMasks[0].reset();
+			translator.FillUpdatedEvents(downMasks, startTime + 11ms, events);
+			Assert::IsTrue(events[0].size() == 1 && events[0].front().Transition == sds::TransitionKind::KeyUp);
+			Assert::IsTrue(events[2].size() == 1 && events[2].front().Transition == sds::TransitionKind::KeyRepeat && events[2].front().MappingVk == buttonA);
+			translator.DispatchEvents(events);
+			Assert::IsTrue(repeatCount == 1);
+
+			translator.FillCleanupEvents(events);
+			Assert::IsTrue(events[0].empty() && events[2].size() == 2, L"Cleanup events not for held mappings.");
+		}
+	};
+}
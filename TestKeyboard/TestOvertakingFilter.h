@@ -3,10 +3,14 @@
 #include "CppUnitTest.h"
 #include "TestMappingProvider.h"
 #include "../XMapLib_Keyboard/KeyboardOvertakingFilter.h"
+#include "LegacyOvertakingFilter.h"
 
 #include <filesystem>
+#include <fstream>
+#include <random>
 
 #include "../XMapLib_Keyboard/KeyboardMappingBuilders.h"
+#include "../XMapLib_Keyboard/KeyboardLegacyApiFunctions.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -35,6 +39,213 @@ namespace TestKeyboard
 			Assert::IsTrue(indexB == 1);
 		}
 
+		TEST_METHOD(TestVkMappingTable)
+		{
+			const auto mappings = GetDriverButtonMappings();
+			sds::VkMappingTable table;
+			for (std::size_t i{}; i < mappings.size(); ++i)
+				table.Insert(mappings[i].ButtonVirtualKeycode, static_cast<std::uint8_t>(i), sds::VkMappingTable::NoGroupSlot);
+			for (std::size_t i{}; i < mappings.size(); ++i)
+			{
+				const auto* entry = table.Find(mappings[i].ButtonVirtualKeycode);
+				Assert::IsNotNull(entry, L"Mapped VK not found.");
+				Assert::IsTrue(entry->MappingIndex == i && entry->Vk == mappings[i].ButtonVirtualKeycode);
+			}
+			Assert::IsNull(table.Find(0x7FFF'FFFF), L"Unmapped VK found.");
+		}
+
+		TEST_METHOD(TestMappingCountLimit)
+		{
+			// Grouped mappings, VKs 1 to the count, in two groups.
+			const auto GetGroupedMappings = [](const std::size_t count)
+			{
+				std::vector<sds::CBActionMap> mappings;
+				for (std::size_t i{}; i < count; ++i)
+					mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = static_cast<sds::keyboardtypes::VirtualKey_t>(i + 1), .ExclusivityGrouping = 101u + i % 2 });
+				return mappings;
+			};
+			sds::KeyboardOvertakingFilter filter;
+			Assert::ExpectException<std::runtime_error>([&]() { filter.SetMappingRange(GetGroupedMappings(sds::keyboardtypes::MaxMappingCount + 1)); });
+			Assert::ExpectException<std::runtime_error>([&]() { filter.SetMappingRange(GetGroupedMappings(256)); });
+
+			// At the limit the last mapping is still grouped: its key-down overtakes the group's activated key.
+			const auto mappings = GetGroupedMappings(sds::keyboardtypes::MaxMappingCount);
+			filter.SetMappingRange(mappings);
+			const sds::keyboardtypes::VirtualKey_t lastVk{ static_cast<sds::keyboardtypes::VirtualKey_t>(sds::keyboardtypes::MaxMappingCount) };
+			Assert::IsTrue(filter.GetFilteredButtonState({ 2 }).size() == 1);
+			const auto filtered = filter.GetFilteredButtonState({ 2, lastVk });
+			Assert::IsTrue(filtered.size() == 1 && filtered.front() == lastVk, L"Grouping of the last mapping dropped.");
+
+			// The table holds MaxMappingCount VKs, adding another throws, adding one present does not.
+			sds::VkMappingTable table;
+			for (std::size_t i{}; i < sds::keyboardtypes::MaxMappingCount; ++i)
+				table.Insert(mappings[i].ButtonVirtualKeycode, static_cast<std::uint8_t>(i), sds::VkMappingTable::NoGroupSlot);
+			table.Insert(1, 0, sds::VkMappingTable::NoGroupSlot);
+			Assert::ExpectException<std::runtime_error>([&]() { table.Insert(0x7FFF'FFFF, 0, sds::VkMappingTable::NoGroupSlot); });
+			Assert::IsNotNull(table.Find(lastVk));
+		}
+
+		// Filters each state update with the fused filter (both the VK range and the down mask form) and the original three pass filter, the output must match.
+		static void RunDifferential(const std::vector<sds::CBActionMap>& mappings, const std::vector<sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>>& stateUpdates)
+		{
+			const sds::KeyIndexMap keyIndices{ mappings };
+			sds::KeyboardOvertakingFilter fusedFilter;
+			sds::KeyboardOvertakingFilter maskFilter;
+			legacy::KeyboardOvertakingFilter legacyFilter;
+			fusedFilter.SetMappingRange(mappings);
+			maskFilter.SetMappingRange(mappings);
+			legacyFilter.SetMappingRange(mappings);
+			legacy::KeyboardOvertakingFilter legacyMaskFilter{ legacyFilter };
+
+			std::size_t filteredCount{};
+			for (const auto& stateUpdate : stateUpdates)
+			{
+				const auto legacyResult = legacyFilter.GetFilteredButtonState(sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>{ stateUpdate });
+				const auto fusedResult = fusedFilter.GetFilteredButtonState(sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>{ stateUpdate });
+				Assert::IsTrue(std::ranges::equal(legacyResult, fusedResult), L"Fused filter output differs from the original.");
+				filteredCount += stateUpdate.size() - fusedResult.size();
+
+				// The mask form processes the down keys in mapping order.
+				const auto downMask = keyIndices.GetDownMask(stateUpdate);
+				const auto legacyMaskResult = keyIndices.GetDownMask(legacyMaskFilter.GetFilteredButtonState(keyIndices.GetDownVirtualKeys(downMask)));
+				Assert::IsTrue(maskFilter.GetFilteredDownMask(downMask) == legacyMaskResult, L"Fused down mask filter output differs from the original.");
+			}
+			Assert::IsTrue(filteredCount > 0, L"Nothing was filtered, the exclusivity groups were not exercised.");
+		}
+
+		TEST_METHOD(TestDifferentialRecording)
+		{
+			// One polled VK per line, 0 for none, a VK toggles its 'down' state. Down VKs are ordered by time of key-down.
+			const auto recordingPath = std::filesystem::path{ __FILE__ }.parent_path() / "TestData" / "recording.txt";
+			std::ifstream recordingFile{ recordingPath };
+			Assert::IsTrue(recordingFile.is_open(), L"TestData/recording.txt not found.");
+
+			std::vector<sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>> stateUpdates;
+			sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> downKeys;
+			std::vector<sds::keyboardtypes::VirtualKey_t> recordedKeys;
+			sds::keyboardtypes::VirtualKey_t vk{};
+			while (recordingFile >> vk)
+			{
+				if (vk != 0)
+				{
+					if (const auto erasedCount = std::erase(downKeys, vk); erasedCount == 0)
+						downKeys.emplace_back(vk);
+					if (std::ranges::find(recordedKeys, vk) == recordedKeys.cend())
+						recordedKeys.emplace_back(vk);
+				}
+				stateUpdates.emplace_back(downKeys);
+			}
+			Assert::IsTrue(stateUpdates.size() > 1000);
+
+			// Buttons, left stick and right stick directions are each an exclusivity group.
+			std::vector<sds::CBActionMap> mappings;
+			for (const auto recordedVk : recordedKeys)
+			{
+				auto& mapping = mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = recordedVk });
+				if (recordedVk >= VK_PAD_A && recordedVk <= VK_PAD_Y)
+					mapping.ExclusivityGrouping = 111;
+				else if (recordedVk >= VK_PAD_LTHUMB_UP && recordedVk <= VK_PAD_LTHUMB_DOWNLEFT)
+					mapping.ExclusivityGrouping = 101;
+				else if (recordedVk >= VK_PAD_RTHUMB_UP && recordedVk <= VK_PAD_RTHUMB_DOWNLEFT)
+					mapping.ExclusivityGrouping = 102;
+			}
+			RunDifferential(mappings, stateUpdates);
+		}
+
+		TEST_METHOD(TestDifferentialRandom)
+		{
+			// Key-downs in many orders, several per group per update.
+			std::vector<sds::CBActionMap> mappings;
+			for (sds::keyboardtypes::VirtualKey_t vk{ 1 }; vk <= 16; ++vk)
+			{
+				auto& mapping = mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = vk });
+				if (vk <= 12)
+					mapping.ExclusivityGrouping = static_cast<sds::keyboardtypes::GrpVal_t>(100 + vk % 3);
+			}
+			std::mt19937 randomEngine{ 42 };
+			std::vector<sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>> stateUpdates;
+			sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> downKeys;
+			for (int i{}; i < 20'000; ++i)
+			{
+				// One to three keys toggled per update, an unmapped VK (17) is included now and then.
+				for (auto toggleCount = randomEngine() % 3 + 1; toggleCount > 0; --toggleCount)
+				{
+					const auto vk = static_cast<sds::keyboardtypes::VirtualKey_t>(randomEngine() % 17 + 1);
+					if (const auto erasedCount = std::erase(downKeys, vk); erasedCount == 0)
+						downKeys.emplace_back(vk);
+				}
+				if (randomEngine() % 4 == 0)
+					std::ranges::shuffle(downKeys, randomEngine);
+				stateUpdates.emplace_back(downKeys);
+			}
+			RunDifferential(mappings, stateUpdates);
+		}
+
+		TEST_METHOD(TestSettledKeyMode)
+		{
+			auto mappings = GetDriverButtonMappings();
+			sds::KeyboardTranslator translator{ std::move(mappings), sds::KeyboardOvertakingFilter{ sds::OvertakingFilterMode::SettledKeyPerUpdate } };
+
+			// Four buttons of one group down in the same poll, only the key the group settles on (the last) is sent a key-down, the keys it
+			// overtook within the update have no transitions.
+			auto translationPack = translator({ ksp.ButtonA, ksp.ButtonB, ksp.ButtonX, ksp.ButtonY });
+			translationPack();
+			Assert::IsTrue(translationPack.DownRequests.size() == 1 && translationPack.DownRequests.front().MappingVk == ksp.ButtonY);
+			Assert::IsTrue(translationPack.UpRequests.empty());
+
+			// Settled, nothing more to do.
+			translationPack = translator({ ksp.ButtonA, ksp.ButtonB, ksp.ButtonX, ksp.ButtonY });
+			translationPack();
+			Assert::IsTrue(translationPack.DownRequests.empty() && translationPack.UpRequests.empty(), L"Chain not settled in one update.");
+
+			// Releasing the activated key forwards the next in line in the same update.
+			translationPack = translator({ ksp.ButtonA, ksp.ButtonB, ksp.ButtonX });
+			translationPack();
+			Assert::IsTrue(translationPack.UpRequests.size() == 1 && translationPack.UpRequests.front().MappingVk == ksp.ButtonY);
+			Assert::IsTrue(translationPack.DownRequests.size() == 1 && translationPack.DownRequests.front().MappingVk == ksp.ButtonX);
+
+			// The released mapping is reset before it can go down again.
+			translationPack = translator({ ksp.ButtonA, ksp.ButtonB, ksp.ButtonX });
+			translationPack();
+			Assert::IsTrue(translationPack.DownRequests.empty() && translationPack.UpRequests.empty());
+
+			// A new key overtakes, the activated key is sent a key-up in the same pack.
+			translationPack = translator({ ksp.ButtonA, ksp.ButtonB, ksp.ButtonX, ksp.ButtonY });
+			translationPack();
+			Assert::IsTrue(translationPack.UpRequests.size() == 1 && translationPack.UpRequests.front().MappingVk == ksp.ButtonX);
+			Assert::IsTrue(translationPack.DownRequests.size() == 1 && translationPack.DownRequests.front().MappingVk == ksp.ButtonY);
+		}
+
+		TEST_METHOD(TestSettledKeyMatchesDefault)
+		{
+			// For each update, the settled key filter's output must be what the default filter settles on when the update is repeated.
+			std::vector<sds::CBActionMap> mappings;
+			for (sds::keyboardtypes::VirtualKey_t vk{ 1 }; vk <= 12; ++vk)
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = vk, .ExclusivityGrouping = vk <= 9 ? std::optional<sds::keyboardtypes::GrpVal_t>(100 + vk % 2) : std::nullopt });
+			sds::KeyboardOvertakingFilter defaultFilter;
+			sds::KeyboardOvertakingFilter settledKeyFilter{ sds::OvertakingFilterMode::SettledKeyPerUpdate };
+			defaultFilter.SetMappingRange(mappings);
+			settledKeyFilter.SetMappingRange(mappings);
+
+			std::mt19937 randomEngine{ 7 };
+			sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> downKeys;
+			for (int i{}; i < 5'000; ++i)
+			{
+				for (auto toggleCount = randomEngine() % 4 + 1; toggleCount > 0; --toggleCount)
+				{
+					const auto vk = static_cast<sds::keyboardtypes::VirtualKey_t>(randomEngine() % 12 + 1);
+					if (const auto erasedCount = std::erase(downKeys, vk); erasedCount == 0)
+						downKeys.emplace_back(vk);
+				}
+				const auto settledKeyResult = settledKeyFilter.GetFilteredButtonState(sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>{ downKeys });
+
+				auto defaultResult = defaultFilter.GetFilteredButtonState(sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>{ downKeys });
+				for (std::size_t repeatCount{}; repeatCount <= downKeys.size(); ++repeatCount)
+					defaultResult = defaultFilter.GetFilteredButtonState(sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>{ downKeys });
+				Assert::IsTrue(std::ranges::equal(settledKeyResult, defaultResult), L"Settled key output not the settled default output.");
+			}
+		}
+
 		TEST_METHOD(TestFilter)
 		{
 			using namespace std::chrono_literals;
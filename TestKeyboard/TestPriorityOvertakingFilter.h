@@ -0,0 +1,107 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardPriorityOvertakingFilter.h"
+#include "../XMapLib_Keyboard/KeyboardKeyIndexMap.h"
+#include "../XMapLib_Keyboard/KeyboardTranslator.h"
+
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestPriorityOvertakingFilter)
+	{
+		using VkVector_t = sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t>;
+
+		// VKs 1 to 4 in group 100 with priorities 1, 3, 2, 3, VK 5 without a group, VKs 6 and 7 in group 101 with no priority set.
+		static auto GetPriorityMappings()
+		{
+			std::vector<sds::CBActionMap> mappings;
+			constexpr std::array<sds::keyboardtypes::Priority_t, 4> Priorities{ 1, 3, 2, 3 };
+			for (sds::keyboardtypes::VirtualKey_t vk{ 1 }; vk <= 4; ++vk)
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = vk, .ExclusivityGrouping = 100, .ExclusivityPriority = Priorities[vk - 1] });
+			mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = 5 });
+			mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = 6, .ExclusivityGrouping = 101 });
+			mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = 7, .ExclusivityGrouping = 101 });
+			return mappings;
+		}
+	public:
+		TEST_METHOD(PriorityOrderTest)
+		{
+			const auto mappings = GetPriorityMappings();
+			sds::KeyboardPriorityOvertakingFilter filter;
+			filter.SetMappingRange(mappings);
+			const auto Filter = [&filter](VkVector_t stateUpdate) { return filter.GetFilteredButtonState(std::move(stateUpdate)); };
+
+			Assert::IsTrue(Filter({ 1 }) == VkVector_t{ 1 });
+			Assert::IsTrue(Filter({ 1, 3 }) == VkVector_t{ 3 }, L"Higher priority key not activated.");
+			// Press order does not matter.
+			Assert::IsTrue(Filter({ 3, 1 }) == VkVector_t{ 3 });
+			Assert::IsTrue(Filter({ 1, 3, 2 }) == VkVector_t{ 2 });
+			// Equal priorities, the earlier mapping wins.
+			Assert::IsTrue(Filter({ 4, 2 }) == VkVector_t{ 2 }, L"Tie not ordered by mapping order.");
+			Assert::IsTrue(Filter({ 4, 1 }) == VkVector_t{ 4 });
+			// Releasing the activated key activates the highest still held.
+			Assert::IsTrue(Filter({ 1, 3 }) == VkVector_t{ 3 });
+			// Ungrouped keys are forwarded, groups are independent, unset priorities order by mapping.
+			Assert::IsTrue(Filter({ 7, 5, 1, 6 }) == VkVector_t{ 5, 1, 6 });
+			Assert::IsTrue(Filter({}).empty());
+		}
+
+		TEST_METHOD(DownMaskMatchesButtonStateTest)
+		{
+			const auto mappings = GetPriorityMappings();
+			const sds::KeyIndexMap keyIndices{ mappings };
+			sds::KeyboardPriorityOvertakingFilter filter;
+			filter.SetMappingRange(mappings);
+
+			std::mt19937 randomEngine{ 17 };
+			std::bernoulli_distribution isDown{ 0.5 };
+			for (int update{}; update < 1000; ++update)
+			{
+				VkVector_t stateUpdate;
+				for (const auto& mapping : mappings)
+				{
+					if (isDown(randomEngine))
+						stateUpdate.emplace_back(mapping.ButtonVirtualKeycode);
+				}
+				const auto filteredMask = filter.GetFilteredDownMask(keyIndices.GetDownMask(stateUpdate));
+				const auto filteredState = filter.GetFilteredButtonState(std::move(stateUpdate));
+				Assert::IsTrue(filteredMask == keyIndices.GetDownMask(filteredState), L"Down mask filter differs from the button state filter.");
+			}
+		}
+
+		TEST_METHOD(TranslatorPolicyTest)
+		{
+			sds::KeyboardTranslator<sds::KeyboardPriorityOvertakingFilter> translator{ GetPriorityMappings(), sds::KeyboardPriorityOvertakingFilter{} };
+
+			auto translationPack = translator({ 1 });
+			translationPack();
+			Assert::IsTrue(translationPack.DownRequests.size() == 1 && translationPack.DownRequests.front().MappingVk == 1);
+
+			// A higher priority key overtakes in the same pack.
+			translationPack = translator({ 1, 2 });
+			translationPack();
+			Assert::IsTrue(translationPack.UpRequests.size() == 1 && translationPack.UpRequests.front().MappingVk == 1);
+			Assert::IsTrue(translationPack.DownRequests.size() == 1 && translationPack.DownRequests.front().MappingVk == 2);
+
+			// A lower priority key pressed later does not.
+			translationPack = translator({ 1, 2, 3 });
+			translationPack();
+			Assert::IsTrue(translationPack.UpRequests.empty() && translationPack.DownRequests.empty(), L"Lower priority key overtook.");
+		}
+
+		TEST_METHOD(MappingCountLimitTest)
+		{
+			std::vector<sds::CBActionMap> mappings;
+			for (std::size_t i{}; i <= sds::keyboardtypes::MaxMappingCount; ++i)
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = static_cast<sds::keyboardtypes::VirtualKey_t>(i + 1), .ExclusivityGrouping = 101 });
+			sds::KeyboardPriorityOvertakingFilter filter;
+			Assert::ExpectException<std::runtime_error>([&]() { filter.SetMappingRange(mappings); });
+			mappings.pop_back();
+			filter.SetMappingRange(mappings);
+		}
+	};
+}
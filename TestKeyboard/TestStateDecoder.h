@@ -0,0 +1,133 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardStateDecoder.h"
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <ranges>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestStateDecoder)
+	{
+		static constexpr sds::KeyboardSettings ksp;
+
+		// One mapping per controller key, in controller key bit order reversed so the mapping index is not the bit.
+		static auto GetAllControllerKeyMappings()
+		{
+			std::vector<sds::CBActionMap> mappings;
+			for (const auto vk : sds::GetControllerKeyVirtualKeycodes(ksp) | std::views::reverse)
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = vk });
+			return mappings;
+		}
+
+		// Random states, with stick values biased to the axes, the diagonals and the deadzone edge.
+		static auto GetRandomStates(const std::size_t count)
+		{
+			std::mt19937 randomEngine{ 23 };
+			std::uniform_int_distribution<int> buttonDist{ 0, 0xFFFF };
+			std::uniform_int_distribution<int> triggerDist{ 0, 255 };
+			std::uniform_int_distribution<int> stickDist{ -32768, 32767 };
+			std::uniform_int_distribution<int> shapeDist{ 0, 3 };
+			const auto GetStick = [&](sds::keyboardtypes::ThumbstickValue_t& x, sds::keyboardtypes::ThumbstickValue_t& y)
+			{
+				const auto value = stickDist(randomEngine);
+				switch (shapeDist(randomEngine))
+				{
+				case 0: x = static_cast<std::int16_t>(value); y = static_cast<std::int16_t>(stickDist(randomEngine)); break;
+				case 1: x = static_cast<std::int16_t>(value); y = static_cast<std::int16_t>(value); break;
+				case 2: x = static_cast<std::int16_t>(value); y = 0; break;
+				default: x = static_cast<std::int16_t>(value % (ksp.LeftStickDeadzone + 2)); y = 0; break;
+				}
+			};
+			std::vector<sds::ControllerState> states(count);
+			for (auto& state : states)
+			{
+				state.Buttons = static_cast<std::uint16_t>(buttonDist(randomEngine));
+				state.LeftTrigger = static_cast<std::uint8_t>(triggerDist(randomEngine));
+				state.RightTrigger = static_cast<std::uint8_t>(triggerDist(randomEngine));
+				GetStick(state.LeftStickX, state.LeftStickY);
+				GetStick(state.RightStickX, state.RightStickY);
+			}
+			return states;
+		}
+	public:
+		TEST_METHOD(MatchesLoopDecoderTest)
+		{
+			const auto mappings = GetAllControllerKeyMappings();
+			const sds::KeyIndexMap keyIndices{ mappings };
+			const sds::ControllerKeyIndexTable keyTable{ keyIndices, ksp };
+			sds::KeyboardSettings integerSettings;
+			integerSettings.StickDirectionClassifier = sds::StickClassifier::IntegerOctant;
+			for (const auto& state : GetRandomStates(100'000))
+			{
+				const auto expectedMask = sds::GetDownVirtualKeycodesMask(ksp, state, keyIndices);
+				Assert::IsTrue(keyTable.GetDownMask(sds::DecodeControllerKeyMask(ksp, state)) == expectedMask, L"Decoded mask differs from the loop decoder.");
+				const auto expectedIntegerMask = sds::GetDownVirtualKeycodesMask(integerSettings, state, keyIndices);
+				Assert::IsTrue(keyTable.GetDownMask(sds::DecodeControllerKeyMask(integerSettings, state)) == expectedIntegerMask, L"Integer classifier decoded mask differs from the loop decoder.");
+			}
+
+			// The stick sector boundaries, and a centered stick.
+			sds::ControllerState state{};
+			for (const auto [x, y] : std::array<std::pair<std::int16_t, std::int16_t>, 9>{ { {0, 0}, {30000, 0}, {-30000, 0}, {0, 30000}, {0, -30000}, {20000, 20000}, {-20000, 20000}, {-20000, -20000}, {20000, -20000} } })
+			{
+				state.LeftStickX = x;
+				state.LeftStickY = y;
+				Assert::IsTrue(keyTable.GetDownMask(sds::DecodeControllerKeyMask(ksp, state)) == sds::GetDownVirtualKeycodesMask(ksp, state, keyIndices));
+			}
+		}
+
+		TEST_METHOD(IntegerClassifierTest)
+		{
+			using sds::ThumbstickDirection;
+			Assert::IsTrue(sds::GetDirectionForStickValues(32767, 0) == ThumbstickDirection::Right);
+			Assert::IsTrue(sds::GetDirectionForStickValues(-32768, 0) == ThumbstickDirection::Left);
+			Assert::IsTrue(sds::GetDirectionForStickValues(0, 32767) == ThumbstickDirection::Up);
+			Assert::IsTrue(sds::GetDirectionForStickValues(0, -32768) == ThumbstickDirection::Down);
+			Assert::IsTrue(sds::GetDirectionForStickValues(-32768, -32768) == ThumbstickDirection::DownLeft);
+			Assert::IsTrue(sds::GetDirectionForStickValues(-20000, 20000) == ThumbstickDirection::LeftUp);
+			// Either side of tan(22.5 degrees), 5741 / 13860 is its closest approximation in range.
+			Assert::IsTrue(sds::GetDirectionForStickValues(13860, 5741) == ThumbstickDirection::UpRight);
+			Assert::IsTrue(sds::GetDirectionForStickValues(13860, 5740) == ThumbstickDirection::Right);
+			Assert::IsTrue(sds::IsStickBeyondDeadzone(-32768, -32768, ksp.LeftStickDeadzone));
+			Assert::IsFalse(sds::IsStickBeyondDeadzone(ksp.LeftStickDeadzone, 0, ksp.LeftStickDeadzone));
+			Assert::IsTrue(sds::IsStickBeyondDeadzone(ksp.LeftStickDeadzone, 1, ksp.LeftStickDeadzone));
+
+			// A strided sweep of the stick range, any difference from the float path must be at a sector bound, within float rounding.
+			constexpr int Stride{ 97 };
+			constexpr double BoundTolerance{ 1e-6 };
+			for (int x{ -32768 }; x <= 32767; x += Stride)
+			{
+				for (int y{ -32768 }; y <= 32767; y += Stride)
+				{
+					if (x == 0 && y == 0)
+						continue;
+					const auto floatDirection = sds::GetDirectionForPolarTheta(sds::ComputePolarPair(static_cast<float>(x), static_cast<float>(y)).second);
+					const auto integerDirection = sds::GetDirectionForStickValues(static_cast<std::int16_t>(x), static_cast<std::int16_t>(y));
+					if (floatDirection == integerDirection)
+						continue;
+					const auto theta = std::atan2(static_cast<double>(y), static_cast<double>(x));
+					const auto boundDistance = std::ranges::min(std::views::iota(-4, 4) | std::views::transform([theta](const int k) { return std::abs(theta - (2 * k + 1) * std::numbers::pi / 8); }));
+					Assert::IsTrue(boundDistance < BoundTolerance, L"Integer classifier differs from the float path away from a sector bound.");
+				}
+			}
+		}
+
+		TEST_METHOD(UnmappedKeysTest)
+		{
+			const std::vector mappings{ sds::CBActionMap{ .ButtonVirtualKeycode = ksp.ButtonB }, sds::CBActionMap{ .ButtonVirtualKeycode = ksp.RightTrigger } };
+			const sds::ControllerKeyIndexTable keyTable{ sds::KeyIndexMap{ mappings }, ksp };
+			sds::ControllerState state{};
+			state.Buttons = static_cast<std::uint16_t>(sds::controllercodes::A | sds::controllercodes::B);
+			state.LeftTrigger = 255;
+			state.RightTrigger = 255;
+			const auto downKeys = sds::DecodeControllerKeyMask(ksp, state);
+			Assert::IsTrue(std::popcount(downKeys) == 4);
+			Assert::IsTrue(keyTable.GetDownMask(downKeys) == sds::keyboardtypes::DownMask_t{ 0b11 }, L"Unmapped key in the down mask.");
+		}
+	};
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardStickQuantizer.h"
+#include "../XMapLib_Keyboard/KeyboardStateDecoder.h"
+
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestStickQuantizer)
+	{
+		static constexpr sds::KeyboardSettings ksp;
+
+		// Zone by the polar angle and squared magnitude, or none when within the deadzone or nearer a sector bound than double rounding.
+		static auto GetExpectedZone(const int x, const int y, const std::uint32_t sectorCount, const std::span<const sds::keyboardtypes::ThumbstickValue_t> thresholds) -> std::optional<std::optional<std::uint32_t>>
+		{
+			const auto squaredMagnitude = std::int64_t{ x } * x + std::int64_t{ y } * y;
+			const auto thresholdCount = static_cast<std::uint32_t>(std::ranges::count_if(thresholds, [squaredMagnitude](const auto t) { return squaredMagnitude > std::int64_t{ t } * t; }));
+			if (thresholdCount == 0)
+				return std::optional<std::uint32_t>{};
+			const auto sectorWidth = 2 * std::numbers::pi / sectorCount;
+			const auto position = (std::atan2(static_cast<double>(y), static_cast<double>(x)) + sectorWidth / 2) / sectorWidth;
+			if (std::abs(position - std::round(position)) < 1e-12)
+				return {};
+			const auto sector = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::floor(position)) + sectorCount) % sectorCount;
+			return std::optional<std::uint32_t>{ (thresholdCount - 1) * sectorCount + sector };
+		}
+
+		static auto GetZoneKeys(const std::size_t count)
+		{
+			std::vector<sds::keyboardtypes::VirtualKey_t> keys(count);
+			std::iota(keys.begin(), keys.end(), sds::keyboardtypes::VirtualKey_t{ 1 });
+			return keys;
+		}
+	public:
+		TEST_METHOD(MatchesIntegerClassifierTest)
+		{
+			for (const auto whichStick : { sds::ControllerStick::LeftStick, sds::ControllerStick::RightStick })
+			{
+				const auto quantizer = sds::StickQuantizer::GetDirectionQuantizer(ksp, whichStick);
+				const auto deadzone = whichStick == sds::ControllerStick::LeftStick ? ksp.LeftStickDeadzone : ksp.RightStickDeadzone;
+				const auto Check = [&](const int x, const int y)
+				{
+					const auto xValue = static_cast<std::int16_t>(x);
+					const auto yValue = static_cast<std::int16_t>(y);
+					const auto expected = sds::IsStickBeyondDeadzone(xValue, yValue, deadzone)
+						? sds::GetVirtualKeyFromDirection(ksp, sds::GetDirectionForStickValues(xValue, yValue), whichStick)
+						: std::optional<sds::keyboardtypes::VirtualKey_t>{};
+					Assert::IsTrue(quantizer.GetVirtualKey(xValue, yValue) == expected, L"Eight sector quantizer differs from the integer classifier.");
+				};
+				for (int x{ -32768 }; x <= 32767; x += 61)
+				{
+					for (int y{ -32768 }; y <= 32767; y += 61)
+						Check(x, y);
+				}
+				// The axes, the range ends and the deadzone edge.
+				for (const int value : std::array{ -32768, -32767, -1, 0, 1, 32767, -deadzone - 1, -deadzone, int{ deadzone }, deadzone + 1 })
+				{
+					Check(value, 0);
+					Check(0, value);
+					Check(value, value);
+					Check(value, -value);
+					Check(value, 1);
+					Check(-1, value);
+				}
+			}
+		}
+
+		TEST_METHOD(SectorsAndBandsTest)
+		{
+			constexpr std::array<sds::keyboardtypes::ThumbstickValue_t, 3> Thresholds{ 7000, 16000, 28000 };
+			std::mt19937 randomEngine{ 29 };
+			std::uniform_int_distribution<int> stickDist{ -32768, 32767 };
+			for (const std::uint32_t sectorCount : { 4u, 8u, 16u, 32u })
+			{
+				const sds::StickQuantizer quantizer{ sectorCount, Thresholds, GetZoneKeys(Thresholds.size() * sectorCount) };
+				Assert::IsTrue(quantizer.GetSectorCount() == sectorCount && quantizer.GetBandCount() == Thresholds.size());
+				for (int i{}; i < 200'000; ++i)
+				{
+					const auto x = stickDist(randomEngine);
+					const auto y = i % 4 == 0 ? x : stickDist(randomEngine);
+					const auto expected = GetExpectedZone(x, y, sectorCount, Thresholds);
+					if (expected)
+						Assert::IsTrue(quantizer.GetZone(static_cast<std::int16_t>(x), static_cast<std::int16_t>(y)) == *expected, L"Zone differs from the polar angle classifier.");
+				}
+				// Sector 0 is right, counter-clockwise.
+				Assert::IsTrue(quantizer.GetZone(30000, 0) == 2 * sectorCount);
+				Assert::IsTrue(quantizer.GetZone(0, 20000) == sectorCount + sectorCount / 4);
+				Assert::IsTrue(quantizer.GetZone(-10000, 0) == sectorCount / 2);
+				Assert::IsTrue(quantizer.GetZone(0, -32768) == 2 * sectorCount + 3 * sectorCount / 4);
+				Assert::IsTrue(quantizer.GetVirtualKey(-32768, 0) == static_cast<sds::keyboardtypes::VirtualKey_t>(2 * sectorCount + sectorCount / 2 + 1));
+				Assert::IsFalse(quantizer.GetZone(7000, 0).has_value(), L"Deadzone edge not within the deadzone.");
+				Assert::IsTrue(quantizer.GetZone(7000, 1) == 0u);
+				Assert::IsFalse(quantizer.GetZone(0, 0).has_value());
+			}
+
+			// With four sectors the diagonals are the bounds, a point on one belongs to the sector nearer the x axis.
+			const sds::StickQuantizer fourSectors{ 4, Thresholds, GetZoneKeys(Thresholds.size() * 4) };
+			Assert::IsTrue(fourSectors.GetZone(15000, 15000) == 4u);
+			Assert::IsTrue(fourSectors.GetZone(-15000, 15000) == 6u);
+			Assert::IsTrue(fourSectors.GetZone(-15000, -15000) == 6u);
+			Assert::IsTrue(fourSectors.GetZone(15000, -15000) == 4u);
+			Assert::IsTrue(fourSectors.GetZone(15000, 15001) == 5u);
+			Assert::IsTrue(fourSectors.GetZone(-32768, -32768) == 10u);
+		}
+
+		TEST_METHOD(ForEachDownVirtualKeycodeTest)
+		{
+			const auto leftStick = sds::StickQuantizer::GetDirectionQuantizer(ksp, sds::ControllerStick::LeftStick);
+			const auto rightStick = sds::StickQuantizer::GetDirectionQuantizer(ksp, sds::ControllerStick::RightStick);
+			sds::KeyboardSettings integerSettings;
+			integerSettings.StickDirectionClassifier = sds::StickClassifier::IntegerOctant;
+			std::mt19937 randomEngine{ 31 };
+			std::uniform_int_distribution<int> stickDist{ -32768, 32767 };
+			for (int i{}; i < 10'000; ++i)
+			{
+				sds::ControllerState state{};
+				state.Buttons = static_cast<std::uint16_t>(stickDist(randomEngine));
+				state.LeftTrigger = static_cast<std::uint8_t>(stickDist(randomEngine));
+				state.RightTrigger = static_cast<std::uint8_t>(stickDist(randomEngine));
+				state.LeftStickX = static_cast<std::int16_t>(stickDist(randomEngine));
+				state.LeftStickY = static_cast<std::int16_t>(stickDist(randomEngine) / (i % 8 + 1));
+				state.RightStickX = static_cast<std::int16_t>(stickDist(randomEngine) / (i % 8 + 1));
+				state.RightStickY = static_cast<std::int16_t>(stickDist(randomEngine));
+				sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> expected;
+				sds::ForEachDownVirtualKeycode(integerSettings, state, [&expected](const auto vk) { expected.emplace_back(vk); });
+				sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> quantized;
+				sds::ForEachDownVirtualKeycode(ksp, state, leftStick, rightStick, [&quantized](const auto vk) { quantized.emplace_back(vk); });
+				Assert::IsTrue(quantized == expected, L"Quantizer overload differs from the integer classifier.");
+			}
+		}
+
+		TEST_METHOD(InvalidConfigurationTest)
+		{
+			constexpr std::array<sds::keyboardtypes::ThumbstickValue_t, 2> Thresholds{ 7000, 16000 };
+			const auto keys = GetZoneKeys(16);
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 6, Thresholds, GetZoneKeys(12) }; });
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 8, Thresholds, std::span{ keys }.first(15) }; });
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 8, {}, std::span<const sds::keyboardtypes::VirtualKey_t>{} }; });
+			constexpr std::array<sds::keyboardtypes::ThumbstickValue_t, 2> Descending{ 16000, 7000 };
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 8, Descending, keys }; });
+			constexpr std::array<sds::keyboardtypes::ThumbstickValue_t, 2> Repeated{ 7000, 7000 };
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 8, Repeated, keys }; });
+			constexpr std::array<sds::keyboardtypes::ThumbstickValue_t, 1> Negative{ -1 };
+			Assert::ExpectException<std::runtime_error>([&]() { sds::StickQuantizer{ 8, Negative, std::span{ keys }.first(8) }; });
+		}
+	};
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "../XMapLib_Keyboard/KeyboardTranslator.h"
+#include "../XMapLib_Keyboard/KeyboardTranslationPipeline.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestTranslationPipeline)
+	{
+		TEST_METHOD(RingTest)
+		{
+			sds::SpscRing<int, 4> ring;
+			for (int i{}; i < 4; ++i)
+				Assert::IsTrue(ring.TryPush(i));
+			Assert::IsFalse(ring.TryPush(4), L"Push to full ring succeeded.");
+			Assert::IsTrue(ring.SizeApprox() == 4);
+			for (int i{}; i < 4; ++i)
+				Assert::IsTrue(ring.TryPop() == i, L"Ring not FIFO.");
+			Assert::IsFalse(ring.TryPop().has_value());
+			// Wraps around.
+			Assert::IsTrue(ring.TryPush(5));
+			Assert::IsTrue(ring.TryPop() == 5);
+		}
+
+		TEST_METHOD(ExecutorThreadTest)
+		{
+			constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+			const auto pollThreadId = std::this_thread::get_id();
+			std::atomic<int> downCount{};
+			std::atomic<int> upCount{};
+			std::atomic<bool> isOnPollThread{};
+			sds::KeyboardTranslator translator{ std::vector{
+				sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .UsesInfiniteRepeat = false,
+				.OnDown = [&]() { ++downCount; isOnPollThread = isOnPollThread || std::this_thread::get_id() == pollThreadId; },
+				.OnUp = [&]() { ++upCount; isOnPollThread = isOnPollThread || std::this_thread::get_id() == pollThreadId; } } } };
+			sds::TranslationEventPipeline<> pipeline{ translator.GetProfile() };
+
+			const auto startTime = TimeManagement::Clock_t::now();
+			sds::TranslationEventBuffer_t events;
+			translator.FillUpdatedEventsFromMask(translator.GetKeyIndexMap().GetDownMask(std::vector{ buttonA }), startTime, events);
+			pipeline.Submit(translator.GetEventDispatcher(), events);
+			Assert::IsTrue(translator.GetMappingState(0).IsDown(), L"State not advanced on submit.");
+			translator.FillUpdatedEventsFromMask({}, startTime, events);
+			Assert::IsTrue(events.size() == 1 && events.front().Transition == sds::TransitionKind::KeyUp);
+			pipeline.Submit(translator.GetEventDispatcher(), events);
+			pipeline.Stop();
+
+			Assert::IsTrue(downCount == 1 && upCount == 1, L"Callbacks not run before stop returned.");
+			Assert::IsFalse(isOnPollThread.load(), L"Callback run on the polling thread.");
+			const auto stats = pipeline.GetStats();
+			Assert::IsTrue(stats.SubmittedCount == 2 && stats.ExecutedCount == 2 && stats.OverflowCount == 0);
+		}
+
+		TEST_METHOD(BackpressureTest)
+		{
+			constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+			constexpr std::size_t EventCount{ 10 };
+			std::atomic<bool> isReleased{};
+			std::atomic<int> callbackCount{};
+			const auto GetMappings = [&]()
+			{
+				// The key-down callback blocks the executor until released.
+				return std::vector{ sds::CBActionMap{ .ButtonVirtualKeycode = buttonA, .OnDown = [&]() { ++callbackCount; isReleased.wait(false); },
+					.OnRepeat = [&]() { ++callbackCount; } } };
+			};
+			std::vector events(EventCount, sds::TranslationEvent{ .MappingVk = buttonA, .MappingIndex = 0, .Transition = sds::TransitionKind::KeyRepeat });
+			events.front().Transition = sds::TransitionKind::KeyDown;
+
+			// Drop: the executor can take at most one event before blocking, a ring of 4 holds the next 4, the other repeats are dropped.
+			sds::KeyboardTranslator dropTranslator{ GetMappings() };
+			sds::TranslationEventPipeline<4> dropPipeline{ dropTranslator.GetProfile(), sds::RingFullPolicy::Drop };
+			dropPipeline.Submit(dropTranslator.GetEventDispatcher(), events);
+			isReleased = true;
+			isReleased.notify_all();
+			dropPipeline.Stop();
+			const auto dropStats = dropPipeline.GetStats();
+			Assert::IsTrue(dropStats.SubmittedCount == EventCount);
+			Assert::IsTrue(dropStats.OverflowCount >= EventCount - 5, L"Overflow not counted.");
+			Assert::IsTrue(dropStats.BackpressureCount == dropStats.OverflowCount);
+			Assert::IsTrue(dropStats.ExecutedCount + dropStats.OverflowCount == EventCount);
+			Assert::IsTrue(callbackCount == static_cast<int>(dropStats.ExecutedCount));
+
+			// Wait: nothing is dropped.
+			callbackCount = 0;
+			sds::KeyboardTranslator waitTranslator{ GetMappings() };
+			sds::TranslationEventPipeline<4> waitPipeline{ waitTranslator.GetProfile(), sds::RingFullPolicy::Wait };
+			waitPipeline.Submit(waitTranslator.GetEventDispatcher(), events);
+			waitPipeline.Stop();
+			const auto waitStats = waitPipeline.GetStats();
+			Assert::IsTrue(waitStats.ExecutedCount == EventCount && waitStats.OverflowCount == 0);
+			Assert::IsTrue(callbackCount == static_cast<int>(EventCount));
+		}
+
+		TEST_METHOD(DropKeepsDownUpPairsTest)
+		{
+			// Down, repeats, up and reset cycles of two keys through a full ring: only repeats are dropped, every down executed gets its up.
+			constexpr std::array<sds::keyboardtypes::VirtualKey_t, 2> Keys{ sds::controllercodes::A, sds::controllercodes::B };
+			constexpr std::size_t CycleCount{ 20 };
+			std::atomic<bool> isReleased{};
+			std::array<std::atomic<int>, 2> downCounts{};
+			std::array<std::atomic<int>, 2> upCounts{};
+			std::array<std::atomic<int>, 2> resetCounts{};
+			std::vector<sds::CBActionMap> mappings;
+			for (std::size_t i{}; i < Keys.size(); ++i)
+			{
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = Keys[i],
+					.OnDown = [&, i]() { ++downCounts[i]; isReleased.wait(false); },
+					.OnUp = [&, i]() { ++upCounts[i]; },
+					.OnReset = [&, i]() { ++resetCounts[i]; } });
+			}
+			sds::KeyboardTranslator translator{ std::move(mappings) };
+			std::vector<sds::TranslationEvent> events;
+			for (std::size_t cycle{}; cycle < CycleCount; ++cycle)
+			{
+				for (const auto transition : { sds::TransitionKind::KeyDown, sds::TransitionKind::KeyRepeat, sds::TransitionKind::KeyRepeat,
+					sds::TransitionKind::KeyRepeat, sds::TransitionKind::KeyUp, sds::TransitionKind::Reset })
+				{
+					for (std::uint32_t i{}; i < Keys.size(); ++i)
+						events.emplace_back(sds::TranslationEvent{ .MappingVk = Keys[i], .MappingIndex = i, .Transition = transition });
+				}
+			}
+
+			sds::TranslationEventPipeline<4> pipeline{ translator.GetProfile(), sds::RingFullPolicy::Drop };
+			// The executor is blocked by the first key-down, released while the polling thread waits for room for a key-up.
+			std::jthread releaseThread{ [&]()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+				isReleased = true;
+				isReleased.notify_all();
+			} };
+			pipeline.Submit(translator.GetEventDispatcher(), events);
+			pipeline.Stop();
+
+			const auto stats = pipeline.GetStats();
+			Assert::IsTrue(stats.OverflowCount > 0, L"Full ring did not drop repeats.");
+			Assert::IsTrue(stats.ExecutedCount + stats.OverflowCount == events.size());
+			for (std::size_t i{}; i < Keys.size(); ++i)
+			{
+				Assert::IsTrue(downCounts[i] == static_cast<int>(CycleCount), L"Key-down dropped.");
+				Assert::IsTrue(upCounts[i] == downCounts[i], L"Key sent down never sent up.");
+				Assert::IsTrue(resetCounts[i] == static_cast<int>(CycleCount), L"Reset dropped.");
+			}
+		}
+	};
+}
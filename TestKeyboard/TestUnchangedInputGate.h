@@ -0,0 +1,174 @@
+#pragma once
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "../XMapLib_Keyboard/KeyboardUnchangedInputGate.h"
+#include "../XMapLib_Keyboard/KeyboardTranslator.h"
+#include "../XMapLib_Keyboard/KeyboardOvertakingFilter.h"
+#include "../XMapLib_Keyboard/KeyboardPriorityOvertakingFilter.h"
+
+#include <random>
+#include <tuple>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestUnchangedInputGate)
+	{
+		static constexpr std::array<sds::keyboardtypes::VirtualKey_t, 6> Buttons{ sds::controllercodes::A, sds::controllercodes::B, sds::controllercodes::X,
+			sds::controllercodes::Y, sds::controllercodes::LeftShoulder, sds::controllercodes::RightShoulder };
+
+		// Two exclusivity groups (A, X and the left shoulder, B and Y) and an ungrouped button, with repeat and reset delays a few updates long so that deadlines pass while a state is held.
+		static auto GetMappings()
+		{
+			using namespace std::chrono_literals;
+			std::vector<sds::CBActionMap> mappings;
+			for (std::size_t i{}; i < Buttons.size(); ++i)
+			{
+				mappings.emplace_back(sds::CBActionMap{ .ButtonVirtualKeycode = Buttons[i], .UsesInfiniteRepeat = i % 2 == 0,
+					.ExclusivityGrouping = i < 4 ? std::optional<sds::keyboardtypes::GrpVal_t>(100 + i % 2) : std::nullopt,
+					.DelayBeforeFirstRepeat = 3ms, .DelayForRepeats = 2ms });
+			}
+			// The left shoulder joins the group of A and X, so a group has three members.
+			mappings[4].ExclusivityGrouping = 100;
+			return mappings;
+		}
+
+		static auto GetDownMask(const sds::KeyIndexMap& keyIndices, const sds::ControllerState& state)
+		{
+			sds::keyboardtypes::SmallVector_t<sds::keyboardtypes::VirtualKey_t> downKeys;
+			for (const auto vk : Buttons)
+			{
+				if ((state.Buttons & vk) != 0)
+					downKeys.emplace_back(vk);
+			}
+			return keyIndices.GetDownMask(downKeys);
+		}
+
+		// Runs scripted states through a translator updated every poll, and one behind the gate, the events of each poll must be the same.
+		template<typename Filter_t>
+		static void CheckSkipMatchesTranslation(Filter_t filter, const bool hasPacketNumbers)
+		{
+			using namespace std::chrono_literals;
+			sds::KeyboardTranslator translator{ GetMappings(), Filter_t{ filter } };
+			sds::KeyboardTranslator gatedTranslator{ GetMappings(), std::move(filter) };
+			sds::UnchangedInputGate inputGate{ hasPacketNumbers };
+			const auto& keyIndices = translator.GetKeyIndexMap();
+			const auto Decode = [&keyIndices](const sds::ControllerState& state) { return GetDownMask(keyIndices, state); };
+			const auto GetEventTuples = [](const sds::TranslationEventBuffer_t& events)
+			{
+				std::vector<std::tuple<sds::keyboardtypes::VirtualKey_t, sds::TransitionKind, TimeManagement::TimePoint_t>> tuples;
+				for (const auto& event : events)
+					tuples.emplace_back(event.MappingVk, event.Transition, event.TimePoint);
+				return tuples;
+			};
+
+			std::mt19937 randomEngine{ 17 };
+			sds::ControllerState state{};
+			sds::TranslationEventBuffer_t events;
+			sds::TranslationEventBuffer_t gatedEvents;
+			auto updateTime = TimeManagement::Clock_t::now();
+			for (int i{}; i < 20'000; ++i)
+			{
+				// A new state every few polls, several buttons may change at once. A new packet with the same buttons is a change of an unmapped input.
+				if (randomEngine() % 6 == 0)
+				{
+					++state.PacketNumber;
+					for (auto toggleCount = randomEngine() % 4; toggleCount > 0; --toggleCount)
+						state.Buttons ^= static_cast<std::uint16_t>(Buttons[randomEngine() % Buttons.size()]);
+				}
+				updateTime += 1ms;
+				translator.FillUpdatedEventsFromMask(Decode(state), updateTime, events);
+				translator.GetEventDispatcher()(events);
+
+				gatedEvents.clear();
+				if (const auto downMask = inputGate.GetChangedDownMask(state, gatedTranslator.IsIdleAt(updateTime), Decode))
+				{
+					gatedTranslator.FillUpdatedEventsFromMask(*downMask, updateTime, gatedEvents);
+					gatedTranslator.GetEventDispatcher()(gatedEvents);
+				}
+				Assert::IsTrue(GetEventTuples(events) == GetEventTuples(gatedEvents), L"Gated translation differs from the translation of every poll.");
+			}
+			const auto& stats = inputGate.GetStats();
+			Assert::IsTrue(stats.PollCount == 20'000);
+			Assert::IsTrue(hasPacketNumbers ? stats.PacketSkipCount > 0 : stats.PacketSkipCount == 0);
+			Assert::IsTrue(stats.DownMaskSkipCount > 0, L"No unmapped input change skipped.");
+		}
+	public:
+		TEST_METHOD(SkipMatchesTranslationTest)
+		{
+			for (const bool hasPacketNumbers : { true, false })
+			{
+				CheckSkipMatchesTranslation(sds::KeyboardOvertakingFilter{}, hasPacketNumbers);
+				CheckSkipMatchesTranslation(sds::KeyboardOvertakingFilter{ sds::OvertakingFilterMode::SettledKeyPerUpdate }, hasPacketNumbers);
+				CheckSkipMatchesTranslation(sds::KeyboardPriorityOvertakingFilter{}, hasPacketNumbers);
+			}
+		}
+
+		TEST_METHOD(UnsettledFilterTest)
+		{
+			// Two new keys of a group down at once, the second overtakes on the next update with the same input.
+			std::vector<sds::CBActionMap> mappings{ sds::CBActionMap{ .ButtonVirtualKeycode = Buttons[0], .ExclusivityGrouping = 100 },
+				sds::CBActionMap{ .ButtonVirtualKeycode = Buttons[1], .ExclusivityGrouping = 100 } };
+			sds::KeyboardOvertakingFilter filter;
+			filter.SetMappingRange(mappings);
+			Assert::IsTrue(filter.IsSettled());
+			std::ignore = filter.GetFilteredButtonState({ Buttons[0], Buttons[1] });
+			Assert::IsFalse(filter.IsSettled(), L"Deferred overtaking member not reported.");
+			std::ignore = filter.GetFilteredButtonState({ Buttons[0], Buttons[1] });
+			Assert::IsTrue(filter.IsSettled());
+
+			// The activated key is released, the key it overtook is forwarded on the next update.
+			const auto releasedState = filter.GetFilteredButtonState({ Buttons[0] });
+			Assert::IsTrue(releasedState.empty());
+			Assert::IsFalse(filter.IsSettled(), L"Newly activated member not reported.");
+			const auto settledState = filter.GetFilteredButtonState({ Buttons[0] });
+			Assert::IsTrue(settledState.size() == 1 && settledState.front() == Buttons[0]);
+			Assert::IsTrue(filter.IsSettled());
+		}
+
+		TEST_METHOD(StatsTest)
+		{
+			using namespace std::chrono_literals;
+			sds::KeyboardTranslator translator{ std::vector{ sds::CBActionMap{ .ButtonVirtualKeycode = Buttons[0], .DelayBeforeFirstRepeat = 10ms } }, sds::KeyboardOvertakingFilter{} };
+			sds::UnchangedInputGate inputGate{};
+			int decodeCount{};
+			const auto Decode = [&](const sds::ControllerState& state)
+			{
+				++decodeCount;
+				return GetDownMask(translator.GetKeyIndexMap(), state);
+			};
+			sds::TranslationEventBuffer_t events;
+			const auto startTime = TimeManagement::Clock_t::now();
+			const auto Poll = [&](const sds::ControllerState& state, const TimeManagement::Nanos_t offset)
+			{
+				const auto downMask = inputGate.GetChangedDownMask(state, translator.IsIdleAt(startTime + offset), Decode);
+				if (downMask.has_value())
+				{
+					translator.FillUpdatedEventsFromMask(*downMask, startTime + offset, events);
+					translator.GetEventDispatcher()(events);
+				}
+				return downMask.has_value();
+			};
+
+			const sds::ControllerState downState{ .PacketNumber = 1, .Buttons = static_cast<std::uint16_t>(Buttons[0]) };
+			Assert::IsTrue(Poll(downState, 0ms));
+			Assert::IsFalse(Poll(downState, 1ms), L"Unchanged packet not skipped.");
+			Assert::IsFalse(Poll(downState, 2ms));
+			// A new packet with the same down mask, an unmapped trigger value.
+			Assert::IsFalse(Poll(sds::ControllerState{ .PacketNumber = 2, .Buttons = downState.Buttons, .LeftTrigger = 5 }, 3ms), L"Unchanged down mask not skipped.");
+			Assert::IsTrue(decodeCount == 2);
+			// The first repeat deadline has passed, the same packet is translated.
+			Assert::IsTrue(Poll(sds::ControllerState{ .PacketNumber = 2, .Buttons = downState.Buttons, .LeftTrigger = 5 }, 11ms), L"Passed deadline skipped.");
+			Assert::IsTrue(events.size() == 1 && events.front().Transition == sds::TransitionKind::KeyRepeat);
+			Assert::IsTrue(Poll(sds::ControllerState{ .PacketNumber = 3 }, 12ms));
+
+			const auto& stats = inputGate.GetStats();
+			Assert::IsTrue(stats.PollCount == 6 && stats.PacketSkipCount == 2 && stats.DownMaskSkipCount == 1);
+
+			// After a reset the same packet is translated again.
+			inputGate.Reset();
+			Assert::IsTrue(Poll(sds::ControllerState{ .PacketNumber = 3 }, 13ms));
+		}
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <cstdlib>
+#include <new>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+/*
+ *	Note: Replaces the global allocation functions for the test module, to count the allocations made on the calling thread.
+ *	Must only be included by the one translation unit (TestKeyboard.cpp).
+ */
+
+namespace TestKeyboard
+{
+	inline thread_local std::size_t ThreadAllocationCount{};
+}
+
+void* operator new(const std::size_t count)
+{
+	++TestKeyboard::ThreadAllocationCount;
+	if (void* ptr = std::malloc(count == 0 ? 1 : count))
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace TestKeyboard
+{
+	TEST_CLASS(TestZeroAllocation)
+	{
+		// Mappings with no callbacks, and a repeat and reset cycle.
+		static auto GetCycleMappings()
+		{
+			using namespace std::chrono_literals;
+			constexpr sds::keyboardtypes::VirtualKey_t buttonA{ sds::controllercodes::A };
+			constexpr sds::keyboardtypes::VirtualKey_t buttonB{ sds::controllercodes::B };
+			return std::vector{
+				sds::CBActionMap{.ButtonVirtualKeycode = buttonA, .UsesInfiniteRepeat = true, .DelayBeforeFirstRepeat = 10ms, .DelayForRepeats = 5ms },
+				sds::CBActionMap{.ButtonVirtualKeycode = buttonB, .UsesInfiniteRepeat = true, .DelayBeforeFirstRepeat = 10ms, .DelayForRepeats = 5ms } };
+		}
+
+		// Runs a down, first repeat, repeat, up, and reset cycle for both mappings with the update function, returns the number of transitions.
+		static auto RunCycle(auto& updateFn, TimeManagement::TimePoint_t& timePoint) -> std::size_t
+		{
+			using namespace std::chrono_literals;
+			const sds::keyboardtypes::DownMask_t bothDown{ 0b11 };
+			std::size_t transitionCount{};
+			transitionCount += updateFn(bothDown, timePoint += 1ms);
+			transitionCount += updateFn(bothDown, timePoint += 11ms);
+			transitionCount += updateFn(bothDown, timePoint += 6ms);
+			transitionCount += updateFn({}, timePoint += 1ms);
+			transitionCount += updateFn({}, timePoint += 6ms);
+			return transitionCount;
+		}
+
+		TEST_METHOD(ReusedTranslationPackTest)
+		{
+			sds::KeyboardTranslator<> translator{ GetCycleMappings() };
+			sds::TranslationPack translations;
+			auto timePoint = TimeManagement::Clock_t::now();
+			auto UpdateFn = [&](const sds::keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t tp)
+			{
+				translator.FillUpdatedStateFromMask(downMask, tp, translations);
+				translations();
+				return translations.UpRequests.size() + translations.DownRequests.size() + translations.RepeatRequests.size() + translations.UpdateRequests.size();
+			};
+
+			// Warm-up, the pack ranges and timer queue reach their capacity.
+			Assert::IsTrue(RunCycle(UpdateFn, timePoint) == 10, L"Warm-up cycle transition count not 10.");
+
+			const auto allocationsBefore = ThreadAllocationCount;
+			const auto transitionCount = RunCycle(UpdateFn, timePoint);
+			Assert::IsTrue(ThreadAllocationCount == allocationsBefore, L"Allocation after warm-up.");
+			Assert::IsTrue(transitionCount == 10);
+		}
+
+		TEST_METHOD(VisitorSinkTest)
+		{
+			sds::KeyboardTranslator<> translator{ GetCycleMappings() };
+			std::array<std::size_t, 4> transitionCounts{};
+			auto timePoint = TimeManagement::Clock_t::now();
+			auto UpdateFn = [&](const sds::keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t tp)
+			{
+				std::size_t count{};
+				translator.VisitUpdatedStateFromMask(downMask, tp, [&](sds::keyboardtypes::VirtualKey_t, const sds::TransitionKind transition)
+				{
+					++transitionCounts[static_cast<std::size_t>(transition)];
+					++count;
+				});
+				return count;
+			};
+
+			Assert::IsTrue(RunCycle(UpdateFn, timePoint) == 10, L"Warm-up cycle transition count not 10.");
+
+			const auto allocationsBefore = ThreadAllocationCount;
+			const auto transitionCount = RunCycle(UpdateFn, timePoint);
+			Assert::IsTrue(ThreadAllocationCount == allocationsBefore, L"Allocation after warm-up.");
+			Assert::IsTrue(transitionCount == 10);
+			Assert::IsTrue(transitionCounts[static_cast<std::size_t>(sds::TransitionKind::KeyDown)] == 4);
+			Assert::IsTrue(transitionCounts[static_cast<std::size_t>(sds::TransitionKind::KeyRepeat)] == 8);
+			Assert::IsTrue(transitionCounts[static_cast<std::size_t>(sds::TransitionKind::KeyUp)] == 4);
+			Assert::IsTrue(transitionCounts[static_cast<std::size_t>(sds::TransitionKind::Reset)] == 4);
+		}
+
+		TEST_METHOD(GroupOvertakingTest)
+		{
+			// A sweep across the eight stick directions of one group, each direction overtaking the last.
+			constexpr std::array<sds::keyboardtypes::VirtualKey_t, 8> directionVks{ 0x5830, 0x5831, 0x5832, 0x5833, 0x5834, 0x5835, 0x5836, 0x5837 };
+			sds::GroupActivationInfo group;
+			std::array<sds::GroupActivationInfo::Slot_t, 8> slots{};
+			for (std::size_t i{}; i < directionVks.size(); ++i)
+				slots[i] = group.AddMember(directionVks[i]);
+
+			const auto allocationsBefore = ThreadAllocationCount;
+			for (int sweep{}; sweep < 10; ++sweep)
+			{
+				for (std::size_t i{}; i < slots.size(); ++i)
+				{
+					const auto [isFiltered, upOpt] = group.UpdateForMemberDown(slots[i]);
+					Assert::IsFalse(isFiltered);
+					Assert::IsTrue(upOpt.has_value() == (i > 0), L"Overtaken direction not sent a key-up.");
+					if (i > 0)
+						group.UpdateForMemberUp(slots[i - 1]);
+				}
+				Assert::IsTrue(group.GetActivatedValue() == directionVks.back());
+				group.UpdateForMemberUp(slots.back());
+				Assert::IsFalse(group.IsAnyMappingActivated());
+			}
+			Assert::IsTrue(ThreadAllocationCount == allocationsBefore, L"Allocation while overtaking.");
+		}
+	};
+}
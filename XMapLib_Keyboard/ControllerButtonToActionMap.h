@@ -88,7 +88,14 @@ namespace sds
 		 *	can perform the key-down.
 		 * \remarks		optional, if not in use set to default constructed value or '{}'
 		 */
-		keyboardtypes::OptGrp_t ExclusivityGrouping; // TODO one variation of ex. group behavior is to have a priority value associated with the mapping.
+		keyboardtypes::OptGrp_t ExclusivityGrouping;
+
+		/**
+		 * \brief	Priority of the mapping within its exclusivity grouping, used by the <c>KeyboardPriorityOvertakingFilter</c>: of the held keys in a group,
+		 *	the one with the highest priority is activated, whatever the press order.
+		 * \remarks	optional, ignored by the default (last pressed wins) <c>KeyboardOvertakingFilter</c>.
+		 */
+		keyboardtypes::Priority_t ExclusivityPriority{};
 		keyboardtypes::Fn_t OnDown; // Key-down
 		keyboardtypes::Fn_t OnUp; // Key-up
 		keyboardtypes::Fn_t OnRepeat; // Key-repeat
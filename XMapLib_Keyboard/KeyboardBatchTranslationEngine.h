@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "KeyboardTranslator.h"
+
+namespace sds
+{
+	// A single controller state update, the 'down' virtual keycodes.
+	using StateUpdate_t = keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>;
+
+	/**
+	 * \brief	A state update of a recorded input stream, with the time it was polled. Replaying the stream judges repeat and reset delays against
+	 *	the recorded time points, so the result does not depend on how fast the batch runs.
+	 */
+	struct RecordedStateUpdate final
+	{
+		TimeManagement::TimePoint_t TimePoint;
+		StateUpdate_t DownKeys;
+	};
+
+	// A translator that can translate a view of a recorded update at the update's own time point.
+	template<typename Translator_t>
+	concept BatchInputTranslator_c = InputTranslator_c<Translator_t>
+		&& requires(Translator_t & t, const std::span<const keyboardtypes::VirtualKey_t> stateUpdate, const TimeManagement::TimePoint_t timePoint)
+	{
+		{ t(stateUpdate, timePoint) } -> std::convertible_to<TranslationPack>;
+	};
+
+	/**
+	 * \brief	One independent unit of batch work: a translator and the input stream (sequence of recorded state updates) to run through it, in order.
+	 * \remarks The translator and the stream are not owned, and the translator must not be shared with another job in the same batch.
+	 */
+	template<BatchInputTranslator_c Translator_t>
+	struct BatchTranslationJob final
+	{
+		std::reference_wrapper<Translator_t> Translator;
+		std::span<const RecordedStateUpdate> StateUpdates;
+	};
+
+	/**
+	 * \brief	Aggregate statistics of a batch run.
+	 */
+	struct BatchTranslationStats final
+	{
+		std::size_t JobCount{};
+		std::size_t UpdateCount{};
+		// Translation results produced (and performed) over every job.
+		std::size_t EventCount{};
+		// Jobs run by a worker other than the one they were first assigned to.
+		std::size_t StolenJobCount{};
+		TimeManagement::Nanos_t Elapsed{};
+
+		[[nodiscard]]
+		auto GetEventsPerSecond() const noexcept -> double
+		{
+			const auto elapsedSeconds = std::chrono::duration<double>(Elapsed).count();
+			return elapsedSeconds > 0.0 ? static_cast<double>(EventCount) / elapsedSeconds : 0.0;
+		}
+	};
+
+	/**
+	 * \brief	Runs many independent (translator, input stream) jobs across a work-stealing pool of threads. Each job is run on one thread, every
+	 *	state update of the stream is passed to the translator as a view, with its recorded time point, and the resulting translation pack is performed.
+	 * \remarks Jobs are dealt round-robin to per-worker queues (of job indices), a worker takes from the back of its own queue and, when empty, steals from the
+	 *	front of another's. The updates are not copied. Mapping callbacks are called from the worker threads, so they must be safe to call concurrently across jobs.
+	 *	<p>The worker threads exist for the duration of a <c>Run</c>.</p>
+	 */
+	template<BatchInputTranslator_c Translator_t>
+	class BatchTranslationEngine final
+	{
+		struct WorkerQueue final
+		{
+			std::mutex QueueMutex;
+			std::deque<std::size_t> JobIndices;
+		};
+
+		std::size_t m_threadCount{};
+	public:
+		/**
+		 * \brief Ctor, with the number of worker threads. Defaults to the hardware concurrency.
+		 */
+		explicit BatchTranslationEngine(const std::size_t threadCount = std::thread::hardware_concurrency())
+			: m_threadCount(std::max<std::size_t>(threadCount, 1))
+		{
+		}
+
+		/**
+		 * \brief Runs every job to completion, blocking until done.
+		 * \param jobs The jobs to run, each translator is used by one thread only.
+		 * \return Aggregate statistics of the run.
+		 */
+		auto Run(const std::span<BatchTranslationJob<Translator_t>> jobs) -> BatchTranslationStats
+		{
+			const auto workerCount = std::min(m_threadCount, std::max<std::size_t>(jobs.size(), 1));
+			std::vector<WorkerQueue> queues(workerCount);
+			for (std::size_t i{}; i < jobs.size(); ++i)
+				queues[i % workerCount].JobIndices.push_back(i);
+
+			std::atomic<std::size_t> updateCount{};
+			std::atomic<std::size_t> eventCount{};
+			std::atomic<std::size_t> stolenCount{};
+			const auto startTime = TimeManagement::Clock_t::now();
+			{
+				std::vector<std::jthread> workers;
+				workers.reserve(workerCount);
+				for (std::size_t workerIndex{}; workerIndex < workerCount; ++workerIndex)
+				{
+					workers.emplace_back([&, workerIndex]()
+					{
+						std::size_t workerUpdates{};
+						std::size_t workerEvents{};
+						std::size_t workerStolen{};
+						while (const auto job = TakeJob(queues, workerIndex, workerStolen))
+						{
+							auto& translator = jobs[*job].Translator.get();
+							for (const auto& stateUpdate : jobs[*job].StateUpdates)
+							{
+								const auto translations = translator(std::span{ stateUpdate.DownKeys }, stateUpdate.TimePoint);
+								translations();
+								workerEvents += translations.UpRequests.size() + translations.DownRequests.size()
+									+ translations.RepeatRequests.size() + translations.UpdateRequests.size();
+							}
+							workerUpdates += jobs[*job].StateUpdates.size();
+						}
+						updateCount += workerUpdates;
+						eventCount += workerEvents;
+						stolenCount += workerStolen;
+					});
+				}
+			}
+			return BatchTranslationStats
+			{
+				.JobCount = jobs.size(),
+				.UpdateCount = updateCount.load(),
+				.EventCount = eventCount.load(),
+				.StolenJobCount = stolenCount.load(),
+				.Elapsed = TimeManagement::Clock_t::now() - startTime
+			};
+		}
+
+		[[nodiscard]]
+		auto GetThreadCount() const noexcept -> std::size_t
+		{
+			return m_threadCount;
+		}
+	private:
+		// Takes a job from the worker's own queue, else steals one. No jobs are added during a run, so all queues empty means done.
+		static auto TakeJob(std::vector<WorkerQueue>& queues, const std::size_t workerIndex, std::size_t& stolenCount) -> std::optional<std::size_t>
+		{
+			{
+				auto& ownQueue = queues[workerIndex];
+				std::scoped_lock lock{ ownQueue.QueueMutex };
+				if (!ownQueue.JobIndices.empty())
+				{
+					const auto jobIndex = ownQueue.JobIndices.back();
+					ownQueue.JobIndices.pop_back();
+					return jobIndex;
+				}
+			}
+			for (std::size_t offset{ 1 }; offset < queues.size(); ++offset)
+			{
+				auto& victimQueue = queues[(workerIndex + offset) % queues.size()];
+				std::scoped_lock lock{ victimQueue.QueueMutex };
+				if (!victimQueue.JobIndices.empty())
+				{
+					const auto jobIndex = victimQueue.JobIndices.front();
+					victimQueue.JobIndices.pop_front();
+					++stolenCount;
+					return jobIndex;
+				}
+			}
+			return {};
+		}
+	};
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "KeyboardControllerState.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	// Concept for a connection probe, the backend's check of whether a controller is connected to a player slot. It may be expensive (XInput on an
+	// empty slot takes about a millisecond), the monitor calls it on its own thread only.
+	template<typename Probe_t>
+	concept ConnectionProbe_c = requires(Probe_t & t)
+	{
+		{ t.IsConnected(std::size_t{}) } -> std::convertible_to<bool>;
+	};
+
+	/**
+	 * \brief	Delays between the probes of a disconnected slot: the initial delay, doubled after each failed probe up to the maximum delay.
+	 */
+	struct ConnectionBackoff final
+	{
+		TimeManagement::Nanos_t InitialDelay{ std::chrono::milliseconds{ 100 } };
+		TimeManagement::Nanos_t MaxDelay{ std::chrono::seconds{ 2 } };
+	};
+
+	/**
+	 * \brief	The probe schedule of a <c>ControllerConnectionMonitor</c>, without the thread: only disconnected slots are probed, each on an exponential
+	 *	backoff. A connected slot is not probed, the poll of the live pad reports its disconnection (<c>SetDisconnected</c>).
+	 * \remarks Every slot starts disconnected, with a probe due at the start time. A slot reported disconnected is probed again after the initial delay,
+	 *	so that a brief disconnection is recovered quickly.
+	 */
+	class ConnectionProbeSchedule final
+	{
+		struct SlotState_t final
+		{
+			bool IsConnected{};
+			TimeManagement::TimePoint_t NextProbeTime{};
+			// Delay after the next probe, if it fails.
+			TimeManagement::Nanos_t ProbeDelay{};
+		};
+
+		std::array<SlotState_t, controllercodes::MaxPlayerCount> m_slots{};
+		std::size_t m_playerCount{};
+		ConnectionBackoff m_backoff;
+		std::uint64_t m_probeCount{};
+	public:
+		/**
+		 * \brief Ctor, throws on a player count of zero or above <c>controllercodes::MaxPlayerCount</c>, or an invalid backoff.
+		 * \param playerCount Number of player slots, from slot 0.
+		 * \param backoff The probe delays of a disconnected slot.
+		 * \param startTime Time of the first probe of every slot.
+		 */
+		ConnectionProbeSchedule(const std::size_t playerCount, const ConnectionBackoff backoff, const TimeManagement::TimePoint_t startTime)
+			: m_playerCount(playerCount), m_backoff(backoff)
+		{
+			if (playerCount == 0 || playerCount > controllercodes::MaxPlayerCount)
+				throw std::runtime_error("Exception: connection probe schedule player count must be 1 to MaxPlayerCount.");
+			if (backoff.InitialDelay <= TimeManagement::Nanos_t{} || backoff.MaxDelay < backoff.InitialDelay)
+				throw std::runtime_error("Exception: connection backoff initial delay must be positive and not above the max delay.");
+			for (auto& slot : m_slots)
+				slot = SlotState_t{ .NextProbeTime = startTime, .ProbeDelay = backoff.InitialDelay };
+		}
+
+		/**
+		 * \brief Probes the disconnected slots with a probe due at the time point. A failed probe doubles the slot's delay, up to the maximum.
+		 * \return True if a slot was found connected.
+		 */
+		template<ConnectionProbe_c Probe_t>
+		auto ProbeDue(Probe_t& probe, const TimeManagement::TimePoint_t timePoint) -> bool
+		{
+			bool hasConnected{};
+			for (std::size_t playerId{}; playerId < m_playerCount; ++playerId)
+			{
+				auto& slot = m_slots[playerId];
+				if (slot.IsConnected || timePoint < slot.NextProbeTime)
+					continue;
+				++m_probeCount;
+				if (probe.IsConnected(playerId))
+				{
+					slot.IsConnected = true;
+					hasConnected = true;
+					continue;
+				}
+				slot.NextProbeTime = timePoint + slot.ProbeDelay;
+				slot.ProbeDelay = std::min(slot.ProbeDelay * 2, m_backoff.MaxDelay);
+			}
+			return hasConnected;
+		}
+
+		/**
+		 * \brief The controller of a connected slot was found disconnected, the slot is probed again after the initial delay. No effect on a
+		 *	slot already disconnected, its backoff continues.
+		 */
+		void SetDisconnected(const std::size_t playerId, const TimeManagement::TimePoint_t timePoint) noexcept
+		{
+			auto& slot = m_slots[playerId];
+			if (!slot.IsConnected)
+				return;
+			slot = SlotState_t{ .NextProbeTime = timePoint + m_backoff.InitialDelay, .ProbeDelay = std::min(m_backoff.InitialDelay * 2, m_backoff.MaxDelay) };
+		}
+
+		/**
+		 * \brief Earliest probe time of the disconnected slots, nothing if every slot is connected.
+		 */
+		[[nodiscard]]
+		auto GetNextProbeTime() const noexcept -> std::optional<TimeManagement::TimePoint_t>
+		{
+			std::optional<TimeManagement::TimePoint_t> nextProbeTime;
+			for (std::size_t playerId{}; playerId < m_playerCount; ++playerId)
+			{
+				const auto& slot = m_slots[playerId];
+				if (!slot.IsConnected && (!nextProbeTime || slot.NextProbeTime < *nextProbeTime))
+					nextProbeTime = slot.NextProbeTime;
+			}
+			return nextProbeTime;
+		}
+
+		[[nodiscard]] auto IsConnected(const std::size_t playerId) const noexcept -> bool { return m_slots[playerId].IsConnected; }
+		[[nodiscard]] auto GetPlayerCount() const noexcept -> std::size_t { return m_playerCount; }
+		[[nodiscard]] auto GetProbeCount() const noexcept -> std::uint64_t { return m_probeCount; }
+	};
+
+	/**
+	 * \brief	Controller hot-plug monitor: probes the disconnected player slots on a <c>ConnectionProbeSchedule</c> from its own thread, and publishes a
+	 *	connected flag per slot. The polling loop reads the cached flag and polls only the live pads, it never calls the OS API on an empty slot.
+	 * \remarks When the poll of a live pad fails, the polling loop calls <c>ReportDisconnected</c> and the slot's probing resumes. The monitor thread
+	 *	sleeps until the next probe is due, or a disconnection is reported; with every slot connected it only waits.
+	 *	<p><c>IsConnected</c> and <c>ReportDisconnected</c> may be called from any thread. Not copyable or movable, the thread is joined on destruction.</p>
+	 */
+	template<ConnectionProbe_c Probe_t, TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
+	class ControllerConnectionMonitor final
+	{
+		Probe_t m_probe;
+		// Monitor thread only.
+		ConnectionProbeSchedule m_schedule;
+		std::array<std::atomic<bool>, controllercodes::MaxPlayerCount> m_isConnected{};
+		// Bit per player slot, reported disconnected and not yet handled by the monitor thread.
+		std::atomic<std::uint32_t> m_reportedMask{};
+		std::atomic<std::uint64_t> m_probeCount{};
+		std::mutex m_wakeMutex;
+		std::condition_variable_any m_wakeCondition;
+		// Last member, started after everything it uses is constructed.
+		std::jthread m_monitorThread;
+	public:
+		ControllerConnectionMonitor(const ControllerConnectionMonitor&) = delete;
+		auto operator=(const ControllerConnectionMonitor&) -> ControllerConnectionMonitor& = delete;
+
+		/**
+		 * \brief Ctor, starts the monitor thread. Throws as <c>ConnectionProbeSchedule</c> does.
+		 * \param probe The backend's connection probe, called on the monitor thread.
+		 * \param playerCount Number of player slots monitored, from slot 0.
+		 * \param backoff The probe delays of a disconnected slot.
+		 */
+		explicit ControllerConnectionMonitor(Probe_t probe, const std::size_t playerCount = controllercodes::MaxPlayerCount, const ConnectionBackoff backoff = {})
+			: m_probe(std::move(probe)), m_schedule(playerCount, backoff, ClockPolicy_t::now())
+		{
+			m_monitorThread = std::jthread{ [this](const std::stop_token stopToken) { MonitorLoop(stopToken); } };
+		}
+
+		~ControllerConnectionMonitor()
+		{
+			Stop();
+		}
+
+		/**
+		 * \brief The cached connected flag of the slot, false for a slot not monitored.
+		 */
+		[[nodiscard]]
+		auto IsConnected(const std::size_t playerId) const noexcept -> bool
+		{
+			return playerId < m_isConnected.size() && m_isConnected[playerId].load(std::memory_order_acquire);
+		}
+
+		/**
+		 * \brief The poll of the slot's pad failed, the slot is marked disconnected and probed again by the monitor thread.
+		 */
+		void ReportDisconnected(const std::size_t playerId) noexcept
+		{
+			if (playerId >= m_schedule.GetPlayerCount())
+				return;
+			// Under the mutex the report is ordered with the monitor thread's publish and wait: the flag is not overwritten by a stale publish,
+			// and the wake-up is not lost.
+			{
+				std::scoped_lock wakeLock{ m_wakeMutex };
+				m_isConnected[playerId].store(false, std::memory_order_release);
+				m_reportedMask.fetch_or(std::uint32_t{ 1 } << playerId, std::memory_order_release);
+			}
+			m_wakeCondition.notify_one();
+		}
+
+		/**
+		 * \brief Number of probes performed, each an OS API call on a disconnected slot.
+		 */
+		[[nodiscard]]
+		auto GetProbeCount() const noexcept -> std::uint64_t
+		{
+			return m_probeCount.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * \brief Stops and joins the monitor thread, the connected flags keep their last value.
+		 */
+		void Stop() noexcept
+		{
+			if (!m_monitorThread.joinable())
+				return;
+			m_monitorThread.request_stop();
+			m_monitorThread.join();
+		}
+	private:
+		void MonitorLoop(const std::stop_token stopToken)
+		{
+			const auto HasReports = [this]() { return m_reportedMask.load(std::memory_order_acquire) != 0; };
+			while (!stopToken.stop_requested())
+			{
+				const auto timePoint = ClockPolicy_t::now();
+				const auto reportedMask = m_reportedMask.exchange(0, std::memory_order_acq_rel);
+				for (std::size_t playerId{}; playerId < m_schedule.GetPlayerCount(); ++playerId)
+				{
+					if ((reportedMask >> playerId) & 1u)
+						m_schedule.SetDisconnected(playerId, timePoint);
+				}
+				m_schedule.ProbeDue(m_probe, timePoint);
+				m_probeCount.store(m_schedule.GetProbeCount(), std::memory_order_relaxed);
+
+				std::unique_lock wakeLock{ m_wakeMutex };
+				// A slot reported since the exchange above is not published, its flag stays false and the report is handled on the next
+				// iteration, as the wait does not block.
+				const auto pendingMask = m_reportedMask.load(std::memory_order_acquire);
+				for (std::size_t playerId{}; playerId < m_schedule.GetPlayerCount(); ++playerId)
+				{
+					if (((pendingMask >> playerId) & 1u) == 0)
+						m_isConnected[playerId].store(m_schedule.IsConnected(playerId), std::memory_order_release);
+				}
+				if (const auto nextProbeTime = m_schedule.GetNextProbeTime())
+					std::ignore = m_wakeCondition.wait_for(wakeLock, stopToken, *nextProbeTime - ClockPolicy_t::now(), HasReports);
+				else
+					std::ignore = m_wakeCondition.wait(wakeLock, stopToken, HasReports);
+			}
+		}
+	};
+}
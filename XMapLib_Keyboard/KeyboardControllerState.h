@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "KeyboardCustomTypes.h"
+
+namespace sds
+{
+	/**
+	 * \brief	The core library's own controller button and virtual keycode constants, so that it builds without the platform headers.
+	 * \remarks The values are those of the XInput API: a button is its <c>wButtons</c> bit, a trigger or stick direction its gamepad VK. The XInput
+	 *	backend (<c>KeyboardLegacyApiFunctions.h</c>) checks them against the SDK headers, other backends translate their device's codes to these.
+	 */
+	namespace controllercodes
+	{
+		// Button bits, the XINPUT_GAMEPAD_* values.
+		inline constexpr keyboardtypes::VirtualKey_t DpadUp{ 0x0001 };
+		inline constexpr keyboardtypes::VirtualKey_t DpadDown{ 0x0002 };
+		inline constexpr keyboardtypes::VirtualKey_t DpadLeft{ 0x0004 };
+		inline constexpr keyboardtypes::VirtualKey_t DpadRight{ 0x0008 };
+		inline constexpr keyboardtypes::VirtualKey_t Start{ 0x0010 };
+		inline constexpr keyboardtypes::VirtualKey_t Back{ 0x0020 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumb{ 0x0040 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumb{ 0x0080 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftShoulder{ 0x0100 };
+		inline constexpr keyboardtypes::VirtualKey_t RightShoulder{ 0x0200 };
+		inline constexpr keyboardtypes::VirtualKey_t A{ 0x1000 };
+		inline constexpr keyboardtypes::VirtualKey_t B{ 0x2000 };
+		inline constexpr keyboardtypes::VirtualKey_t X{ 0x4000 };
+		inline constexpr keyboardtypes::VirtualKey_t Y{ 0x8000 };
+
+		// Trigger VKs, VK_GAMEPAD_*_TRIGGER.
+		inline constexpr keyboardtypes::VirtualKey_t LeftTrigger{ 0xC9 };
+		inline constexpr keyboardtypes::VirtualKey_t RightTrigger{ 0xCA };
+
+		// Stick axis direction VKs, VK_GAMEPAD_*_THUMBSTICK_*.
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickUp{ 0xD3 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickDown{ 0xD4 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickRight{ 0xD5 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickLeft{ 0xD6 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickUp{ 0xD7 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickDown{ 0xD8 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickRight{ 0xD9 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickLeft{ 0xDA };
+
+		// Stick diagonal direction VKs, VK_PAD_*THUMB_*.
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpLeft{ 0x5824 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpRight{ 0x5825 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownRight{ 0x5826 };
+		inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownLeft{ 0x5827 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickUpLeft{ 0x5834 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickUpRight{ 0x5835 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickDownRight{ 0x5836 };
+		inline constexpr keyboardtypes::VirtualKey_t RightThumbstickDownLeft{ 0x5837 };
+
+		// XINPUT_GAMEPAD_*_DEADZONE and XINPUT_GAMEPAD_TRIGGER_THRESHOLD.
+		inline constexpr keyboardtypes::ThumbstickValue_t LeftStickDeadzone{ 7849 };
+		inline constexpr keyboardtypes::ThumbstickValue_t RightStickDeadzone{ 8689 };
+		inline constexpr keyboardtypes::TriggerValue_t TriggerThreshold{ 30 };
+
+		// XUSER_MAX_COUNT, the number of player (user) slots.
+		inline constexpr std::size_t MaxPlayerCount{ 4 };
+
+		// Key event stream codes, the XINPUT_KEYSTROKE VK_PAD_* values and flags.
+		namespace keystroke
+		{
+			inline constexpr keyboardtypes::VirtualKey_t A{ 0x5800 };
+			inline constexpr keyboardtypes::VirtualKey_t B{ 0x5801 };
+			inline constexpr keyboardtypes::VirtualKey_t X{ 0x5802 };
+			inline constexpr keyboardtypes::VirtualKey_t Y{ 0x5803 };
+			inline constexpr keyboardtypes::VirtualKey_t RightShoulder{ 0x5804 };
+			inline constexpr keyboardtypes::VirtualKey_t LeftShoulder{ 0x5805 };
+			inline constexpr keyboardtypes::VirtualKey_t LeftTrigger{ 0x5806 };
+			inline constexpr keyboardtypes::VirtualKey_t RightTrigger{ 0x5807 };
+			inline constexpr keyboardtypes::VirtualKey_t DpadUp{ 0x5810 };
+			inline constexpr keyboardtypes::VirtualKey_t DpadDown{ 0x5811 };
+			inline constexpr keyboardtypes::VirtualKey_t DpadLeft{ 0x5812 };
+			inline constexpr keyboardtypes::VirtualKey_t DpadRight{ 0x5813 };
+			inline constexpr keyboardtypes::VirtualKey_t Start{ 0x5814 };
+			inline constexpr keyboardtypes::VirtualKey_t Back{ 0x5815 };
+			inline constexpr keyboardtypes::VirtualKey_t LeftThumb{ 0x5816 };
+			inline constexpr keyboardtypes::VirtualKey_t RightThumb{ 0x5817 };
+			// First stick direction code, VK_PAD_*THUMB_UP, followed by down, right, left, up-left, up-right, down-right and down-left.
+			inline constexpr keyboardtypes::VirtualKey_t LeftThumbstickFirst{ 0x5820 };
+			inline constexpr keyboardtypes::VirtualKey_t RightThumbstickFirst{ 0x5830 };
+
+			// XINPUT_KEYSTROKE_* flags.
+			inline constexpr std::uint16_t KeyDownFlag{ 0x0001 };
+			inline constexpr std::uint16_t KeyUpFlag{ 0x0002 };
+			inline constexpr std::uint16_t RepeatFlag{ 0x0004 };
+		}
+	}
+
+	/**
+	 * \brief	One controller state update, the portable equivalent of <c>XINPUT_STATE</c>. A backend fills it from its device API, the state
+	 *	decoders consume it.
+	 */
+	struct ControllerState final
+	{
+		// Changes when the state changes, for a backend that provides one.
+		std::uint32_t PacketNumber{};
+		// The controllercodes button bits of the buttons held down.
+		std::uint16_t Buttons{};
+		keyboardtypes::TriggerValue_t LeftTrigger{};
+		keyboardtypes::TriggerValue_t RightTrigger{};
+		keyboardtypes::ThumbstickValue_t LeftStickX{};
+		keyboardtypes::ThumbstickValue_t LeftStickY{};
+		keyboardtypes::ThumbstickValue_t RightStickX{};
+		keyboardtypes::ThumbstickValue_t RightStickY{};
+
+		friend constexpr auto operator==(const ControllerState&, const ControllerState&) noexcept -> bool = default;
+	};
+
+	/**
+	 * \brief	One key event of a controller's event queue, the portable equivalent of <c>XINPUT_KEYSTROKE</c>. A backend drains its queue in order,
+	 *	the <c>KeystrokeDecoder</c> consumes them.
+	 */
+	struct ControllerKeystroke final
+	{
+		// A controllercodes::keystroke code.
+		keyboardtypes::VirtualKey_t VirtualKey{};
+		// The controllercodes::keystroke flags, a repeat is sent with the key-down flag.
+		std::uint16_t Flags{};
+		// Player slot of the controller.
+		std::uint8_t UserIndex{};
+
+		friend constexpr auto operator==(const ControllerKeystroke&, const ControllerKeystroke&) noexcept -> bool = default;
+	};
+}
@@ -4,6 +4,7 @@
 //#define USERHAS_BOOST
 #endif
 
+#include <bitset>
 #include <deque>
 #include <functional>
 #include <optional>
@@ -20,16 +21,19 @@
 namespace sds::keyboardtypes
 {
 	static constexpr std::size_t SmallBufferSize{ 32 };
+	static constexpr std::size_t MaxMappingCount{ 128 }; // Capacity of the per-translator dense down-key bitmask.
 	using Fn_t = std::function<void()>;
 	using OptFn_t = std::optional<Fn_t>;
 	using NanosDelay_t = std::chrono::nanoseconds;
 	using OptNanosDelay_t = std::optional<NanosDelay_t>;
 	using GrpVal_t = std::uint32_t;
 	using OptGrp_t = std::optional<GrpVal_t>;
+	using Priority_t = std::uint32_t; // Exclusivity group member priority, higher wins.
 	using VirtualKey_t = int32_t;
 	using TriggerValue_t = uint8_t; // Hardware trigger value
 	using ThumbstickValue_t = int16_t; // Hardware thumbstick value
 	using Index_t = uint32_t; // Nothing we work with will have more elements than a 32 bit uint can position for.
+	using DownMask_t = std::bitset<MaxMappingCount>; // Bit N set means the mapping with dense index N is 'down'.
 
 	// Some types and values for use with cartesian/polar computations, that kind of thing.
 	using ComputationFloat_t = float; // float type for computations
@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	/**
+	 * \brief Calls the provided function with the index of each set bit in the mask, in ascending order.
+	 * \remarks The cost is in the number of set bits (plus a shift per 64 bits), not in the width of the mask.
+	 */
+	inline
+	void ForEachSetBit(const keyboardtypes::DownMask_t& theMask, std::invocable<keyboardtypes::Index_t> auto&& onSetBit)
+	{
+		constexpr std::size_t WordBits{ std::numeric_limits<unsigned long long>::digits };
+		static const keyboardtypes::DownMask_t WordMask{ std::numeric_limits<unsigned long long>::max() };
+		for (std::size_t wordBegin{}; wordBegin < theMask.size(); wordBegin += WordBits)
+		{
+			auto word = ((theMask >> wordBegin) & WordMask).to_ullong();
+			while (word != 0)
+			{
+				const auto bitIndex = std::countr_zero(word);
+				onSetBit(static_cast<keyboardtypes::Index_t>(wordBegin + bitIndex));
+				word &= word - 1;
+			}
+		}
+	}
+
+	/**
+	 * \brief	Min-deadline queue of mapping timer deadlines, used by the translator so that only mappings with a pending repeat or reset transition
+	 *	are checked for an elapsed timer, and only once their deadline has passed. Idle mappings are not in the queue and cost nothing per update.
+	 * \remarks Rescheduling a mapping does not search the queue, the superseded entry is left in place and discarded when it reaches the top.
+	 *	<p>Coalescing slack is the amount of time a deadline may be serviced late, when the earliest deadline's slack runs out every deadline that has
+	 *	passed is serviced in the same update. With zero slack every deadline is serviced on the first update after it passes.</p>
+	 *	<p>The heap storage is reserved at construction and superseded entries are compacted away before it would grow, so scheduling does not allocate.</p>
+	 */
+	class DeadlineQueue final
+	{
+		using TimePoint_t = TimeManagement::TimePoint_t;
+		using Elem_t = std::pair<TimePoint_t, keyboardtypes::Index_t>;
+
+		// Current deadline per mapping index, if any. Heap entries not matching this are superseded.
+		std::vector<std::optional<TimePoint_t>> m_deadlines;
+		// Min-heap (by deadline) of entries, ordered with std::greater.
+		std::vector<Elem_t> m_heap;
+		TimeManagement::Nanos_t m_slack{};
+	public:
+		DeadlineQueue() = default;
+
+		explicit DeadlineQueue(const std::size_t mappingCount)
+			: m_deadlines(mappingCount)
+		{
+			m_heap.reserve(mappingCount * 2);
+		}
+
+	public:
+		/**
+		 * \brief Sets (or replaces) the deadline for the mapping index.
+		 */
+		void Schedule(const keyboardtypes::Index_t index, const TimePoint_t deadline)
+		{
+			if (m_deadlines[index] == deadline)
+				return;
+			m_deadlines[index] = deadline;
+			if (m_heap.size() == m_heap.capacity())
+				CompactSuperseded();
+			m_heap.emplace_back(deadline, index);
+			std::ranges::push_heap(m_heap, std::greater<>{});
+		}
+
+		/**
+		 * \brief Removes the deadline for the mapping index, if any.
+		 */
+		void Cancel(const keyboardtypes::Index_t index) noexcept
+		{
+			m_deadlines[index].reset();
+		}
+
+		/**
+		 * \brief Removes and returns (as a mask) every mapping with a deadline before the time point, if the earliest deadline plus the slack has passed.
+		 */
+		[[nodiscard]]
+		auto PopElapsed(const TimePoint_t timePoint) -> keyboardtypes::DownMask_t
+		{
+			keyboardtypes::DownMask_t elapsedMask;
+			DiscardSuperseded();
+			if (m_heap.empty() || timePoint <= m_heap.front().first + m_slack)
+				return elapsedMask;
+
+			while (!m_heap.empty() && timePoint > m_heap.front().first)
+			{
+				const auto [deadline, index] = m_heap.front();
+				PopTop();
+				if (m_deadlines[index] == deadline)
+				{
+					m_deadlines[index].reset();
+					elapsedMask.set(index);
+				}
+			}
+			return elapsedMask;
+		}
+
+		/**
+		 * \brief Earliest pending deadline, if any.
+		 */
+		[[nodiscard]]
+		auto GetEarliestDeadline() -> std::optional<TimePoint_t>
+		{
+			DiscardSuperseded();
+			if (m_heap.empty())
+				return {};
+			return m_heap.front().first;
+		}
+
+		void SetCoalescingSlack(const TimeManagement::Nanos_t slack) noexcept { m_slack = slack; }
+		[[nodiscard]] auto GetCoalescingSlack() const noexcept -> TimeManagement::Nanos_t { return m_slack; }
+	private:
+		void DiscardSuperseded()
+		{
+			while (!m_heap.empty() && m_deadlines[m_heap.front().second] != m_heap.front().first)
+				PopTop();
+		}
+
+		void PopTop() noexcept
+		{
+			std::ranges::pop_heap(m_heap, std::greater<>{});
+			m_heap.pop_back();
+		}
+
+		// Removes every superseded entry (there is at most one live entry per mapping), and restores the heap order in place.
+		void CompactSuperseded() noexcept
+		{
+			std::erase_if(m_heap, [this](const Elem_t& elem) { return m_deadlines[elem.second] != elem.first; });
+			std::ranges::make_heap(m_heap, std::greater<>{});
+		}
+	};
+
+	static_assert(std::copyable<DeadlineQueue>);
+	static_assert(std::movable<DeadlineQueue>);
+}
@@ -0,0 +1,277 @@
+#pragma once
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardEvdevDecoder.h"
+
+/*
+ * The Linux evdev backend, the only part of the keyboard library that includes the Linux headers. It reads struct input_event records from a file
+ * descriptor, a /dev/input/event* device or any stream of them (a recorded event file, a pipe), and hands them to the portable EvdevStateDecoder.
+ */
+namespace sds
+{
+	static_assert(evdevcodes::EventSyn == EV_SYN && evdevcodes::EventKey == EV_KEY && evdevcodes::EventAbs == EV_ABS
+		&& evdevcodes::SynReport == SYN_REPORT && evdevcodes::SynDropped == SYN_DROPPED,
+		"Portable evdev event types must be the EV_* and SYN_* values.");
+	static_assert(evdevcodes::ButtonA == BTN_A && evdevcodes::ButtonB == BTN_B && evdevcodes::ButtonX == BTN_X && evdevcodes::ButtonY == BTN_Y
+		&& evdevcodes::ButtonLeftShoulder == BTN_TL && evdevcodes::ButtonRightShoulder == BTN_TR
+		&& evdevcodes::ButtonLeftTrigger == BTN_TL2 && evdevcodes::ButtonRightTrigger == BTN_TR2
+		&& evdevcodes::ButtonSelect == BTN_SELECT && evdevcodes::ButtonStart == BTN_START
+		&& evdevcodes::ButtonLeftThumb == BTN_THUMBL && evdevcodes::ButtonRightThumb == BTN_THUMBR
+		&& evdevcodes::ButtonDpadUp == BTN_DPAD_UP && evdevcodes::ButtonDpadDown == BTN_DPAD_DOWN
+		&& evdevcodes::ButtonDpadLeft == BTN_DPAD_LEFT && evdevcodes::ButtonDpadRight == BTN_DPAD_RIGHT
+		&& evdevcodes::ButtonTriggerHappy1 == BTN_TRIGGER_HAPPY1 && evdevcodes::ButtonTriggerHappy2 == BTN_TRIGGER_HAPPY2
+		&& evdevcodes::ButtonTriggerHappy3 == BTN_TRIGGER_HAPPY3 && evdevcodes::ButtonTriggerHappy4 == BTN_TRIGGER_HAPPY4,
+		"Portable evdev key codes must be the BTN_* values.");
+	static_assert(evdevcodes::AxisX == ABS_X && evdevcodes::AxisY == ABS_Y && evdevcodes::AxisZ == ABS_Z && evdevcodes::AxisRx == ABS_RX
+		&& evdevcodes::AxisRy == ABS_RY && evdevcodes::AxisRz == ABS_RZ && evdevcodes::AxisHat0X == ABS_HAT0X && evdevcodes::AxisHat0Y == ABS_HAT0Y,
+		"Portable evdev axis codes must be the ABS_* values.");
+
+	/**
+	 * \brief	Result of an <c>EvdevEventReader::Read</c> call.
+	 */
+	enum class EvdevReadStatus
+	{
+		// Events were read, there may be more.
+		Events,
+		// Nothing to read now.
+		WouldBlock,
+		// End of a file or of a closed pipe's stream.
+		EndOfStream,
+		// A read error, ENODEV when the device was unplugged.
+		Error
+	};
+
+	/**
+	 * \brief	Non-blocking, batched reader of <c>struct input_event</c> records from a file descriptor. Each read() call reads up to
+	 *	<c>BatchSize</c> events at once, an event split across reads (on a pipe) is completed by the next one.
+	 * \remarks The descriptor is not owned, the caller closes it after the reader is destroyed. The ctor sets O_NONBLOCK on it, which applies to the
+	 *	open file description (shared with any other process using it, such as a shell's stdin), and the dtor restores the original flags. Not
+	 *	copyable, a moved-from reader no longer restores them. The device queries (<c>QueryAxisRanges</c>, <c>ReadDeviceState</c>) use the evdev ioctls, they fail on a descriptor
+	 *	that is not an input device and the defaults are kept.
+	 */
+	class EvdevEventReader final
+	{
+	public:
+		// Events per read() call at most.
+		static constexpr std::size_t BatchSize{ 64 };
+	private:
+		std::array<std::byte, BatchSize * sizeof(input_event)> m_readBuffer{};
+		// Bytes of a partial event at the front of the buffer, left from the last read.
+		std::size_t m_partialSize{};
+		int m_fd{ -1 };
+		// File status flags of the descriptor before the ctor set O_NONBLOCK, restored by the dtor.
+		int m_originalFlags{};
+		int m_lastError{};
+	public:
+		EvdevEventReader(const EvdevEventReader&) = delete;
+		auto operator=(const EvdevEventReader&) -> EvdevEventReader& = delete;
+		auto operator=(EvdevEventReader&&) -> EvdevEventReader& = delete;
+
+		/**
+		 * \brief Ctor, sets the descriptor non-blocking. Throws on a descriptor that is not open.
+		 */
+		explicit EvdevEventReader(const int fd)
+			: m_fd(fd), m_originalFlags(fcntl(fd, F_GETFL))
+		{
+			if (m_originalFlags == -1 || fcntl(fd, F_SETFL, m_originalFlags | O_NONBLOCK) == -1)
+				throw std::runtime_error("Exception: evdev event reader file descriptor must be open.");
+		}
+
+		EvdevEventReader(EvdevEventReader&& other) noexcept
+			: m_readBuffer(other.m_readBuffer), m_partialSize(other.m_partialSize), m_fd(std::exchange(other.m_fd, -1)),
+			m_originalFlags(other.m_originalFlags), m_lastError(other.m_lastError)
+		{
+		}
+
+		/**
+		 * \brief Restores the descriptor's original file status flags, as the caller (or another process sharing it) set them.
+		 */
+		~EvdevEventReader()
+		{
+			if (m_fd != -1)
+				std::ignore = fcntl(m_fd, F_SETFL, m_originalFlags);
+		}
+
+		/**
+		 * \brief One read() call, appends the whole events read to the buffer in order.
+		 */
+		auto Read(EvdevEventBuffer_t& events) -> EvdevReadStatus
+		{
+			const auto readSize = read(m_fd, m_readBuffer.data() + m_partialSize, m_readBuffer.size() - m_partialSize);
+			if (readSize < 0)
+			{
+				const int readError = errno;
+				if (readError == EAGAIN || readError == EWOULDBLOCK || readError == EINTR)
+					return EvdevReadStatus::WouldBlock;
+				m_lastError = readError;
+				return EvdevReadStatus::Error;
+			}
+			if (readSize == 0)
+				return EvdevReadStatus::EndOfStream;
+
+			const auto bufferedSize = m_partialSize + static_cast<std::size_t>(readSize);
+			const auto eventCount = bufferedSize / sizeof(input_event);
+			for (std::size_t i{}; i < eventCount; ++i)
+			{
+				input_event rawEvent;
+				std::memcpy(&rawEvent, m_readBuffer.data() + i * sizeof(input_event), sizeof(input_event));
+				events.emplace_back(EvdevEvent{ .Type = rawEvent.type, .Code = rawEvent.code, .Value = rawEvent.value });
+			}
+			m_partialSize = bufferedSize % sizeof(input_event);
+			std::memmove(m_readBuffer.data(), m_readBuffer.data() + eventCount * sizeof(input_event), m_partialSize);
+			return EvdevReadStatus::Events;
+		}
+
+		/**
+		 * \brief Waits until there is something to read (or the stream ended, or errored), true if so before the timeout.
+		 */
+		[[nodiscard]]
+		auto WaitReadable(const std::chrono::milliseconds timeout) const noexcept -> bool
+		{
+			pollfd pollInfo{ .fd = m_fd, .events = POLLIN, .revents = 0 };
+			return poll(&pollInfo, 1, static_cast<int>(timeout.count())) > 0;
+		}
+
+		/**
+		 * \brief The device's stick and trigger ranges (EVIOCGABS), the defaults for an axis it does not have or a descriptor that is not a device.
+		 */
+		[[nodiscard]]
+		auto QueryAxisRanges(const EvdevAxisRanges& defaults = {}) const noexcept -> EvdevAxisRanges
+		{
+			EvdevAxisRanges ranges{ defaults };
+			const auto QueryRange = [this](const std::uint16_t axisCode, EvdevAxisRange& range)
+			{
+				input_absinfo axisInfo{};
+				if (ioctl(m_fd, EVIOCGABS(axisCode), &axisInfo) == 0 && axisInfo.maximum > axisInfo.minimum)
+					range = EvdevAxisRange{ .Minimum = axisInfo.minimum, .Maximum = axisInfo.maximum };
+			};
+			QueryRange(evdevcodes::AxisX, ranges.LeftStickX);
+			QueryRange(evdevcodes::AxisY, ranges.LeftStickY);
+			QueryRange(evdevcodes::AxisRx, ranges.RightStickX);
+			QueryRange(evdevcodes::AxisRy, ranges.RightStickY);
+			QueryRange(evdevcodes::AxisZ, ranges.LeftTrigger);
+			QueryRange(evdevcodes::AxisRz, ranges.RightTrigger);
+			return ranges;
+		}
+
+		/**
+		 * \brief Appends the device's current state as events ending with a SYN_REPORT (EVIOCGKEY, EVIOCGABS), for the decoder's resync after
+		 *	dropped events. False, and nothing appended, for a descriptor that is not a device.
+		 */
+		auto ReadDeviceState(EvdevEventBuffer_t& events) const -> bool
+		{
+			std::array<std::uint8_t, KEY_MAX / 8 + 1> keyBits{};
+			if (ioctl(m_fd, EVIOCGKEY(keyBits.size()), keyBits.data()) < 0)
+				return false;
+			for (const auto keyCode : evdevcodes::KeyCodes)
+			{
+				const bool isDown = (keyBits[keyCode / 8] >> (keyCode % 8)) & 1u;
+				events.emplace_back(EvdevEvent{ .Type = evdevcodes::EventKey, .Code = keyCode, .Value = isDown ? 1 : 0 });
+			}
+			for (const auto axisCode : evdevcodes::AxisCodes)
+			{
+				input_absinfo axisInfo{};
+				if (ioctl(m_fd, EVIOCGABS(axisCode), &axisInfo) == 0)
+					events.emplace_back(EvdevEvent{ .Type = evdevcodes::EventAbs, .Code = axisCode, .Value = axisInfo.value });
+			}
+			events.emplace_back(EvdevEvent{ .Type = evdevcodes::EventSyn, .Code = evdevcodes::SynReport });
+			return true;
+		}
+
+		/**
+		 * \brief The errno of the last failed read().
+		 */
+		[[nodiscard]] auto GetLastError() const noexcept -> int { return m_lastError; }
+		[[nodiscard]] auto GetFileDescriptor() const noexcept -> int { return m_fd; }
+	};
+
+	/**
+	 * \brief	Evdev acquisition backend: reads the pending events of a descriptor, in batches, and decodes them into the controller states to
+	 *	translate, in order. A state is then decoded to down keys as the XInput backend's is (<c>DecodeControllerKeyMask</c>,
+	 *	<c>GetDownVirtualKeycodesRange</c>).
+	 * \remarks The axis ranges are queried from the device at construction. After dropped events the device's state is read back, on a
+	 *	descriptor that is not a device the state catches up with the following events instead.
+	 */
+	class EvdevControllerSource final
+	{
+	public:
+		// Reads per drain at most, the rest are read on the next tick.
+		static constexpr std::size_t MaxReadsPerDrain{ 16 };
+	private:
+		EvdevEventReader m_reader;
+		EvdevStateDecoder m_decoder;
+		EvdevEventBuffer_t m_events;
+		bool m_isConnected{ true };
+	public:
+		/**
+		 * \brief Ctor, throws as <c>EvdevEventReader</c> and <c>EvdevStateDecoder</c> do.
+		 * \param fd The descriptor read, not owned.
+		 * \param defaultRanges The axis ranges used where the device does not report one.
+		 */
+		explicit EvdevControllerSource(const int fd, const EvdevAxisRanges& defaultRanges = {})
+			: m_reader(fd), m_decoder(m_reader.QueryAxisRanges(defaultRanges))
+		{
+			m_events.reserve(EvdevEventReader::BatchSize);
+		}
+
+		/**
+		 * \brief Reads the pending events and appends the states of their reports, in order. Returns false once the stream ended or the device
+		 *	is gone: the state is then reset (every key up) and that released state appended.
+		 */
+		auto DrainStates(ControllerStateBuffer_t& states) -> bool
+		{
+			if (!m_isConnected)
+				return false;
+			for (std::size_t i{}; i < MaxReadsPerDrain; ++i)
+			{
+				m_events.clear();
+				const auto status = m_reader.Read(m_events);
+				m_decoder.Decode(m_events, states);
+				if (m_decoder.TakeResyncRequest())
+				{
+					m_events.clear();
+					if (m_reader.ReadDeviceState(m_events))
+						m_decoder.Decode(m_events, states);
+				}
+				if (status == EvdevReadStatus::WouldBlock)
+					break;
+				if (status == EvdevReadStatus::EndOfStream || status == EvdevReadStatus::Error)
+				{
+					m_isConnected = false;
+					m_decoder.Reset();
+					states.emplace_back(m_decoder.GetState());
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * \brief Waits until events are pending, true if so before the timeout. For a loop that sleeps on the device instead of a fixed tick.
+		 */
+		[[nodiscard]]
+		auto WaitForEvents(const std::chrono::milliseconds timeout) const noexcept -> bool
+		{
+			return m_isConnected && m_reader.WaitReadable(timeout);
+		}
+
+		[[nodiscard]] auto IsConnected() const noexcept -> bool { return m_isConnected; }
+		[[nodiscard]] auto GetState() const noexcept -> const ControllerState& { return m_decoder.GetState(); }
+		[[nodiscard]] auto GetReader() const noexcept -> const EvdevEventReader& { return m_reader; }
+	};
+}
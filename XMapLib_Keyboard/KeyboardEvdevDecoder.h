@@ -0,0 +1,335 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardCustomTypes.h"
+
+namespace sds
+{
+	/**
+	 * \brief	The Linux input event codes the evdev decoder reads, the <c>linux/input-event-codes.h</c> values, so that the decoder builds and is
+	 *	tested without the Linux headers. The evdev backend (<c>KeyboardEvdevBackend.h</c>) checks them against the kernel headers.
+	 * \remarks The button codes are those of the xpad driver (Xbox pads), where BTN_X and BTN_Y share their values with BTN_NORTH and BTN_WEST.
+	 */
+	namespace evdevcodes
+	{
+		// Event types, EV_*.
+		inline constexpr std::uint16_t EventSyn{ 0x00 };
+		inline constexpr std::uint16_t EventKey{ 0x01 };
+		inline constexpr std::uint16_t EventAbs{ 0x03 };
+
+		// EV_SYN codes, SYN_*.
+		inline constexpr std::uint16_t SynReport{ 0 };
+		inline constexpr std::uint16_t SynDropped{ 3 };
+
+		// EV_KEY codes, BTN_*.
+		inline constexpr std::uint16_t ButtonA{ 0x130 };
+		inline constexpr std::uint16_t ButtonB{ 0x131 };
+		inline constexpr std::uint16_t ButtonX{ 0x133 };
+		inline constexpr std::uint16_t ButtonY{ 0x134 };
+		inline constexpr std::uint16_t ButtonLeftShoulder{ 0x136 };
+		inline constexpr std::uint16_t ButtonRightShoulder{ 0x137 };
+		// Digital triggers, BTN_TL2 and BTN_TR2 (xpad with triggers mapped to buttons).
+		inline constexpr std::uint16_t ButtonLeftTrigger{ 0x138 };
+		inline constexpr std::uint16_t ButtonRightTrigger{ 0x139 };
+		inline constexpr std::uint16_t ButtonSelect{ 0x13A };
+		inline constexpr std::uint16_t ButtonStart{ 0x13B };
+		inline constexpr std::uint16_t ButtonLeftThumb{ 0x13D };
+		inline constexpr std::uint16_t ButtonRightThumb{ 0x13E };
+		// D-pad as buttons, BTN_DPAD_*.
+		inline constexpr std::uint16_t ButtonDpadUp{ 0x220 };
+		inline constexpr std::uint16_t ButtonDpadDown{ 0x221 };
+		inline constexpr std::uint16_t ButtonDpadLeft{ 0x222 };
+		inline constexpr std::uint16_t ButtonDpadRight{ 0x223 };
+		// D-pad as buttons on xpad (dpad-to-buttons), BTN_TRIGGER_HAPPY1 to 4: left, right, up, down.
+		inline constexpr std::uint16_t ButtonTriggerHappy1{ 0x2C0 };
+		inline constexpr std::uint16_t ButtonTriggerHappy2{ 0x2C1 };
+		inline constexpr std::uint16_t ButtonTriggerHappy3{ 0x2C2 };
+		inline constexpr std::uint16_t ButtonTriggerHappy4{ 0x2C3 };
+
+		// EV_ABS codes, ABS_*.
+		inline constexpr std::uint16_t AxisX{ 0x00 };
+		inline constexpr std::uint16_t AxisY{ 0x01 };
+		inline constexpr std::uint16_t AxisZ{ 0x02 };
+		inline constexpr std::uint16_t AxisRx{ 0x03 };
+		inline constexpr std::uint16_t AxisRy{ 0x04 };
+		inline constexpr std::uint16_t AxisRz{ 0x05 };
+		inline constexpr std::uint16_t AxisHat0X{ 0x10 };
+		inline constexpr std::uint16_t AxisHat0Y{ 0x11 };
+
+		// The codes the decoder reads, for a backend querying the device's current state.
+		inline constexpr std::array KeyCodes{ ButtonA, ButtonB, ButtonX, ButtonY, ButtonLeftShoulder, ButtonRightShoulder, ButtonLeftTrigger,
+			ButtonRightTrigger, ButtonSelect, ButtonStart, ButtonLeftThumb, ButtonRightThumb, ButtonDpadUp, ButtonDpadDown, ButtonDpadLeft,
+			ButtonDpadRight, ButtonTriggerHappy1, ButtonTriggerHappy2, ButtonTriggerHappy3, ButtonTriggerHappy4 };
+		inline constexpr std::array AxisCodes{ AxisX, AxisY, AxisZ, AxisRx, AxisRy, AxisRz, AxisHat0X, AxisHat0Y };
+	}
+
+	/**
+	 * \brief	One event of an evdev stream, the portable equivalent of <c>struct input_event</c> without its timestamp.
+	 */
+	struct EvdevEvent final
+	{
+		std::uint16_t Type{};
+		std::uint16_t Code{};
+		std::int32_t Value{};
+
+		friend constexpr auto operator==(const EvdevEvent&, const EvdevEvent&) noexcept -> bool = default;
+	};
+
+	// Events read from an evdev stream, in order.
+	using EvdevEventBuffer_t = keyboardtypes::SmallVector_t<EvdevEvent>;
+	// The controller states of the reports decoded, in order.
+	using ControllerStateBuffer_t = keyboardtypes::SmallVector_t<ControllerState>;
+
+	/**
+	 * \brief	Value range of an absolute axis, the <c>input_absinfo</c> minimum and maximum.
+	 */
+	struct EvdevAxisRange final
+	{
+		std::int32_t Minimum{};
+		std::int32_t Maximum{};
+	};
+
+	/**
+	 * \brief	Value ranges of the stick and trigger axes. The defaults are the xpad driver's for an Xbox 360 pad, a backend reading a device queries
+	 *	the actual ranges (an Xbox One pad's triggers go to 1023).
+	 */
+	struct EvdevAxisRanges final
+	{
+		EvdevAxisRange LeftStickX{ -32768, 32767 };
+		EvdevAxisRange LeftStickY{ -32768, 32767 };
+		EvdevAxisRange RightStickX{ -32768, 32767 };
+		EvdevAxisRange RightStickY{ -32768, 32767 };
+		EvdevAxisRange LeftTrigger{ 0, 255 };
+		EvdevAxisRange RightTrigger{ 0, 255 };
+	};
+
+	namespace detail
+	{
+		// The controllercodes button bit of the evdev key code, zero for a code that is not a button.
+		[[nodiscard]]
+		constexpr
+		auto GetEvdevButtonBit(const std::uint16_t keyCode) noexcept -> std::uint16_t
+		{
+			using namespace evdevcodes;
+			const auto ButtonBit = [](const keyboardtypes::VirtualKey_t vk) { return static_cast<std::uint16_t>(vk); };
+			switch (keyCode)
+			{
+			case ButtonA: return ButtonBit(controllercodes::A);
+			case ButtonB: return ButtonBit(controllercodes::B);
+			case ButtonX: return ButtonBit(controllercodes::X);
+			case ButtonY: return ButtonBit(controllercodes::Y);
+			case ButtonLeftShoulder: return ButtonBit(controllercodes::LeftShoulder);
+			case ButtonRightShoulder: return ButtonBit(controllercodes::RightShoulder);
+			case ButtonSelect: return ButtonBit(controllercodes::Back);
+			case ButtonStart: return ButtonBit(controllercodes::Start);
+			case ButtonLeftThumb: return ButtonBit(controllercodes::LeftThumb);
+			case ButtonRightThumb: return ButtonBit(controllercodes::RightThumb);
+			case ButtonDpadUp: case ButtonTriggerHappy3: return ButtonBit(controllercodes::DpadUp);
+			case ButtonDpadDown: case ButtonTriggerHappy4: return ButtonBit(controllercodes::DpadDown);
+			case ButtonDpadLeft: case ButtonTriggerHappy1: return ButtonBit(controllercodes::DpadLeft);
+			case ButtonDpadRight: case ButtonTriggerHappy2: return ButtonBit(controllercodes::DpadRight);
+			default: return 0;
+			}
+		}
+
+		// Scales the axis value to the full thumbstick range, the range's minimum to -32768 and its maximum to 32767.
+		[[nodiscard]]
+		constexpr
+		auto ScaleEvdevStickValue(const std::int32_t value, const EvdevAxisRange range) noexcept -> keyboardtypes::ThumbstickValue_t
+		{
+			const auto offset = static_cast<std::int64_t>(std::clamp(value, range.Minimum, range.Maximum)) - range.Minimum;
+			const auto span = static_cast<std::int64_t>(range.Maximum) - range.Minimum;
+			return static_cast<keyboardtypes::ThumbstickValue_t>(offset * 65535 / span - 32768);
+		}
+
+		// Scales the axis value to the trigger range, the range's minimum to 0 and its maximum to 255.
+		[[nodiscard]]
+		constexpr
+		auto ScaleEvdevTriggerValue(const std::int32_t value, const EvdevAxisRange range) noexcept -> keyboardtypes::TriggerValue_t
+		{
+			const auto offset = static_cast<std::int64_t>(std::clamp(value, range.Minimum, range.Maximum)) - range.Minimum;
+			const auto span = static_cast<std::int64_t>(range.Maximum) - range.Minimum;
+			return static_cast<keyboardtypes::TriggerValue_t>(offset * 255 / span);
+		}
+
+		// Evdev's Y axis is positive down, the ControllerState's positive up. The bitwise not is exact over the full range (xpad applies it too).
+		[[nodiscard]]
+		constexpr
+		auto InvertEvdevStickValue(const keyboardtypes::ThumbstickValue_t value) noexcept -> keyboardtypes::ThumbstickValue_t
+		{
+			return static_cast<keyboardtypes::ThumbstickValue_t>(-1 - value);
+		}
+	}
+
+	/**
+	 * \brief	Decodes an evdev event stream (EV_KEY, EV_ABS, EV_SYN) into the portable <c>ControllerState</c>: the events between two SYN_REPORTs
+	 *	are one state update, reported in order. The states then go through the same decoders as the XInput backend's, so the down keys of a state
+	 *	are those <c>GetDownVirtualKeycodesRange</c> gives, with the settings' stick deadzones and trigger threshold.
+	 * \remarks Axis values are scaled from the device's ranges to the XInput ranges, the Y axes inverted; the device's own flat (deadzone) is not
+	 *	used. A hat axis sets the d-pad bits, a digital trigger button sets its trigger fully pressed or released. Codes not read are ignored.
+	 *	<p>The PacketNumber of a reported state is incremented, as it is only reported when changed. On SYN_DROPPED the events up to the next
+	 *	SYN_REPORT are discarded, as the kernel documents, and a resync of the device's state is requested (<c>TakeResyncRequest</c>).</p>
+	 */
+	class EvdevStateDecoder final
+	{
+		EvdevAxisRanges m_ranges;
+		// The state of the events since the last report.
+		ControllerState m_pending{};
+		// The last reported state.
+		ControllerState m_state{};
+		bool m_isDropping{};
+		bool m_isResyncRequested{};
+	public:
+		/**
+		 * \brief Ctor, throws on an axis range with a maximum not above its minimum.
+		 */
+		explicit EvdevStateDecoder(const EvdevAxisRanges& ranges = {})
+			: m_ranges(ranges)
+		{
+			for (const auto& range : { ranges.LeftStickX, ranges.LeftStickY, ranges.RightStickX, ranges.RightStickY, ranges.LeftTrigger, ranges.RightTrigger })
+			{
+				if (range.Maximum <= range.Minimum)
+					throw std::runtime_error("Exception: evdev axis range maximum must be above its minimum.");
+			}
+		}
+
+		/**
+		 * \brief Decodes the events, the state of each SYN_REPORT that changed it is passed to the callback, in order. A tap shorter than the batch
+		 *	is a state with the key down followed by one with it up, as long as the device reported them separately.
+		 * \param events The events, in the order they were read. A report may span batches.
+		 * \param onReport Called with each changed state.
+		 * \return Number of changed states reported.
+		 */
+		template<std::invocable<const ControllerState&> OnReport_t>
+		auto Decode(const std::span<const EvdevEvent> events, OnReport_t&& onReport) -> std::size_t
+		{
+			std::size_t reportCount{};
+			for (const auto& event : events)
+			{
+				if (event.Type == evdevcodes::EventSyn)
+				{
+					if (event.Code == evdevcodes::SynDropped)
+						m_isDropping = true;
+					else if (event.Code == evdevcodes::SynReport && CommitReport())
+					{
+						onReport(m_state);
+						++reportCount;
+					}
+				}
+				else if (!m_isDropping)
+				{
+					ApplyEvent(event);
+				}
+			}
+			return reportCount;
+		}
+
+		/**
+		 * \brief Decodes the events, appending each changed state to the buffer.
+		 */
+		auto Decode(const std::span<const EvdevEvent> events, ControllerStateBuffer_t& states) -> std::size_t
+		{
+			return Decode(events, [&states](const ControllerState& state) { states.emplace_back(state); });
+		}
+
+		/**
+		 * \brief True once after events were dropped (SYN_DROPPED): the device's current state should be decoded, as events, to catch up.
+		 */
+		[[nodiscard]]
+		auto TakeResyncRequest() noexcept -> bool
+		{
+			const bool isRequested = m_isResyncRequested;
+			m_isResyncRequested = false;
+			return isRequested;
+		}
+
+		/**
+		 * \brief Every key up and the axes centered, for a device no longer connected: the state is reported changed.
+		 */
+		void Reset() noexcept
+		{
+			m_state = ControllerState{ .PacketNumber = m_state.PacketNumber + 1 };
+			m_pending = m_state;
+			m_isDropping = false;
+			m_isResyncRequested = false;
+		}
+
+		[[nodiscard]]
+		auto GetState() const noexcept -> const ControllerState&
+		{
+			return m_state;
+		}
+	private:
+		void ApplyEvent(const EvdevEvent& event) noexcept
+		{
+			if (event.Type == evdevcodes::EventKey)
+			{
+				// Value 2 is an autorepeat, the key is still down.
+				const bool isDown = event.Value != 0;
+				if (event.Code == evdevcodes::ButtonLeftTrigger || event.Code == evdevcodes::ButtonRightTrigger)
+				{
+					auto& trigger = event.Code == evdevcodes::ButtonLeftTrigger ? m_pending.LeftTrigger : m_pending.RightTrigger;
+					trigger = isDown ? keyboardtypes::TriggerValue_t{ 255 } : keyboardtypes::TriggerValue_t{};
+				}
+				else if (const auto buttonBit = detail::GetEvdevButtonBit(event.Code); buttonBit != 0)
+				{
+					SetButtons(buttonBit, isDown ? buttonBit : std::uint16_t{});
+				}
+				return;
+			}
+			if (event.Type != evdevcodes::EventAbs)
+				return;
+			switch (event.Code)
+			{
+			case evdevcodes::AxisX: m_pending.LeftStickX = detail::ScaleEvdevStickValue(event.Value, m_ranges.LeftStickX); break;
+			case evdevcodes::AxisY: m_pending.LeftStickY = detail::InvertEvdevStickValue(detail::ScaleEvdevStickValue(event.Value, m_ranges.LeftStickY)); break;
+			case evdevcodes::AxisRx: m_pending.RightStickX = detail::ScaleEvdevStickValue(event.Value, m_ranges.RightStickX); break;
+			case evdevcodes::AxisRy: m_pending.RightStickY = detail::InvertEvdevStickValue(detail::ScaleEvdevStickValue(event.Value, m_ranges.RightStickY)); break;
+			case evdevcodes::AxisZ: m_pending.LeftTrigger = detail::ScaleEvdevTriggerValue(event.Value, m_ranges.LeftTrigger); break;
+			case evdevcodes::AxisRz: m_pending.RightTrigger = detail::ScaleEvdevTriggerValue(event.Value, m_ranges.RightTrigger); break;
+			case evdevcodes::AxisHat0X:
+				SetButtons(static_cast<std::uint16_t>(controllercodes::DpadLeft | controllercodes::DpadRight),
+					static_cast<std::uint16_t>(event.Value < 0 ? controllercodes::DpadLeft : event.Value > 0 ? controllercodes::DpadRight : 0));
+				break;
+			case evdevcodes::AxisHat0Y:
+				SetButtons(static_cast<std::uint16_t>(controllercodes::DpadUp | controllercodes::DpadDown),
+					static_cast<std::uint16_t>(event.Value < 0 ? controllercodes::DpadUp : event.Value > 0 ? controllercodes::DpadDown : 0));
+				break;
+			default: break;
+			}
+		}
+
+		// Sets the buttons of the mask to those of the down bits.
+		void SetButtons(const std::uint16_t mask, const std::uint16_t downBits) noexcept
+		{
+			m_pending.Buttons = static_cast<std::uint16_t>((m_pending.Buttons & ~mask) | downBits);
+		}
+
+		// Ends the report, true if it changed the state. The report ending a drop is discarded instead.
+		auto CommitReport() noexcept -> bool
+		{
+			if (m_isDropping)
+			{
+				m_isDropping = false;
+				m_isResyncRequested = true;
+				m_pending = m_state;
+				return false;
+			}
+			if (m_pending == m_state)
+				return false;
+			m_pending.PacketNumber = m_state.PacketNumber + 1;
+			m_state = m_pending;
+			return true;
+		}
+	};
+
+	static_assert(std::copyable<EvdevStateDecoder>);
+}
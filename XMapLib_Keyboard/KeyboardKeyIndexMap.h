@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "KeyboardCustomTypes.h"
+#include "ControllerButtonToActionMap.h"
+
+namespace sds
+{
+	/**
+	 * \brief	Assigns each mapping's (sparse) virtual keycode a contiguous index, the position of the mapping in the translator's mapping buffer.
+	 *	The 'down' state of a controller update can then be held in a fixed width bitmask (<c>DownMask_t</c>), and testing whether a mapping is down
+	 *	becomes a single bit test instead of a search of the down key list.
+	 * \remarks Lookups of VK to index are a binary search over a small sorted buffer, performed once per down key per update, not once per mapping.
+	 *	The index map is only valid for the mapping range (and ordering) it was built from.
+	 */
+	class KeyIndexMap final
+	{
+		using Elem_t = std::pair<keyboardtypes::VirtualKey_t, keyboardtypes::Index_t>;
+
+		// Sorted by virtual keycode.
+		keyboardtypes::SmallVector_t<Elem_t> m_vkToIndex;
+		// Index to virtual keycode, in mapping order.
+		keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> m_indexToVk;
+	public:
+		KeyIndexMap() = default;
+
+		/**
+		 * \brief Builds the index map, the dense index for each VK is the position of the mapping in the range.
+		 * \remarks PRECONDITION: There must be only one mapping per virtual keycode, and no more than <c>MaxMappingCount</c> mappings.
+		 */
+		explicit KeyIndexMap(const std::span<const CBActionMap> mappingsList)
+		{
+			m_vkToIndex.reserve(mappingsList.size());
+			m_indexToVk.reserve(mappingsList.size());
+			for (keyboardtypes::Index_t i{}; i < mappingsList.size(); ++i)
+			{
+				m_vkToIndex.emplace_back(mappingsList[i].ButtonVirtualKeycode, i);
+				m_indexToVk.emplace_back(mappingsList[i].ButtonVirtualKeycode);
+			}
+			std::ranges::sort(m_vkToIndex, std::ranges::less{}, &Elem_t::first);
+		}
+
+	public:
+		/**
+		 * \brief Returns the dense index for the virtual keycode, if a mapping for it exists.
+		 */
+		[[nodiscard]]
+		auto GetIndexForVk(const keyboardtypes::VirtualKey_t vk) const noexcept -> std::optional<keyboardtypes::Index_t>
+		{
+			const auto findResult = std::ranges::lower_bound(m_vkToIndex, vk, std::ranges::less{}, &Elem_t::first);
+			if (findResult != std::ranges::cend(m_vkToIndex) && findResult->first == vk)
+				return findResult->second;
+			return {};
+		}
+
+		/**
+		 * \brief Sets the bit for the virtual keycode in the mask, VKs without a mapping are ignored.
+		 */
+		void SetVkInMask(keyboardtypes::DownMask_t& downMask, const keyboardtypes::VirtualKey_t vk) const noexcept
+		{
+			if (const auto index = GetIndexForVk(vk))
+				downMask.set(*index);
+		}
+
+		/**
+		 * \brief Builds the down mask from a range of 'down' virtual keycodes, VKs without a mapping are ignored.
+		 */
+		[[nodiscard]]
+		auto GetDownMask(const std::span<const keyboardtypes::VirtualKey_t> downKeys) const noexcept -> keyboardtypes::DownMask_t
+		{
+			keyboardtypes::DownMask_t downMask;
+			for (const auto vk : downKeys)
+				SetVkInMask(downMask, vk);
+			return downMask;
+		}
+
+		/**
+		 * \brief Builds the range of 'down' virtual keycodes from a down mask, in mapping order.
+		 */
+		[[nodiscard]]
+		auto GetDownVirtualKeys(const keyboardtypes::DownMask_t& downMask) const -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
+		{
+			keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> downKeys;
+			for (keyboardtypes::Index_t i{}; i < m_indexToVk.size(); ++i)
+			{
+				if (downMask[i])
+					downKeys.emplace_back(m_indexToVk[i]);
+			}
+			return downKeys;
+		}
+
+		[[nodiscard]] auto GetVkForIndex(const keyboardtypes::Index_t index) const noexcept -> keyboardtypes::VirtualKey_t { return m_indexToVk[index]; }
+		[[nodiscard]] auto size() const noexcept -> std::size_t { return m_indexToVk.size(); }
+	};
+
+	static_assert(std::copyable<KeyIndexMap>);
+	static_assert(std::movable<KeyIndexMap>);
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardCustomTypes.h"
+#include "KeyboardSettingsPack.h"
+#include "KeyboardStateDecoder.h"
+
+namespace sds
+{
+	// A tick's keystrokes, drained in order.
+	using KeystrokeBuffer_t = keyboardtypes::SmallVector_t<ControllerKeystroke>;
+	// The controller key masks of a tick's updates, in order.
+	using ControllerKeyUpdates_t = keyboardtypes::SmallVector_t<ControllerKeyMask_t>;
+
+	// Concept for a keystroke source, an event queue acquisition backend. DrainKeystrokes appends the queued keystrokes in order, it returns false
+	// when the controller is not connected.
+	template<typename Source_t>
+	concept KeystrokeSource_c = requires(Source_t & t, KeystrokeBuffer_t & keystrokes)
+	{
+		{ t.DrainKeystrokes(keystrokes) } -> std::convertible_to<bool>;
+	};
+
+	namespace detail
+	{
+		inline constexpr std::uint8_t NoKeystrokeBit{ 0xFF };
+
+		// Keystroke code, less the first code (VK_PAD_A), to its controller key bit (as with DecodeControllerKeyMask).
+		inline constexpr auto KeystrokeBits = []()
+		{
+			using namespace controllercodes;
+			std::array<std::uint8_t, 0x40> keystrokeBits{};
+			keystrokeBits.fill(NoKeystrokeBit);
+			const auto SetBit = [&](const keyboardtypes::VirtualKey_t keystrokeVk, const int bit)
+			{
+				keystrokeBits[static_cast<std::size_t>(keystrokeVk - keystroke::A)] = static_cast<std::uint8_t>(bit);
+			};
+			const auto ButtonBit = [](const keyboardtypes::VirtualKey_t vk) { return std::countr_zero(static_cast<std::uint32_t>(vk)); };
+			SetBit(keystroke::A, ButtonBit(A));
+			SetBit(keystroke::B, ButtonBit(B));
+			SetBit(keystroke::X, ButtonBit(X));
+			SetBit(keystroke::Y, ButtonBit(Y));
+			SetBit(keystroke::RightShoulder, ButtonBit(RightShoulder));
+			SetBit(keystroke::LeftShoulder, ButtonBit(LeftShoulder));
+			SetBit(keystroke::LeftTrigger, LeftTriggerBit);
+			SetBit(keystroke::RightTrigger, RightTriggerBit);
+			SetBit(keystroke::DpadUp, ButtonBit(DpadUp));
+			SetBit(keystroke::DpadDown, ButtonBit(DpadDown));
+			SetBit(keystroke::DpadLeft, ButtonBit(DpadLeft));
+			SetBit(keystroke::DpadRight, ButtonBit(DpadRight));
+			SetBit(keystroke::Start, ButtonBit(Start));
+			SetBit(keystroke::Back, ButtonBit(Back));
+			SetBit(keystroke::LeftThumb, ButtonBit(LeftThumb));
+			SetBit(keystroke::RightThumb, ButtonBit(RightThumb));
+			// The stream's direction order: up, down, right, left, up-left, up-right, down-right, down-left.
+			constexpr std::array StreamDirections{ ThumbstickDirection::Up, ThumbstickDirection::Down, ThumbstickDirection::Right, ThumbstickDirection::Left,
+				ThumbstickDirection::LeftUp, ThumbstickDirection::UpRight, ThumbstickDirection::RightDown, ThumbstickDirection::DownLeft };
+			for (std::size_t i{}; i < StreamDirections.size(); ++i)
+			{
+				const auto offset = static_cast<keyboardtypes::VirtualKey_t>(i);
+				SetBit(keystroke::LeftThumbstickFirst + offset, LeftStickFirstBit + static_cast<int>(StreamDirections[i]));
+				SetBit(keystroke::RightThumbstickFirst + offset, RightStickFirstBit + static_cast<int>(StreamDirections[i]));
+			}
+			return keystrokeBits;
+		}();
+
+		// The controller key bit of the keystroke code, NoKeystrokeBit for a code that is not a controller key.
+		[[nodiscard]]
+		constexpr
+		auto GetKeystrokeBit(const keyboardtypes::VirtualKey_t keystrokeVk) noexcept -> std::uint8_t
+		{
+			const auto offset = keystrokeVk - controllercodes::keystroke::A;
+			return offset >= 0 && offset < static_cast<int>(KeystrokeBits.size()) ? KeystrokeBits[static_cast<std::size_t>(offset)] : NoKeystrokeBit;
+		}
+	}
+
+	/**
+	 * \brief	Event queue acquisition: decodes a tick's keystrokes, in their order, into the sequence of controller key masks to translate. A change of
+	 *	a key that already changed in the update starts a new update, so a tap shorter than the tick is a key-down update followed by a key-up update
+	 *	instead of being lost. A key-down after another key-down also starts a new update, the overtaking filter sees the key-downs in arrival order.
+	 * \remarks The masks are those of <c>DecodeControllerKeyMask</c>, use a <c>ControllerKeyIndexTable</c> to get the translator's down masks; every
+	 *	update of a tick is translated with the tick's time point. Repeats, and keystrokes of another player slot, are ignored. The stream applies
+	 *	the OS API's own stick deadzone and trigger threshold, not the settings'.
+	 */
+	class KeystrokeDecoder final
+	{
+		ControllerKeyMask_t m_downKeys{};
+		std::uint8_t m_userIndex{};
+	public:
+		/**
+		 * \brief Ctor, throws on a player slot not below <c>controllercodes::MaxPlayerCount</c>.
+		 */
+		explicit KeystrokeDecoder(const std::size_t playerId = 0)
+			: m_userIndex(static_cast<std::uint8_t>(playerId))
+		{
+			if (playerId >= controllercodes::MaxPlayerCount)
+				throw std::runtime_error("Exception: keystroke decoder player slot must be below MaxPlayerCount.");
+		}
+
+		/**
+		 * \brief Decodes the tick's keystrokes. The update buffer is cleared first, it holds at least one update: with no keystroke, the unchanged
+		 *	mask (the translator is still updated for its repeat/reset deadlines).
+		 * \param keystrokes The tick's keystrokes, in the order they were queued.
+		 * \param updates The controller key masks to translate, in order.
+		 */
+		void Decode(const std::span<const ControllerKeystroke> keystrokes, ControllerKeyUpdates_t& updates)
+		{
+			updates.clear();
+			ControllerKeyMask_t changedKeys{};
+			bool hasKeyDown{};
+			for (const auto& keystroke : keystrokes)
+			{
+				const auto bit = detail::GetKeystrokeBit(keystroke.VirtualKey);
+				if (keystroke.UserIndex != m_userIndex || bit == detail::NoKeystrokeBit || (keystroke.Flags & controllercodes::keystroke::RepeatFlag) != 0)
+					continue;
+				const auto keyBit = ControllerKeyMask_t{ 1 } << bit;
+				const bool isDown = (keystroke.Flags & controllercodes::keystroke::KeyDownFlag) != 0;
+				if (isDown == ((m_downKeys & keyBit) != 0))
+					continue;
+				if ((changedKeys & keyBit) != 0 || (isDown && hasKeyDown))
+				{
+					updates.emplace_back(m_downKeys);
+					changedKeys = {};
+					hasKeyDown = false;
+				}
+				m_downKeys ^= keyBit;
+				changedKeys |= keyBit;
+				hasKeyDown = hasKeyDown || isDown;
+			}
+			updates.emplace_back(m_downKeys);
+		}
+
+		/**
+		 * \brief Every key up, for a controller no longer connected: the next update releases the keys held.
+		 */
+		void Reset() noexcept
+		{
+			m_downKeys = {};
+		}
+
+		[[nodiscard]]
+		auto GetDownKeys() const noexcept -> ControllerKeyMask_t
+		{
+			return m_downKeys;
+		}
+	};
+
+	static_assert(std::copyable<KeystrokeDecoder>);
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "KeyboardCustomTypes.h"
+#include "KeyboardTripleBuffer.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	/**
+	 * \brief	A decoded controller state, as the translator's dense down mask, and when it was acquired.
+	 */
+	struct PolledSample final
+	{
+		keyboardtypes::DownMask_t DownMask;
+		// Time the poll returned the state.
+		TimeManagement::TimePoint_t AcquisitionTime{};
+		// Starts at 1 for the first published sample, 0 means nothing was published yet.
+		std::uint64_t SequenceNumber{};
+	};
+
+	/**
+	 * \brief	Consumer side counters of a <c>LatestValuePoller</c>.
+	 */
+	struct PolledSampleStats final
+	{
+		// New samples taken by the consumer.
+		std::uint64_t ConsumedCount{};
+		// Samples published but overwritten before the consumer took them.
+		std::uint64_t SkippedCount{};
+		// Acquisition to consumption delay, summed over the consumed samples, and the largest.
+		TimeManagement::Nanos_t TotalQueueDelay{};
+		TimeManagement::Nanos_t MaxQueueDelay{};
+	};
+
+	template<typename T>
+	concept DownMaskPoll_c = std::invocable<T&> && std::same_as<std::invoke_result_t<T&>, keyboardtypes::DownMask_t>;
+
+	/**
+	 * \brief	Optional acquisition thread: polls the controller state on its own thread and publishes the newest decoded sample into a wait-free
+	 *	triple buffer, so acquisition latency and translation latency no longer add up in one loop. The translator thread always takes the freshest sample.
+	 * \remarks Poll_t is called on the poller thread only, it returns the down mask (for example, a lambda calling <c>GetWrappedLegacyApiStateUpdate</c>
+	 *	with the translator's <c>KeyIndexMap</c>). The poller sleeps for the poll period between polls, a zero period only yields.
+	 *	<p>The consumer functions must be called from one thread. Not copyable or movable, the thread is joined on destruction.</p>
+	 */
+	template<DownMaskPoll_c Poll_t, TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
+	class LatestValuePoller final
+	{
+		Poll_t m_poll;
+		TimeManagement::Nanos_t m_pollPeriod{};
+		TripleBuffer<PolledSample> m_samples;
+		// Consumer only.
+		PolledSampleStats m_stats;
+		std::uint64_t m_lastSequenceNumber{};
+		// Last member, started after everything it uses is constructed.
+		std::jthread m_pollerThread;
+	public:
+		LatestValuePoller(const LatestValuePoller&) = delete;
+		auto operator=(const LatestValuePoller&) -> LatestValuePoller& = delete;
+
+		/**
+		 * \brief Ctor, starts the poller thread.
+		 * \param poll Callable producing the down mask of a controller state, called on the poller thread.
+		 * \param pollPeriod Delay between polls.
+		 */
+		explicit LatestValuePoller(Poll_t poll, const TimeManagement::Nanos_t pollPeriod = {})
+			: m_poll(std::move(poll)), m_pollPeriod(pollPeriod)
+		{
+			m_pollerThread = std::jthread{ [this](const std::stop_token stopToken) { PollerLoop(stopToken); } };
+		}
+
+		~LatestValuePoller()
+		{
+			Stop();
+		}
+
+		/**
+		 * \brief Consumer only. Takes the newest sample, if one was published since the last call, and updates the queueing delay statistics.
+		 * \return The freshest sample, the same as the last call when nothing newer was published. Sequence number 0 before the first sample.
+		 */
+		auto GetLatest() noexcept -> const PolledSample&
+		{
+			if (m_samples.Consume())
+			{
+				const auto& sample = m_samples.GetReadSlot();
+				const auto queueDelay = ClockPolicy_t::now() - sample.AcquisitionTime;
+				m_stats.SkippedCount += sample.SequenceNumber - m_lastSequenceNumber - 1;
+				++m_stats.ConsumedCount;
+				m_stats.TotalQueueDelay += queueDelay;
+				m_stats.MaxQueueDelay = std::max<TimeManagement::Nanos_t>(m_stats.MaxQueueDelay, queueDelay);
+				m_lastSequenceNumber = sample.SequenceNumber;
+			}
+			return m_samples.GetReadSlot();
+		}
+
+		/**
+		 * \brief Consumer only.
+		 */
+		[[nodiscard]]
+		auto GetStats() const noexcept -> const PolledSampleStats&
+		{
+			return m_stats;
+		}
+
+		/**
+		 * \brief Stops and joins the poller thread, the last published sample may still be taken.
+		 */
+		void Stop() noexcept
+		{
+			if (!m_pollerThread.joinable())
+				return;
+			m_pollerThread.request_stop();
+			m_pollerThread.join();
+		}
+	private:
+		void PollerLoop(const std::stop_token stopToken)
+		{
+			std::uint64_t sequenceNumber{};
+			while (!stopToken.stop_requested())
+			{
+				auto& sample = m_samples.GetWriteSlot();
+				sample.DownMask = m_poll();
+				sample.AcquisitionTime = ClockPolicy_t::now();
+				sample.SequenceNumber = ++sequenceNumber;
+				m_samples.Publish();
+
+				if (m_pollPeriod > TimeManagement::Nanos_t{})
+					std::this_thread::sleep_for(m_pollPeriod);
+				else
+					std::this_thread::yield();
+			}
+		}
+	};
+}
@@ -8,103 +8,166 @@
 #include <Windows.h>
 #include <Xinput.h>
 
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include "KeyboardConnectionMonitor.h"
+#include "KeyboardControllerState.h"
 #include "KeyboardCustomTypes.h"
+#include "KeyboardKeyIndexMap.h"
+#include "KeyboardKeystrokeDecoder.h"
 #include "KeyboardSettingsPack.h"
-#include "KeyboardPolarInfo.h"
-#include "KeyboardStickDirection.h"
+#include "KeyboardStateDecoder.h"
 
+/*
+ * The XInput backend, the only part of the keyboard library that includes the platform headers. It polls the OS API and converts its state
+ * structure to the portable ControllerState the decoders consume.
+ */
 namespace sds
 {
-	// TODO for thumbstick and trigger magnitudes.
-	//struct DownKeyInfo
-	//{
-	//	keyboardtypes::VirtualKey_t VirtualCode;
-	//	int Magnitude;
-	//};
+	static_assert(controllercodes::DpadUp == XINPUT_GAMEPAD_DPAD_UP && controllercodes::DpadDown == XINPUT_GAMEPAD_DPAD_DOWN
+		&& controllercodes::DpadLeft == XINPUT_GAMEPAD_DPAD_LEFT && controllercodes::DpadRight == XINPUT_GAMEPAD_DPAD_RIGHT
+		&& controllercodes::Start == XINPUT_GAMEPAD_START && controllercodes::Back == XINPUT_GAMEPAD_BACK
+		&& controllercodes::LeftThumb == XINPUT_GAMEPAD_LEFT_THUMB && controllercodes::RightThumb == XINPUT_GAMEPAD_RIGHT_THUMB
+		&& controllercodes::LeftShoulder == XINPUT_GAMEPAD_LEFT_SHOULDER && controllercodes::RightShoulder == XINPUT_GAMEPAD_RIGHT_SHOULDER
+		&& controllercodes::A == XINPUT_GAMEPAD_A && controllercodes::B == XINPUT_GAMEPAD_B && controllercodes::X == XINPUT_GAMEPAD_X && controllercodes::Y == XINPUT_GAMEPAD_Y,
+		"Portable button bits must be the XInput wButtons bits.");
+	static_assert(controllercodes::LeftTrigger == VK_GAMEPAD_LEFT_TRIGGER && controllercodes::RightTrigger == VK_GAMEPAD_RIGHT_TRIGGER
+		&& controllercodes::LeftThumbstickUp == VK_GAMEPAD_LEFT_THUMBSTICK_UP && controllercodes::LeftThumbstickDown == VK_GAMEPAD_LEFT_THUMBSTICK_DOWN
+		&& controllercodes::LeftThumbstickRight == VK_GAMEPAD_LEFT_THUMBSTICK_RIGHT && controllercodes::LeftThumbstickLeft == VK_GAMEPAD_LEFT_THUMBSTICK_LEFT
+		&& controllercodes::RightThumbstickUp == VK_GAMEPAD_RIGHT_THUMBSTICK_UP && controllercodes::RightThumbstickDown == VK_GAMEPAD_RIGHT_THUMBSTICK_DOWN
+		&& controllercodes::RightThumbstickRight == VK_GAMEPAD_RIGHT_THUMBSTICK_RIGHT && controllercodes::RightThumbstickLeft == VK_GAMEPAD_RIGHT_THUMBSTICK_LEFT
+		&& controllercodes::LeftThumbstickUpLeft == VK_PAD_LTHUMB_UPLEFT && controllercodes::LeftThumbstickUpRight == VK_PAD_LTHUMB_UPRIGHT
+		&& controllercodes::LeftThumbstickDownRight == VK_PAD_LTHUMB_DOWNRIGHT && controllercodes::LeftThumbstickDownLeft == VK_PAD_LTHUMB_DOWNLEFT
+		&& controllercodes::RightThumbstickUpLeft == VK_PAD_RTHUMB_UPLEFT && controllercodes::RightThumbstickUpRight == VK_PAD_RTHUMB_UPRIGHT
+		&& controllercodes::RightThumbstickDownRight == VK_PAD_RTHUMB_DOWNRIGHT && controllercodes::RightThumbstickDownLeft == VK_PAD_RTHUMB_DOWNLEFT,
+		"Portable trigger and stick VKs must be the gamepad VKs.");
+	static_assert(controllercodes::LeftStickDeadzone == XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE && controllercodes::RightStickDeadzone == XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE
+		&& controllercodes::TriggerThreshold == XINPUT_GAMEPAD_TRIGGER_THRESHOLD && controllercodes::MaxPlayerCount == XUSER_MAX_COUNT);
+	static_assert(controllercodes::keystroke::A == VK_PAD_A && controllercodes::keystroke::B == VK_PAD_B && controllercodes::keystroke::X == VK_PAD_X
+		&& controllercodes::keystroke::Y == VK_PAD_Y && controllercodes::keystroke::RightShoulder == VK_PAD_RSHOULDER
+		&& controllercodes::keystroke::LeftShoulder == VK_PAD_LSHOULDER && controllercodes::keystroke::LeftTrigger == VK_PAD_LTRIGGER
+		&& controllercodes::keystroke::RightTrigger == VK_PAD_RTRIGGER && controllercodes::keystroke::DpadUp == VK_PAD_DPAD_UP
+		&& controllercodes::keystroke::DpadDown == VK_PAD_DPAD_DOWN && controllercodes::keystroke::DpadLeft == VK_PAD_DPAD_LEFT
+		&& controllercodes::keystroke::DpadRight == VK_PAD_DPAD_RIGHT && controllercodes::keystroke::Start == VK_PAD_START
+		&& controllercodes::keystroke::Back == VK_PAD_BACK && controllercodes::keystroke::LeftThumb == VK_PAD_LTHUMB_PRESS
+		&& controllercodes::keystroke::RightThumb == VK_PAD_RTHUMB_PRESS,
+		"Portable keystroke button codes must be the VK_PAD codes.");
+	static_assert(controllercodes::keystroke::LeftThumbstickFirst == VK_PAD_LTHUMB_UP && controllercodes::keystroke::LeftThumbstickFirst + 1 == VK_PAD_LTHUMB_DOWN
+		&& controllercodes::keystroke::LeftThumbstickFirst + 2 == VK_PAD_LTHUMB_RIGHT && controllercodes::keystroke::LeftThumbstickFirst + 3 == VK_PAD_LTHUMB_LEFT
+		&& controllercodes::keystroke::LeftThumbstickFirst + 4 == VK_PAD_LTHUMB_UPLEFT && controllercodes::keystroke::LeftThumbstickFirst + 5 == VK_PAD_LTHUMB_UPRIGHT
+		&& controllercodes::keystroke::LeftThumbstickFirst + 6 == VK_PAD_LTHUMB_DOWNRIGHT && controllercodes::keystroke::LeftThumbstickFirst + 7 == VK_PAD_LTHUMB_DOWNLEFT
+		&& controllercodes::keystroke::RightThumbstickFirst == VK_PAD_RTHUMB_UP && controllercodes::keystroke::RightThumbstickFirst + 7 == VK_PAD_RTHUMB_DOWNLEFT
+		&& controllercodes::keystroke::KeyDownFlag == XINPUT_KEYSTROKE_KEYDOWN && controllercodes::keystroke::KeyUpFlag == XINPUT_KEYSTROKE_KEYUP
+		&& controllercodes::keystroke::RepeatFlag == XINPUT_KEYSTROKE_REPEAT,
+		"Portable keystroke stick codes and flags must be the XINPUT_KEYSTROKE values.");
 
 	/**
-	 * \brief The wButtons member of the OS API struct is ONLY for the buttons, triggers are not set there on a key-down.
+	 * \brief Converts the OS API state structure to the portable state update.
 	 */
-	[[nodiscard]] constexpr bool IsLeftTriggerBeyondThreshold(const keyboardtypes::TriggerValue_t triggerValue, const keyboardtypes::TriggerValue_t triggerThreshold) noexcept
+	[[nodiscard]]
+	constexpr
+	auto GetControllerState(const XINPUT_STATE& apiState) noexcept -> ControllerState
 	{
-		return triggerValue > triggerThreshold;
+		const auto& gamepad = apiState.Gamepad;
+		return ControllerState
+		{
+			.PacketNumber = static_cast<std::uint32_t>(apiState.dwPacketNumber),
+			.Buttons = gamepad.wButtons,
+			.LeftTrigger = gamepad.bLeftTrigger,
+			.RightTrigger = gamepad.bRightTrigger,
+			.LeftStickX = gamepad.sThumbLX,
+			.LeftStickY = gamepad.sThumbLY,
+			.RightStickX = gamepad.sThumbRX,
+			.RightStickY = gamepad.sThumbRY
+		};
 	}
 
-	[[nodiscard]] constexpr bool IsRightTriggerBeyondThreshold(const keyboardtypes::TriggerValue_t triggerValue, const keyboardtypes::TriggerValue_t triggerThreshold) noexcept
+	/**
+	 * \brief Calls the OS API function(s).
+	 * \param playerId Most commonly 0 for a single device connected.
+	 * \return The state update, converted from the platform/API specific state structure.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetLegacyApiStateUpdate(const int playerId = 0) noexcept -> ControllerState
 	{
-		return triggerValue > triggerThreshold;
+		XINPUT_STATE controllerState{};
+		XInputGetState(playerId, &controllerState);
+		return GetControllerState(controllerState);
 	}
 
 	/**
-	 * \brief	Important helper function to build a small vector of button VKs that are 'down'. Essential function
-	 *	is to decompose bit masked state updates into an array.
-	 * \param settingsPack	Settings pertaining to deadzone info and virtual keycodes.
-	 * \param controllerState	The OS API state update.
-	 * \return	small vector of down buttons.
+	 * \brief Converts the OS API keystroke structure to the portable keystroke.
 	 */
 	[[nodiscard]]
-	inline
-	auto GetDownVirtualKeycodesRange(const KeyboardSettings& settingsPack, const XINPUT_STATE& controllerState) -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
+	constexpr
+	auto GetControllerKeystroke(const XINPUT_KEYSTROKE& apiKeystroke) noexcept -> ControllerKeystroke
 	{
-		// Keys
-		keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> allKeys{};
-		for (const auto elem : settingsPack.ButtonCodeArray)
+		return ControllerKeystroke
 		{
-			if (controllerState.Gamepad.wButtons & elem)
-				allKeys.emplace_back(elem);
-		}
-
-		// Triggers
-		if (IsLeftTriggerBeyondThreshold(controllerState.Gamepad.bLeftTrigger, settingsPack.LeftTriggerThreshold))
-			allKeys.emplace_back(settingsPack.LeftTrigger);
-		if (IsRightTriggerBeyondThreshold(controllerState.Gamepad.bRightTrigger, settingsPack.RightTriggerThreshold))
-			allKeys.emplace_back(settingsPack.RightTrigger);
-
-		// Stick axes
-		constexpr auto LeftStickDz{ settingsPack.LeftStickDeadzone };
-		constexpr auto RightStickDz{ settingsPack.RightStickDeadzone };
-
-		const auto leftThumbstickX{ controllerState.Gamepad.sThumbLX };
-		const auto rightThumbstickX{ controllerState.Gamepad.sThumbRX };
-
-		const auto leftThumbstickY{ controllerState.Gamepad.sThumbLY };
-		const auto rightThumbstickY{ controllerState.Gamepad.sThumbRY };
-
-		const auto leftStickPolarInfo{ ComputePolarPair(leftThumbstickX, leftThumbstickY) };
-		const auto rightStickPolarInfo{ ComputePolarPair(rightThumbstickX, rightThumbstickY) };
-
-		const auto leftDirection{ GetDirectionForPolarTheta(leftStickPolarInfo.second) };
-		const auto rightDirection{ GetDirectionForPolarTheta(rightStickPolarInfo.second) };
-
-		const auto leftThumbstickVk{ GetVirtualKeyFromDirection(settingsPack, leftDirection, ControllerStick::LeftStick) };
-		const auto rightThumbstickVk{ GetVirtualKeyFromDirection(settingsPack, rightDirection, ControllerStick::RightStick) };
+			.VirtualKey = static_cast<keyboardtypes::VirtualKey_t>(apiKeystroke.VirtualKey),
+			.Flags = static_cast<std::uint16_t>(apiKeystroke.Flags),
+			.UserIndex = static_cast<std::uint8_t>(apiKeystroke.UserIndex)
+		};
+	}
 
-		// TODO deadzone appears too low on left stick, check this part.
-		const bool leftIsDown = leftStickPolarInfo.first > LeftStickDz && leftThumbstickVk.has_value();
-		const bool rightIsDown = rightStickPolarInfo.first > RightStickDz && rightThumbstickVk.has_value();
+	/**
+	 * \brief	Keystroke source (<c>KeystrokeSource_c</c>) of the OS API: drains the player's <c>XInputGetKeystroke</c> queue, in order.
+	 */
+	struct LegacyApiKeystrokeSource final
+	{
+		// Keystrokes drained per call at most, the rest are drained on the next tick.
+		static constexpr std::size_t MaxKeystrokesPerDrain{ 64 };
 
-		if (leftIsDown)
-			allKeys.emplace_back(leftThumbstickVk.value());
-		if (rightIsDown)
-			allKeys.emplace_back(rightThumbstickVk.value());
+		int PlayerId{};
 
-		return allKeys;
-	}
+		auto DrainKeystrokes(KeystrokeBuffer_t& keystrokes) const -> bool
+		{
+			XINPUT_KEYSTROKE apiKeystroke{};
+			for (std::size_t i{}; i < MaxKeystrokesPerDrain; ++i)
+			{
+				const auto result = XInputGetKeystroke(static_cast<DWORD>(PlayerId), 0, &apiKeystroke);
+				if (result == ERROR_EMPTY)
+					return true;
+				if (result != ERROR_SUCCESS)
+					return false;
+				keystrokes.emplace_back(GetControllerKeystroke(apiKeystroke));
+			}
+			return true;
+		}
+	};
 
 	/**
-	 * \brief Calls the OS API function(s).
+	 * \brief Calls the OS API function, for a slot known to be connected (see <c>ControllerConnectionMonitor</c>).
 	 * \param playerId Most commonly 0 for a single device connected.
-	 * \return Platform/API specific state structure.
+	 * \return The state update, nothing if the controller is not connected.
 	 */
 	[[nodiscard]]
 	inline
-	auto GetLegacyApiStateUpdate(const int playerId = 0) noexcept -> XINPUT_STATE
+	auto TryGetLegacyApiStateUpdate(const int playerId = 0) noexcept -> std::optional<ControllerState>
 	{
 		XINPUT_STATE controllerState{};
-		XInputGetState(playerId, &controllerState);
-		return controllerState;
+		if (XInputGetState(playerId, &controllerState) != ERROR_SUCCESS)
+			return {};
+		return GetControllerState(controllerState);
 	}
 
+	/**
+	 * \brief	Connection probe (<c>ConnectionProbe_c</c>) of the OS API, a single <c>XInputGetState</c> call. Expensive on an empty slot, it is meant
+	 *	to be called by the <c>ControllerConnectionMonitor</c> thread only.
+	 */
+	struct LegacyApiConnectionProbe final
+	{
+		[[nodiscard]]
+		auto IsConnected(const std::size_t playerId) const noexcept -> bool
+		{
+			XINPUT_STATE controllerState{};
+			return XInputGetState(static_cast<DWORD>(playerId), &controllerState) == ERROR_SUCCESS;
+		}
+	};
+
 	/**
 	 * \brief Gets a wrapped controller state update.
 	 * \param settingsPack Settings information, not necessarily constexpr or compile time.
@@ -116,4 +179,59 @@ namespace sds
 	{
 		return GetDownVirtualKeycodesRange(settingsPack.Settings, GetLegacyApiStateUpdate(settingsPack.PlayerInfo.PlayerId));
 	}
+
+	/**
+	 * \brief Gets a controller state update as the translator's dense down mask.
+	 * \param settingsPack Settings information, not necessarily constexpr or compile time.
+	 * \param keyIndices The translator's VK to dense index mapping, see <c>KeyboardTranslator::GetKeyIndexMap()</c>
+	 * \return Bitmask of down mappings.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetWrappedLegacyApiStateUpdate(const KeyboardSettingsPack& settingsPack, const KeyIndexMap& keyIndices) noexcept -> keyboardtypes::DownMask_t
+	{
+		return GetDownVirtualKeycodesMask(settingsPack.Settings, GetLegacyApiStateUpdate(settingsPack.PlayerInfo.PlayerId), keyIndices);
+	}
+
+	/**
+	 * \brief Gets a controller state update as the translator's dense down mask, decoded with <c>DecodeControllerKeyMask</c>.
+	 * \param settingsPack Settings information, not necessarily constexpr or compile time.
+	 * \param keyTable The controller key to mapping index table, built once from the translator's <c>KeyIndexMap</c>.
+	 * \return Bitmask of down mappings.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetWrappedLegacyApiStateUpdate(const KeyboardSettingsPack& settingsPack, const ControllerKeyIndexTable& keyTable) noexcept -> keyboardtypes::DownMask_t
+	{
+		return keyTable.GetDownMask(DecodeControllerKeyMask(settingsPack.Settings, GetLegacyApiStateUpdate(settingsPack.PlayerInfo.PlayerId)));
+	}
+
+	/**
+	 * \brief Gets a controller state update for every player (user slot) as dense down masks, for use with <c>MultiPlayerTranslator</c>.
+	 *	Only the slots the monitor has found connected are polled, the mask of any other slot is empty. A failed poll is reported to the monitor.
+	 * \param settings Settings information, shared by every player.
+	 * \param keyIndices The translator's VK to dense index mapping, see <c>MultiPlayerTranslator::GetKeyIndexMap()</c>
+	 * \param connectionMonitor The monitor of the player slots, probes the empty slots on its own thread.
+	 * \return Bitmask of down mappings, per player.
+	 */
+	template<TimeManagement::IsClockPolicy ClockPolicy_t>
+	[[nodiscard]]
+	auto GetWrappedLegacyApiStateUpdates(const KeyboardSettings& settings, const KeyIndexMap& keyIndices,
+		ControllerConnectionMonitor<LegacyApiConnectionProbe, ClockPolicy_t>& connectionMonitor) noexcept -> std::array<keyboardtypes::DownMask_t, controllercodes::MaxPlayerCount>
+	{
+		std::array<keyboardtypes::DownMask_t, controllercodes::MaxPlayerCount> downMasks{};
+		for (std::size_t playerId{}; playerId < downMasks.size(); ++playerId)
+		{
+			if (!connectionMonitor.IsConnected(playerId))
+				continue;
+			const auto polledState = TryGetLegacyApiStateUpdate(static_cast<int>(playerId));
+			if (!polledState.has_value())
+			{
+				connectionMonitor.ReportDisconnected(playerId);
+				continue;
+			}
+			downMasks[playerId] = GetDownVirtualKeycodesMask(settings, *polledState, keyIndices);
+		}
+		return downMasks;
+	}
 }
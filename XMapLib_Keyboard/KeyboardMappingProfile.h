@@ -0,0 +1,74 @@
+#pragma once
+#include <concepts>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardKeyIndexMap.h"
+#include "KeyboardTranslationHelpers.h"
+
+namespace sds
+{
+	/**
+	 * \brief	An immutable mapping profile: the mappings' virtual keycodes, callbacks, exclusivity groups, repeat flags and delays, plus the
+	 *	VK to dense index mapping. May be shared (as <c>std::shared_ptr<const MappingProfile></c>) by any number of translator instances,
+	 *	each holding only its own mapping state (see <c>MappingStateBlock</c>).
+	 * \remarks The mapping state (<c>LastAction</c>) held in the profile's mappings is the initial state for each instance, it is never advanced.
+	 *	<p>An invariant exists such that: <b>There must be only one mapping per virtual keycode.</b></p>
+	 */
+	class MappingProfile final
+	{
+		using MappingVector_t = std::vector<CBActionMap>;
+		MappingVector_t m_mappings;
+		KeyIndexMap m_keyIndices;
+	public:
+		/**
+		 * \brief Mapping Vector move Ctor, may throw on more than one mapping per VK.
+		 * \param keyMappings Rv ref to a mapping vector type.
+		 * \exception std::runtime_error on more than one mapping per VK, OR more than MaxMappingCount mappings.
+		 */
+		explicit MappingProfile(MappingVector_t&& keyMappings)
+			: m_mappings(std::move(keyMappings))
+		{
+			for (auto& e : m_mappings)
+				InitCustomTimers(e);
+			if (!AreMappingsUniquePerVk(m_mappings) || !AreMappingVksNonZero(m_mappings))
+				throw std::runtime_error("Exception: More than 1 mapping per VK!");
+			if (m_mappings.size() > keyboardtypes::MaxMappingCount)
+				throw std::runtime_error("Exception: More mappings than MaxMappingCount!");
+			m_keyIndices = KeyIndexMap{ m_mappings };
+		}
+
+		[[nodiscard]]
+		auto GetMappings() const noexcept -> std::span<const CBActionMap>
+		{
+			return m_mappings;
+		}
+
+		[[nodiscard]]
+		auto GetMappingAt(const keyboardtypes::Index_t index) const noexcept -> const CBActionMap&
+		{
+			return m_mappings[index];
+		}
+
+		/**
+		 * \brief The VK to dense index mapping of the profile, for pollers producing the down mask directly.
+		 */
+		[[nodiscard]]
+		auto GetKeyIndexMap() const noexcept -> const KeyIndexMap&
+		{
+			return m_keyIndices;
+		}
+
+		[[nodiscard]]
+		auto size() const noexcept -> std::size_t
+		{
+			return m_mappings.size();
+		}
+	};
+
+	static_assert(std::copyable<MappingProfile>);
+	static_assert(std::movable<MappingProfile>);
+}
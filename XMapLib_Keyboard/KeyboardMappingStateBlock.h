@@ -0,0 +1,251 @@
+#pragma once
+#include <concepts>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardDeadlineQueue.h"
+#include "KeyboardKeyIndexMap.h"
+#include "KeyboardMappingProfile.h"
+#include "KeyboardMappingStateStore.h"
+#include "KeyboardTranslationEvents.h"
+#include "KeyboardTranslationHelpers.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	// Concept for a filter class, used to apply a specific "overtaking" behavior (exclusivity grouping behavior) implementation.
+	template<typename FilterType_t>
+	concept ValidFilterType_c = requires(FilterType_t & t)
+	{
+		{ t.SetMappingRange(std::span<CBActionMap>{}) };
+		{ t.GetFilteredButtonState({1,2,3}) } -> std::convertible_to<keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>>;
+		{ std::movable<FilterType_t> == true };
+	};
+
+	// A filter that may also filter the dense down mask directly, used in place of the VK range round trip on the mask update path.
+	template<typename FilterType_t>
+	concept DownMaskFilterType_c = ValidFilterType_c<FilterType_t> && requires(FilterType_t & t)
+	{
+		{ t.GetFilteredDownMask(keyboardtypes::DownMask_t{}) } -> std::convertible_to<keyboardtypes::DownMask_t>;
+	};
+
+	// A filter that reports whether its output for an unchanged input is final, one that does not is never assumed settled.
+	template<typename FilterType_t>
+	concept SettlingFilterType_c = ValidFilterType_c<FilterType_t> && requires(const FilterType_t & t)
+	{
+		{ t.IsSettled() } -> std::convertible_to<bool>;
+	};
+
+	/**
+	 * \brief	The mutable per-instance state for a (shared) <c>MappingProfile</c>: a <c>MappingStateManager</c> per mapping, indexed by the dense
+	 *	mapping index, plus the per-update state store and timer deadline queue. Evaluates updates the same way <c>KeyboardTranslator</c> does.
+	 * \remarks The profile is passed to each member function and must be the profile the block was built from.
+	 *	Mappings that transitioned on an update are re-loaded on the following update (or <c>GetNextDeadline</c>), after the transitions have been
+	 *	performed with <c>Advance</c>.
+	 */
+	class MappingStateBlock final
+	{
+		std::vector<MappingStateManager> m_states;
+		MappingStateStore m_stateStore;
+		DeadlineQueue m_deadlines;
+		// Mappings that transitioned, their state is re-read on the next update.
+		keyboardtypes::DownMask_t m_pendingMask;
+		// The down mask of the last update.
+		keyboardtypes::DownMask_t m_lastDownMask;
+	public:
+		MappingStateBlock() = default;
+
+		explicit MappingStateBlock(const MappingProfile& profile)
+			: m_stateStore(profile.GetMappings()), m_deadlines(profile.size())
+		{
+			m_states.reserve(profile.size());
+			for (const auto& mapping : profile.GetMappings())
+				m_states.emplace_back(mapping.LastAction);
+			for (keyboardtypes::Index_t i{}; i < m_states.size(); ++i)
+				m_pendingMask.set(i);
+		}
+
+		/**
+		 * \brief Determines the transition of each mapping that may transition on the update, the mappings with a transition are marked pending.
+		 * \param profile The profile the block was built from.
+		 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+		 * \param timePoint The time of the update.
+		 */
+		[[nodiscard]]
+		auto GetTransitionMasks(const MappingProfile& profile, const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint) -> TransitionMasks_t
+		{
+			ReconcilePendingMappings(profile);
+			m_lastDownMask = downMask;
+
+			// Mappings with a changed down state, and mappings with a passed deadline.
+			auto candidateMask = GetChangedDownMask(downMask);
+			candidateMask |= m_deadlines.PopElapsed(timePoint);
+
+			TransitionMasks_t transitionMasks{};
+			ForEachSetBit(candidateMask, [&](const keyboardtypes::Index_t i)
+			{
+				if (const auto transition = m_stateStore.GetTransition(i, downMask[i], timePoint))
+				{
+					transitionMasks[static_cast<std::size_t>(*transition)].set(i);
+					m_pendingMask.set(i);
+				}
+			});
+			return transitionMasks;
+		}
+
+		/**
+		 * \brief Fills a caller-owned buffer (cleared first) with a <c>TranslationEvent</c> for each transition of the update, in <c>TransitionOrder</c>.
+		 *	The events are performed (the callback called, then <c>Advance</c>) before the next update.
+		 * \param profile The profile the block was built from.
+		 * \param downMask Bitmask of 'down' mappings, already filtered, indexed by the dense mapping index.
+		 * \param timePoint The time of the update.
+		 * \param translationEvents [out] The event buffer to fill.
+		 */
+		void FillTranslationEvents(const MappingProfile& profile, const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint, TranslationEventBuffer_t& translationEvents)
+		{
+			translationEvents.clear();
+			const auto transitionMasks = GetTransitionMasks(profile, downMask, timePoint);
+			for (const auto transition : TransitionOrder)
+			{
+				ForEachSetBit(transitionMasks[static_cast<std::size_t>(transition)], [&](const keyboardtypes::Index_t i)
+				{
+					const auto& mapping = profile.GetMappingAt(i);
+					translationEvents.emplace_back(TranslationEvent{
+						.MappingVk = mapping.ButtonVirtualKeycode,
+						.MappingIndex = i,
+						.Transition = transition,
+						.ExclusivityGrouping = mapping.ExclusivityGrouping,
+						.TimePoint = timePoint });
+				});
+			}
+		}
+
+		/**
+		 * \brief Advances the state of the mapping index after a transition has been performed.
+		 */
+		void Advance(const keyboardtypes::Index_t index, const TransitionKind transition, const TimeManagement::TimePoint_t timePoint) noexcept
+		{
+			AdvanceMappingState(m_states[index], transition, timePoint);
+			m_pendingMask.set(index);
+		}
+
+		/**
+		 * \brief Marks the mapping index to be re-loaded on the next update, for a transition not produced by <c>GetTransitionMasks</c> (such as cleanup).
+		 */
+		void MarkPending(const keyboardtypes::Index_t index) noexcept
+		{
+			m_pendingMask.set(index);
+		}
+
+		/**
+		 * \brief Mask of the mappings in the key-down or key-repeat state, these would need a key-up as cleanup.
+		 */
+		[[nodiscard]]
+		auto GetCleanupMask() const noexcept -> keyboardtypes::DownMask_t
+		{
+			keyboardtypes::DownMask_t cleanupMask;
+			for (keyboardtypes::Index_t i{}; i < m_states.size(); ++i)
+				cleanupMask[i] = DoesMappingNeedCleanup(m_states[i]);
+			return cleanupMask;
+		}
+
+		/**
+		 * \brief Earliest pending repeat or reset transition (plus the coalescing slack), if any, see <c>KeyboardTranslator::GetNextDeadline()</c>.
+		 */
+		[[nodiscard]]
+		auto GetNextDeadline(const MappingProfile& profile) -> std::optional<TimeManagement::TimePoint_t>
+		{
+			ReconcilePendingMappings(profile);
+			if (const auto earliestDeadline = m_deadlines.GetEarliestDeadline())
+				return *earliestDeadline + m_deadlines.GetCoalescingSlack();
+			return {};
+		}
+
+		/**
+		 * \brief True when an update at the time point with the last update's down mask would determine no transition: no mapping's down state
+		 *	differs from its state (a mapping reset while its key is held goes down on the following update), and no deadline has passed.
+		 */
+		[[nodiscard]]
+		auto IsIdleAt(const MappingProfile& profile, const TimeManagement::TimePoint_t timePoint) -> bool
+		{
+			ReconcilePendingMappings(profile);
+			if (GetChangedDownMask(m_lastDownMask).any())
+				return false;
+			const auto earliestDeadline = m_deadlines.GetEarliestDeadline();
+			return !earliestDeadline.has_value() || timePoint <= *earliestDeadline + m_deadlines.GetCoalescingSlack();
+		}
+
+		[[nodiscard]]
+		auto GetMappingState(const keyboardtypes::Index_t index) const noexcept -> const MappingStateManager&
+		{
+			return m_states[index];
+		}
+
+		/**
+		 * \brief The mapping states, indexed by the dense mapping index. Not re-allocated after construction.
+		 */
+		[[nodiscard]]
+		auto GetMappingStates() noexcept -> std::span<MappingStateManager>
+		{
+			return m_states;
+		}
+
+		void SetTimerCoalescingSlack(const TimeManagement::Nanos_t slack) noexcept
+		{
+			m_deadlines.SetCoalescingSlack(slack);
+		}
+	private:
+		// Mappings that are down and not active (a key-down), or held and not down (a key-up).
+		[[nodiscard]]
+		auto GetChangedDownMask(const keyboardtypes::DownMask_t& downMask) const noexcept -> keyboardtypes::DownMask_t
+		{
+			return (downMask & ~m_stateStore.GetActiveMask()) | (m_stateStore.GetHeldMask() & ~downMask);
+		}
+
+		/**
+		 * \brief Re-reads the state of the mappings that transitioned, and re-schedules their timer deadline.
+		 */
+		void ReconcilePendingMappings(const MappingProfile& profile)
+		{
+			ForEachSetBit(m_pendingMask, [&](const keyboardtypes::Index_t i)
+			{
+				m_stateStore.Load(i, profile.GetMappingAt(i), m_states[i]);
+				if (const auto deadline = m_stateStore.GetDeadline(i))
+					m_deadlines.Schedule(i, *deadline);
+				else
+					m_deadlines.Cancel(i);
+			});
+			m_pendingMask.reset();
+		}
+	};
+
+	/**
+	 * \brief Applies the (optional) overtaking filter to an update's down mask, as <c>KeyboardTranslator</c> and <c>MultiPlayerTranslator</c> do. A filter
+	 *	that filters the down mask does so directly, any other filters the down virtual keycodes.
+	 * \param filter The filter, if any.
+	 * \param keyIndices The VK to dense index mapping of the profile.
+	 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+	 */
+	template<ValidFilterType_c OvertakingFilter_t>
+	[[nodiscard]]
+	auto GetFilteredDownMask(std::optional<OvertakingFilter_t>& filter, const KeyIndexMap& keyIndices, const keyboardtypes::DownMask_t& downMask) -> keyboardtypes::DownMask_t
+	{
+		if constexpr (DownMaskFilterType_c<OvertakingFilter_t>)
+		{
+			if (filter.has_value())
+				return filter->GetFilteredDownMask(downMask);
+		}
+		// The filter operates on the virtual keycodes.
+		else if (filter.has_value())
+		{
+			return keyIndices.GetDownMask(filter->GetFilteredButtonState(keyIndices.GetDownVirtualKeys(downMask)));
+		}
+		return downMask;
+	}
+
+	static_assert(std::copyable<MappingStateBlock>);
+	static_assert(std::movable<MappingStateBlock>);
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardTranslationHelpers.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	/**
+	 * \brief For a single mapping, returns the time point of the next timer driven transition (first repeat, repeat, or reset) if the mapping is in a state
+	 *	that has one. Mappings in the initial state, or in a state with no further repeats, have none.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetTimerDeadlineForMapping(const CBActionMap& singleButton, const MappingStateManager& lastAction) noexcept -> std::optional<TimeManagement::TimePoint_t>
+	{
+		if (lastAction.IsDown() && (singleButton.UsesInfiniteRepeat || singleButton.SendsFirstRepeatOnly))
+			return lastAction.DelayBeforeFirstRepeat.GetExpiryTime();
+		if (lastAction.IsRepeating() && singleButton.UsesInfiniteRepeat)
+			return lastAction.LastSentTime.GetExpiryTime();
+		if (lastAction.IsUp())
+			return lastAction.LastSentTime.GetExpiryTime();
+		return {};
+	}
+
+	[[nodiscard]]
+	inline
+	auto GetTimerDeadlineForMapping(const CBActionMap& singleButton) noexcept -> std::optional<TimeManagement::TimePoint_t>
+	{
+		return GetTimerDeadlineForMapping(singleButton, singleButton.LastAction);
+	}
+
+	/**
+	 * \brief	The per-update ("hot") state of a translator's mappings, in structure-of-arrays layout indexed by the dense mapping index:
+	 *	a state byte, the absolute deadline of the next timer driven transition, and bit planes for the repeat flags and the active/held states.
+	 *	The callbacks, delays and timers ("cold" state) remain in the mapping buffer, which is the authoritative state.
+	 * \remarks The translator evaluates an update against this store alone, touching a few contiguous arrays instead of the mapping structs.
+	 *	A mapping's entry is re-loaded from the mapping (<c>Load</c>) after a transition has been performed on it.
+	 */
+	class MappingStateStore final
+	{
+		using TimePoint_t = TimeManagement::TimePoint_t;
+		static constexpr TimePoint_t NoDeadline{ TimePoint_t::max() };
+
+		// ActionState of each mapping, as a byte.
+		std::vector<std::uint8_t> m_states;
+		// Deadline of the next timer driven transition, or NoDeadline.
+		std::vector<TimePoint_t> m_deadlines;
+		// Mappings that use infinite repeat.
+		keyboardtypes::DownMask_t m_infiniteRepeatMask;
+		// Mappings that send a first repeat (infinite or first only).
+		keyboardtypes::DownMask_t m_firstRepeatMask;
+		// Mappings not in the initial state.
+		keyboardtypes::DownMask_t m_activeMask;
+		// Mappings in the key-down or key-repeat state.
+		keyboardtypes::DownMask_t m_heldMask;
+	public:
+		MappingStateStore() = default;
+
+		/**
+		 * \brief Builds the store for the mapping range, the entries are loaded from the mappings.
+		 * \remarks PRECONDITION: No more than <c>MaxMappingCount</c> mappings.
+		 */
+		explicit MappingStateStore(const std::span<const CBActionMap> mappingsList)
+			: m_states(mappingsList.size()), m_deadlines(mappingsList.size(), NoDeadline)
+		{
+			for (keyboardtypes::Index_t i{}; i < mappingsList.size(); ++i)
+			{
+				m_infiniteRepeatMask[i] = mappingsList[i].UsesInfiniteRepeat;
+				m_firstRepeatMask[i] = mappingsList[i].UsesInfiniteRepeat || mappingsList[i].SendsFirstRepeatOnly;
+				Load(i, mappingsList[i]);
+			}
+		}
+
+		/**
+		 * \brief Re-loads the entry for the mapping index from the mapping's state and timers.
+		 */
+		void Load(const keyboardtypes::Index_t index, const CBActionMap& mapping) noexcept
+		{
+			Load(index, mapping, mapping.LastAction);
+		}
+
+		/**
+		 * \brief Overload for mapping state held apart from the mapping (configuration), see <c>MappingStateBlock</c>.
+		 */
+		void Load(const keyboardtypes::Index_t index, const CBActionMap& mapping, const MappingStateManager& lastAction) noexcept
+		{
+			const auto state = lastAction.IsDown() ? ActionState::KEYDOWN
+				: lastAction.IsRepeating() ? ActionState::KEYREPEAT
+				: lastAction.IsUp() ? ActionState::KEYUP
+				: ActionState::INIT;
+			m_states[index] = static_cast<std::uint8_t>(state);
+			m_deadlines[index] = GetTimerDeadlineForMapping(mapping, lastAction).value_or(NoDeadline);
+			m_activeMask[index] = state != ActionState::INIT;
+			m_heldMask[index] = state == ActionState::KEYDOWN || state == ActionState::KEYREPEAT;
+		}
+
+		/**
+		 * \brief Returns the transition the mapping performs for the update, if any. This is the translator's only state machine:
+		 *	initial to down when the key is down, down or repeat to up when it is not, down to repeat (first repeat) or repeat to repeat (infinite
+		 *	repeat) once the repeat deadline has passed with the key still down, and up to initial (reset) once the reset deadline has passed.
+		 * \param index Dense index of the mapping.
+		 * \param isDown If the mapping's virtual key is 'down' in the update.
+		 * \param timePoint The time of the update.
+		 */
+		[[nodiscard]]
+		auto GetTransition(const keyboardtypes::Index_t index, const bool isDown, const TimePoint_t timePoint) const noexcept -> std::optional<TransitionKind>
+		{
+			const auto state = static_cast<ActionState>(m_states[index]);
+			const bool isDeadlinePassed = timePoint > m_deadlines[index];
+			switch (state)
+			{
+			case ActionState::KEYUP:
+				if (isDeadlinePassed)
+					return TransitionKind::Reset;
+				break;
+			case ActionState::INIT:
+				if (isDown)
+					return TransitionKind::KeyDown;
+				break;
+			case ActionState::KEYDOWN:
+			case ActionState::KEYREPEAT:
+				if (!isDown)
+					return TransitionKind::KeyUp;
+				if (isDeadlinePassed && (state == ActionState::KEYDOWN ? m_firstRepeatMask[index] : m_infiniteRepeatMask[index]))
+					return TransitionKind::KeyRepeat;
+				break;
+			}
+			return {};
+		}
+
+		/**
+		 * \brief Deadline of the next timer driven transition for the mapping index, if any.
+		 */
+		[[nodiscard]]
+		auto GetDeadline(const keyboardtypes::Index_t index) const noexcept -> std::optional<TimePoint_t>
+		{
+			if (m_deadlines[index] == NoDeadline)
+				return {};
+			return m_deadlines[index];
+		}
+
+		[[nodiscard]] auto GetActiveMask() const noexcept -> const keyboardtypes::DownMask_t& { return m_activeMask; }
+		[[nodiscard]] auto GetHeldMask() const noexcept -> const keyboardtypes::DownMask_t& { return m_heldMask; }
+	};
+
+	static_assert(std::copyable<MappingStateStore>);
+	static_assert(std::movable<MappingStateStore>);
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardCustomTypes.h"
+#include "KeyboardMappingProfile.h"
+#include "KeyboardMappingStateBlock.h"
+#include "KeyboardTranslationEvents.h"
+#include "KeyboardTranslator.h"
+
+namespace sds
+{
+	/**
+	 * \brief Translates the controller state updates of every player (XInput user slot) against one shared, immutable <c>MappingProfile</c>,
+	 *	with a <c>MappingStateBlock</c> per player. Output is in event mode, a buffer of <c>TranslationEvent</c> per player.
+	 * \remarks The mapping callbacks are those of the profile, shared by every player; a callback can tell the players apart only by which
+	 *	player's events are being dispatched. If a filter is provided, each player gets a copy of it. Not copyable. Is movable.
+	 *	<p>The clock (<c>ClockPolicy_t::now()</c>) is sampled once per update of all players, or the caller may provide the time point of the update.</p>
+	 */
+	template<ValidFilterType_c OvertakingFilter_t = KeyboardOvertakingFilter, TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
+	class MultiPlayerTranslator final
+	{
+	public:
+		// One per XInput user slot.
+		static constexpr std::size_t PlayerCount{ controllercodes::MaxPlayerCount };
+		using DownMasks_t = std::array<keyboardtypes::DownMask_t, PlayerCount>;
+		using EventBuffers_t = std::array<TranslationEventBuffer_t, PlayerCount>;
+	private:
+		std::shared_ptr<const MappingProfile> m_profile;
+		std::array<MappingStateBlock, PlayerCount> m_players;
+		std::array<std::optional<OvertakingFilter_t>, PlayerCount> m_filters;
+	public:
+		MultiPlayerTranslator() = delete; // no default
+		MultiPlayerTranslator(const MultiPlayerTranslator& other) = delete; // no copy
+		auto operator=(const MultiPlayerTranslator& other) -> MultiPlayerTranslator& = delete; // no copy-assign
+
+		MultiPlayerTranslator(MultiPlayerTranslator&& other) = default; // move-construct
+		auto operator=(MultiPlayerTranslator&& other) -> MultiPlayerTranslator& = default; // move-assign
+		~MultiPlayerTranslator() = default;
+
+		/**
+		 * \brief Shared profile Ctor.
+		 * \param profile The mapping profile, shared with any other translators using it.
+		 * \exception std::runtime_error on null profile.
+		 */
+		explicit MultiPlayerTranslator(std::shared_ptr<const MappingProfile> profile)
+			: m_profile(std::move(profile))
+		{
+			if (!m_profile)
+				throw std::runtime_error("Exception: Null mapping profile!");
+			for (auto& player : m_players)
+				player = MappingStateBlock{ *m_profile };
+		}
+
+		/**
+		 * \brief Constructor used with adding a filter, each player gets a copy of the filter.
+		 * \param profile The mapping profile, shared with any other translators using it.
+		 * \param filter The filter to copy for each player.
+		 * \exception std::runtime_error on null profile.
+		 */
+		MultiPlayerTranslator(std::shared_ptr<const MappingProfile> profile, const OvertakingFilter_t& filter) requires std::copyable<OvertakingFilter_t>
+			: MultiPlayerTranslator(std::move(profile))
+		{
+			for (auto& playerFilter : m_filters)
+			{
+				playerFilter.emplace(filter);
+				playerFilter->SetMappingRange(m_profile->GetMappings());
+			}
+		}
+	public:
+		/**
+		 * \brief Fills a caller-owned buffer (cleared first) per player with a <c>TranslationEvent</c> for each transition of that player's update,
+		 *	all players are evaluated in one pass. The events are performed with <c>DispatchEvents</c>, before the next update.
+		 * \param downMasks Bitmask of 'down' mappings per player, indexed by the dense mapping index of the profile.
+		 * \param translationEvents [out] The event buffer per player to fill.
+		 */
+		void FillUpdatedEvents(const DownMasks_t& downMasks, EventBuffers_t& translationEvents)
+		{
+			FillUpdatedEvents(downMasks, ClockPolicy_t::now(), translationEvents);
+		}
+
+		void FillUpdatedEvents(const DownMasks_t& downMasks, const TimeManagement::TimePoint_t timePoint, EventBuffers_t& translationEvents)
+		{
+			for (std::size_t player{}; player < PlayerCount; ++player)
+				m_players[player].FillTranslationEvents(*m_profile, GetFilteredMask(player, downMasks[player]), timePoint, translationEvents[player]);
+		}
+
+		/**
+		 * \brief Performs the events of a player: calls the profile mapping's callback for the transition, then advances the player's mapping state.
+		 */
+		void DispatchEvents(const std::size_t player, const std::span<const TranslationEvent> translationEvents)
+		{
+			for (const auto& elem : translationEvents)
+			{
+				CallMappingCallback(m_profile->GetMappingAt(elem.MappingIndex), elem.Transition);
+				m_players[player].Advance(elem.MappingIndex, elem.Transition, elem.TimePoint);
+			}
+		}
+
+		/**
+		 * \brief Performs the events of every player, in player order.
+		 */
+		void DispatchEvents(const EventBuffers_t& translationEvents)
+		{
+			for (std::size_t player{}; player < PlayerCount; ++player)
+				DispatchEvents(player, translationEvents[player]);
+		}
+
+		/**
+		 * \brief Fills the buffer per player with key-up events for the mappings in the key-down or key-repeat state, to be dispatched before destruction.
+		 */
+		void FillCleanupEvents(EventBuffers_t& translationEvents) const
+		{
+			const auto timePoint = ClockPolicy_t::now();
+			for (std::size_t player{}; player < PlayerCount; ++player)
+			{
+				translationEvents[player].clear();
+				ForEachSetBit(m_players[player].GetCleanupMask(), [&](const keyboardtypes::Index_t i)
+				{
+					const auto& mapping = m_profile->GetMappingAt(i);
+					translationEvents[player].emplace_back(TranslationEvent{
+						.MappingVk = mapping.ButtonVirtualKeycode,
+						.MappingIndex = i,
+						.Transition = TransitionKind::KeyUp,
+						.ExclusivityGrouping = mapping.ExclusivityGrouping,
+						.TimePoint = timePoint });
+				});
+			}
+		}
+
+		/**
+		 * \brief Earliest pending repeat or reset transition of any player, see <c>KeyboardTranslator::GetNextDeadline()</c>.
+		 */
+		[[nodiscard]]
+		auto GetNextDeadline() -> std::optional<TimeManagement::TimePoint_t>
+		{
+			std::optional<TimeManagement::TimePoint_t> nextDeadline;
+			for (auto& player : m_players)
+			{
+				const auto playerDeadline = player.GetNextDeadline(*m_profile);
+				if (playerDeadline && (!nextDeadline || *playerDeadline < *nextDeadline))
+					nextDeadline = playerDeadline;
+			}
+			return nextDeadline;
+		}
+
+		[[nodiscard]]
+		auto GetMappingState(const std::size_t player, const keyboardtypes::Index_t index) const noexcept -> const MappingStateManager&
+		{
+			return m_players[player].GetMappingState(index);
+		}
+
+		/**
+		 * \brief The VK to dense index mapping of the profile, for pollers producing the down masks directly.
+		 */
+		[[nodiscard]]
+		auto GetKeyIndexMap() const noexcept -> const KeyIndexMap&
+		{
+			return m_profile->GetKeyIndexMap();
+		}
+
+		[[nodiscard]]
+		auto GetProfile() const noexcept -> const std::shared_ptr<const MappingProfile>&
+		{
+			return m_profile;
+		}
+
+		void SetTimerCoalescingSlack(const TimeManagement::Nanos_t slack) noexcept
+		{
+			for (auto& player : m_players)
+				player.SetTimerCoalescingSlack(slack);
+		}
+	private:
+		[[nodiscard]]
+		auto GetFilteredMask(const std::size_t player, const keyboardtypes::DownMask_t& downMask) -> keyboardtypes::DownMask_t
+		{
+			return GetFilteredDownMask(m_filters[player], m_profile->GetKeyIndexMap(), downMask);
+		}
+	};
+
+	static_assert(std::movable<MultiPlayerTranslator<>>);
+	static_assert(std::copyable<MultiPlayerTranslator<>> == false);
+}
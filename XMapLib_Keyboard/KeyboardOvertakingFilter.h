@@ -1,15 +1,21 @@
 #pragma once
+#include <array>
+#include <bit>
+#include <bitset>
 #include <cassert>
+#include <cstdint>
 #include <ranges>
 #include <functional>
 #include <numeric>
 #include <execution>
-#include <deque>
-#include <format>
 #include <source_location>
+#include <stdexcept>
+#include <string>
 #include <stacktrace>
+#include <tuple>
 
 #include "ControllerButtonToActionMap.h"
+#include "KeyboardDeadlineQueue.h"
 #include "KeyboardTranslationHelpers.h"
 
 namespace sds
@@ -34,9 +40,10 @@ namespace sds
 
 		if (!didFindResult)
 		{
+			// Not formatted with <format>, which the portable core cannot require (libstdc++ has it from GCC 13).
 			throw std::runtime_error(
-				std::vformat("Did not find mapping with vk: {} in mappings range.\nLocation:\n{}\n\n",
-					std::make_format_args(vk, std::source_location::current().function_name())));
+				"Did not find mapping with vk: " + std::to_string(vk) + " in mappings range.\nLocation:\n"
+				+ std::source_location::current().function_name() + "\n\n");
 		}
 
 		return static_cast<Index_t>(distance(cbegin(mappingsRange), findResult));
@@ -66,27 +73,83 @@ namespace sds
 	 * <para>Essentially this is used to ensure only a single key per exclusivity grouping is down at a time, and keys can overtake the current down key. </para>
 	 * \remarks This abstraction manages the currently activated key being "overtaken" by another key from the same group and causing a key-up/down to be sent for the currently activated,
 	 *	as well as moving the key in line behind the newly activated key. A much needed abstraction.
+	 *	<p>The activation order is a bounded intrusive doubly linked list over the group's member slots, with a bitset of the queued members. The members are added
+	 *	up front (<c>AddMember</c>, done by the filter's <c>SetMappingRange</c>), after which every member slot operation is constant time and never allocates.
+	 *	The virtual keycode overloads look up the member slot in the group's members, a VK not yet a member is added on its first key-down.</p>
 	 */
 	class GroupActivationInfo final
 	{
 		using Elem_t = keyboardtypes::VirtualKey_t;
 	public:
+		using Slot_t = std::uint8_t;
+		static constexpr Slot_t NoSlot{ 0xFF };
+		static_assert(keyboardtypes::MaxMappingCount < NoSlot);
+
 		// Exclusivity grouping value, mirroring the mapping value used.
 		keyboardtypes::GrpVal_t GroupingValue{};
 	private:
+		struct Link_t final
+		{
+			Slot_t Prev{ NoSlot };
+			Slot_t Next{ NoSlot };
+		};
+		// Member slot to virtual keycode.
+		keyboardtypes::SmallVector_t<Elem_t> m_memberVks;
+		// Member slot to the queue links, valid for queued members.
+		keyboardtypes::SmallVector_t<Link_t> m_links;
+		// Bit N set means member slot N is activated or overtaken (is in the queue).
+		std::bitset<keyboardtypes::MaxMappingCount> m_queuedMembers;
 		// First element of the queue is the activated mapping.
-		std::deque<Elem_t> ActivatedValuesQueue;
+		Slot_t m_front{ NoSlot };
 	public:
+		/**
+		 * \brief Adds the virtual keycode as a member of the group, returns its member slot (the existing slot if already a member).
+		 * \exception std::runtime_error on adding a member to a group already holding <c>MaxMappingCount</c> members.
+		 */
+		auto AddMember(const Elem_t vk) -> Slot_t
+		{
+			if (const auto slot = GetMemberSlot(vk))
+				return *slot;
+			if (m_memberVks.size() >= keyboardtypes::MaxMappingCount)
+				throw std::runtime_error("Exception: More exclusivity group members than MaxMappingCount!");
+			m_memberVks.emplace_back(vk);
+			m_links.emplace_back();
+			return static_cast<Slot_t>(m_memberVks.size() - 1);
+		}
+
 		/**
 		 * \brief Boolean of the returned pair is whether or not the keydown should be filtered/removed.
 		 *	The optional value is (optionally) referring to the mapping to send a new key-up for.
 		 * \remarks An <b>precondition</b> is that the mapping's value passed into this has a matching exclusivity grouping!
+		 * \exception std::runtime_error on a VK not yet a member, when the group already holds <c>MaxMappingCount</c> members.
 		 */
-		[[nodiscard]] auto UpdateForNewMatchingGroupingDown(const Elem_t newDownVk) noexcept -> std::pair<bool, std::optional<Elem_t>>
+		[[nodiscard]] auto UpdateForNewMatchingGroupingDown(const Elem_t newDownVk) -> std::pair<bool, std::optional<Elem_t>>
 		{
+			return UpdateForMemberDown(AddMember(newDownVk));
+		}
+
+		/**
+		 * \brief The optional value is (optionally) referring to the mapping to send a new key-down for,
+		 *	in the event that the currently activated key is key-up'd and there is an overtaken key waiting behind it in the queue.
+		 * \remarks An <b>precondition</b> is that the mapping passed into this has a matching exclusivity grouping!
+		 */
+		auto UpdateForNewMatchingGroupingUp(const Elem_t newUpVk) noexcept -> std::optional<Elem_t>
+		{
+			if (const auto slot = GetMemberSlot(newUpVk))
+				return UpdateForMemberUp(*slot);
+			return {};
+		}
+
+		/**
+		 * \brief Member slot form of <c>UpdateForNewMatchingGroupingDown</c>, constant time. The key-down of a slot that is not a member is filtered.
+		 */
+		[[nodiscard]] auto UpdateForMemberDown(const Slot_t newDownSlot) noexcept -> std::pair<bool, std::optional<Elem_t>>
+		{
+			if (!IsMemberSlot(newDownSlot))
+				return std::make_pair(true, std::optional<Elem_t>{});
 			// Filter all of the hashes already activated/overtaken.
-			const bool isActivated = IsMappingActivated(newDownVk);
-			const bool isOvertaken = IsMappingOvertaken(newDownVk);
+			const bool isActivated = IsMemberActivated(newDownSlot);
+			const bool isOvertaken = IsMemberOvertaken(newDownSlot);
 			const bool doFilterTheDown = isOvertaken;
 			if (isActivated || isOvertaken)
 				return std::make_pair(doFilterTheDown, std::optional<Elem_t>{});
@@ -94,116 +157,296 @@ namespace sds
 			// If any mapping hash is already activated, this new hash will be overtaking it and thus require a key-up for current activated.
 			if (IsAnyMappingActivated())
 			{
-				const auto currentDownValue = ActivatedValuesQueue.front();
-				ActivatedValuesQueue.push_front(newDownVk);
+				const auto currentDownValue = GetActivatedValue();
+				PushFront(newDownSlot);
 				return std::make_pair(false, currentDownValue);
 			}
 
 			// New activated mapping case, add to queue in first position and don't filter. No key-up required.
-			ActivatedValuesQueue.push_front(newDownVk);
+			PushFront(newDownSlot);
 			return std::make_pair(false, std::optional<Elem_t>{});
 		}
 
 		/**
-		 * \brief The optional value is (optionally) referring to the mapping to send a new key-down for,
-		 *	in the event that the currently activated key is key-up'd and there is an overtaken key waiting behind it in the queue.
-		 * \remarks An <b>precondition</b> is that the mapping passed into this has a matching exclusivity grouping!
+		 * \brief Member slot form of <c>UpdateForNewMatchingGroupingUp</c>, constant time.
 		 */
-		auto UpdateForNewMatchingGroupingUp(const Elem_t newUpVk) noexcept -> std::optional<Elem_t>
+		auto UpdateForMemberUp(const Slot_t newUpSlot) noexcept -> std::optional<Elem_t>
 		{
-			// Handle no hashes in queue to update case, and specific new up hash not in queue either.
-			if (!IsAnyMappingActivated())
+			// Handle specific new up hash not in queue.
+			if (!IsMemberActivatedOrOvertaken(newUpSlot))
 				return {};
 
-			const auto findResult = std::ranges::find(ActivatedValuesQueue, newUpVk);
-			const bool isFound = findResult != std::ranges::cend(ActivatedValuesQueue);
-
-			if (isFound)
-			{
-				const bool isInFirstPosition = findResult == ActivatedValuesQueue.cbegin();
-
-				// Case wherein the currently activated mapping is the one getting a key-up.
-				if (isInFirstPosition)
-				{
-					if (ActivatedValuesQueue.size() > 1)
-					{
-						// If there is an overtaken queue, key-down the next key in line.
-						ActivatedValuesQueue.pop_front();
-						// Return the new front hash to be sent a key-down.
-						return ActivatedValuesQueue.front();
-					}
-				}
-
-				// otherwise, just remove it from the queue because it hasn't been key-down'd (it's one of the overtaken, or size is 1).
-				ActivatedValuesQueue.erase(findResult);
-			}
-			
+			// Case wherein the currently activated mapping is the one getting a key-up, with an overtaken queue behind it.
+			const bool isInFirstPosition = newUpSlot == m_front;
+			Unlink(newUpSlot);
+			// Key-down the next key in line, otherwise it was just removed from the queue because it hasn't been key-down'd (it's one of the overtaken, or size is 1).
+			if (isInFirstPosition && IsAnyMappingActivated())
+				return GetActivatedValue();
 			return {};
 		}
 
 	public:
 		[[nodiscard]] bool IsMappingActivated(const Elem_t vk) const noexcept
 		{
-			if (ActivatedValuesQueue.empty())
-				return false;
-			return vk == ActivatedValuesQueue.front();
+			const auto slot = GetMemberSlot(vk);
+			return slot && IsMemberActivated(*slot);
 		}
 		[[nodiscard]] bool IsMappingOvertaken(const Elem_t vk) const noexcept
 		{
-			if (ActivatedValuesQueue.empty())
-				return false;
-
-			const bool isCurrentActivation = ActivatedValuesQueue.front() == vk;
-			const auto findResult = std::ranges::find(ActivatedValuesQueue, vk);
-			const bool isFound = findResult != std::ranges::cend(ActivatedValuesQueue);
-			return !isCurrentActivation && isFound;
+			const auto slot = GetMemberSlot(vk);
+			return slot && IsMemberOvertaken(*slot);
 		}
-		[[nodiscard]] bool IsAnyMappingActivated() const noexcept { return !ActivatedValuesQueue.empty(); }
+		[[nodiscard]] bool IsAnyMappingActivated() const noexcept { return m_front != NoSlot; }
 		[[nodiscard]] bool IsMappingActivatedOrOvertaken(const Elem_t vk) const noexcept
 		{
-			const auto findResult = std::ranges::find(ActivatedValuesQueue, vk);
-			return findResult != std::ranges::cend(ActivatedValuesQueue);
+			const auto slot = GetMemberSlot(vk);
+			return slot && IsMemberActivatedOrOvertaken(*slot);
 		}
 		[[nodiscard]] auto GetActivatedValue() const noexcept -> Elem_t
 		{
-			assert(!ActivatedValuesQueue.empty());
-			return ActivatedValuesQueue.front();
+			assert(IsAnyMappingActivated());
+			return m_memberVks[m_front];
+		}
+
+		[[nodiscard]] bool IsMemberActivated(const Slot_t slot) const noexcept { return slot == m_front; }
+		[[nodiscard]] bool IsMemberOvertaken(const Slot_t slot) const noexcept { return IsMemberActivatedOrOvertaken(slot) && slot != m_front; }
+		[[nodiscard]] bool IsMemberActivatedOrOvertaken(const Slot_t slot) const noexcept { return IsMemberSlot(slot) && m_queuedMembers[slot]; }
+		[[nodiscard]] bool IsMemberSlot(const Slot_t slot) const noexcept { return slot < m_memberVks.size(); }
+		// The activated member slot, or NoSlot.
+		[[nodiscard]] auto GetActivatedSlot() const noexcept -> Slot_t { return m_front; }
+
+		/**
+		 * \brief Removes the queued members that are not in the 'down' member set, keeping the order of the rest. The same as a
+		 *	<c>UpdateForMemberUp</c> for each of them, in any order, ignoring the returned key-down.
+		 */
+		void RemoveQueuedMembersNotIn(const std::bitset<keyboardtypes::MaxMappingCount>& downMembers) noexcept
+		{
+			const auto upMembers = m_queuedMembers & ~downMembers;
+			if (upMembers.none())
+				return;
+			for (Slot_t slot{}; slot < m_memberVks.size(); ++slot)
+			{
+				if (upMembers[slot])
+					Unlink(slot);
+			}
+		}
+
+		/**
+		 * \brief The member slot of the virtual keycode, if a member. Linear in the member count, the filter looks this up once in <c>SetMappingRange</c>.
+		 */
+		[[nodiscard]] auto GetMemberSlot(const Elem_t vk) const noexcept -> std::optional<Slot_t>
+		{
+			const auto findResult = std::ranges::find(m_memberVks, vk);
+			if (findResult == std::ranges::cend(m_memberVks))
+				return {};
+			return static_cast<Slot_t>(std::ranges::distance(std::ranges::cbegin(m_memberVks), findResult));
+		}
+	private:
+		void PushFront(const Slot_t slot) noexcept
+		{
+			m_links[slot] = Link_t{ .Prev = NoSlot, .Next = m_front };
+			if (m_front != NoSlot)
+				m_links[m_front].Prev = slot;
+			m_front = slot;
+			m_queuedMembers.set(slot);
+		}
+
+		void Unlink(const Slot_t slot) noexcept
+		{
+			const auto [prev, next] = m_links[slot];
+			if (prev != NoSlot)
+				m_links[prev].Next = next;
+			else
+				m_front = next;
+			if (next != NoSlot)
+				m_links[next].Prev = prev;
+			m_links[slot] = {};
+			m_queuedMembers.reset(slot);
 		}
 	};
 	static_assert(std::movable<GroupActivationInfo>);
 	static_assert(std::copyable<GroupActivationInfo>);
 
+	/**
+	 * \brief	Flat lookup table of virtual keycode to mapping index and exclusivity group slot, built once for a mapping range.
+	 * \remarks Open addressing with linear probing in a fixed table of twice <c>MaxMappingCount</c> entries, so the load factor is at most one half
+	 *	and a lookup is O(1) and exception-free whatever the VK values. If a VK is mapped more than once, the first mapping is found (as with <c>find</c>).
+	 */
+	class VkMappingTable final
+	{
+	public:
+		static constexpr std::uint8_t NoGroupSlot{ 0xFF };
+		struct Entry_t final
+		{
+			keyboardtypes::VirtualKey_t Vk{};
+			std::uint8_t MappingIndex{};
+			// Dense exclusivity group slot of the mapping, or NoGroupSlot.
+			std::uint8_t GroupSlot{ NoGroupSlot };
+			// Member slot of the mapping in its group's GroupActivationInfo.
+			GroupActivationInfo::Slot_t MemberSlot{ GroupActivationInfo::NoSlot };
+			bool IsOccupied{};
+		};
+	private:
+		static constexpr std::size_t TableSize{ keyboardtypes::MaxMappingCount * 2 };
+		static_assert((TableSize & (TableSize - 1)) == 0);
+		static_assert(keyboardtypes::MaxMappingCount < NoGroupSlot);
+
+		std::array<Entry_t, TableSize> m_entries{};
+		std::size_t m_size{};
+	public:
+		/**
+		 * \brief Adds the VK, if not already present.
+		 * \exception std::runtime_error on adding a VK to a table already holding <c>MaxMappingCount</c> VKs.
+		 */
+		void Insert(const keyboardtypes::VirtualKey_t vk, const std::uint8_t mappingIndex, const std::uint8_t groupSlot, const GroupActivationInfo::Slot_t memberSlot = GroupActivationInfo::NoSlot)
+		{
+			// At most half the entries are occupied, the probe reaches a free one.
+			for (auto position = GetHomePosition(vk); ; position = (position + 1) % TableSize)
+			{
+				auto& entry = m_entries[position];
+				if (entry.IsOccupied && entry.Vk == vk)
+					return;
+				if (!entry.IsOccupied)
+				{
+					if (m_size == keyboardtypes::MaxMappingCount)
+						throw std::runtime_error("Exception: More mappings than MaxMappingCount!");
+					entry = Entry_t{ .Vk = vk, .MappingIndex = mappingIndex, .GroupSlot = groupSlot, .MemberSlot = memberSlot, .IsOccupied = true };
+					++m_size;
+					return;
+				}
+			}
+		}
+
+		/**
+		 * \brief The entry for the VK, or null if there is no mapping for it.
+		 */
+		[[nodiscard]]
+		auto Find(const keyboardtypes::VirtualKey_t vk) const noexcept -> const Entry_t*
+		{
+			for (auto position = GetHomePosition(vk); m_entries[position].IsOccupied; position = (position + 1) % TableSize)
+			{
+				if (m_entries[position].Vk == vk)
+					return &m_entries[position];
+			}
+			return nullptr;
+		}
+	private:
+		// Fibonacci hashing (the high bits of the product), the VK values in use are sparse: single bits, and small ranges far apart.
+		static constexpr auto GetHomePosition(const keyboardtypes::VirtualKey_t vk) noexcept -> std::size_t
+		{
+			constexpr int HashShift{ 32 - std::countr_zero(TableSize) };
+			return static_cast<std::uint32_t>(static_cast<std::uint32_t>(vk) * 2654435769u) >> HashShift;
+		}
+	};
+
+	/**
+	 * \brief	How many overtaking key-downs per exclusivity group the <c>KeyboardOvertakingFilter</c> resolves in one update.
+	 */
+	enum class OvertakingFilterMode : std::uint8_t
+	{
+		// One overtaking key-down per group per update, the others are deferred to the following updates (one change per iteration).
+		OneOvertakePerUpdate,
+		// Every overtaking key-down in the update is resolved, in order, and only the key the group settles on is forwarded: the keys it overtook
+		// within the update are queued without a key-down or key-up, there are no per-step transitions. A key-up of the activated key forwards the
+		// next key in line in the same update.
+		SettledKeyPerUpdate
+	};
+
 	/**
 	 * \brief	May be used to internally filter the poller's translations in order to apply the overtaking behavior.
 	 * \remarks This behavior is deviously complex, and modifications are best done to "GroupActivationInfo" only, if at all possible.
 	 *	In the event that a single state update contains presently un-handled key-downs for mappings with the same exclusivity grouping,
 	 *	it will only process a single overtaking key-down at a time, and will suppress the rest in the state update to be handled on the next iteration.
+	 *	<p><c>SetMappingRange</c> builds flat tables once: VK to mapping index and dense group slot, and group slot to <c>GroupActivationInfo</c>, so
+	 *	each filter step for a down VK is O(1) and exception-free.</p>
+	 *	<p>The filter is a single classifying pass over the down keys: per group, the 'down' queued members are recorded, and the first down key not
+	 *	already queued is the group's overtaking key (later ones wait for a following update). Then each group is resolved once: its target (the
+	 *	overtaking key, else the activated key) is the only member forwarded, queued members that are no longer down are removed, and the overtaking
+	 *	key is activated. The state update is compacted in place, or with <c>GetFilteredDownMask</c> the filter works on the dense down mask alone.</p>
+	 *	<p>With <c>OvertakingFilterMode::SettledKeyPerUpdate</c> (opt-in) every down key not already queued overtakes in turn, in the update's order, and
+	 *	the group's target is its activated key once the queue is updated. Only that settled key is forwarded, the keys it overtook are queued as
+	 *	overtaken and never sent a key-down (nor a key-up): a mapping makes one transition per update, so a key-down and key-up of the same mapping
+	 *	cannot both be in one translation pack. Callers that need each overtake as a transition use the default mode, which reaches the same settled
+	 *	state over the following updates.</p>
 	 */
 	class KeyboardOvertakingFilter final
 	{
-		// Mapping of exclusivity grouping value to 
-		using MapType_t = keyboardtypes::SmallFlatMap_t<keyboardtypes::GrpVal_t, GroupActivationInfo>;
+		using Slot_t = GroupActivationInfo::Slot_t;
+		using MemberMask_t = std::bitset<keyboardtypes::MaxMappingCount>;
+
+		// Per group scratch state of the update being filtered.
+		struct GroupUpdate_t final
+		{
+			// Members that are queued and 'down'.
+			MemberMask_t DownMembers;
+			// First 'down' member that is not queued, it overtakes the activated member. With the settled key mode, the last one.
+			Slot_t OvertakingMember{ GroupActivationInfo::NoSlot };
+			// The one member forwarded for the group.
+			Slot_t TargetMember{ GroupActivationInfo::NoSlot };
+		};
+
+		// Mapping index to group and member slot.
+		struct MappingGroupInfo_t final
+		{
+			std::uint8_t GroupSlot{ VkMappingTable::NoGroupSlot };
+			Slot_t MemberSlot{ GroupActivationInfo::NoSlot };
+		};
+
+		// VK to mapping index and group slot.
+		VkMappingTable m_vkTable;
 
-		// span to mappings
-		std::span<const CBActionMap> m_mappings;
+		// Group slot to GroupActivationInfo, slots are assigned in order of first appearance of the grouping value in the mappings.
+		keyboardtypes::SmallVector_t<GroupActivationInfo> m_groups;
 
-		// map of grouping value to GroupActivationInfo container.
-		MapType_t m_groupMap;
+		// Group slot to the scratch state of the update, sized with the groups.
+		keyboardtypes::SmallVector_t<GroupUpdate_t> m_groupUpdates;
+
+		// Mapping index to group and member slot, and the mask of mapping indices with an exclusivity grouping.
+		keyboardtypes::SmallVector_t<MappingGroupInfo_t> m_mappingGroups;
+		keyboardtypes::DownMask_t m_groupedMask;
+
+		OvertakingFilterMode m_mode{ OvertakingFilterMode::OneOvertakePerUpdate };
+
+		// False when the output of the last update may change with the same input: a down member was left to overtake on a following update, or
+		// a released activated member was replaced by a queued one that is forwarded on a following update.
+		bool m_isSettled{ true };
 	public:
+		KeyboardOvertakingFilter() = default;
+		explicit KeyboardOvertakingFilter(const OvertakingFilterMode mode) noexcept : m_mode(mode) { }
+
+		/**
+		 * \brief Builds the filter's tables for the mapping range, the range of the translator using the filter.
+		 * \exception std::runtime_error on more than MaxMappingCount mappings.
+		 */
 		void SetMappingRange(const std::span<const CBActionMap> mappingsList)
 		{
-			m_mappings = mappingsList;
-			m_groupMap = {};
-
-			// Build the map of ex. group information.
-			for (const auto& elem : mappingsList)
+			if (mappingsList.size() > keyboardtypes::MaxMappingCount)
+				throw std::runtime_error("Exception: More mappings than MaxMappingCount!");
+			m_vkTable = {};
+			m_groups = {};
+			m_mappingGroups = {};
+			m_groupedMask = {};
+
+			// Build the tables of ex. group information.
+			m_mappingGroups.reserve(mappingsList.size());
+			for (keyboardtypes::Index_t i{}; i < mappingsList.size(); ++i)
 			{
+				const auto& elem = mappingsList[i];
+				auto& mappingGroup = m_mappingGroups.emplace_back();
 				if (elem.ExclusivityGrouping)
 				{
 					const auto grpVal = *elem.ExclusivityGrouping;
-					m_groupMap[grpVal].GroupingValue = grpVal;
+					const auto groupResult = std::ranges::find(m_groups, grpVal, &GroupActivationInfo::GroupingValue);
+					mappingGroup.GroupSlot = static_cast<std::uint8_t>(std::ranges::distance(std::ranges::begin(m_groups), groupResult));
+					if (groupResult == std::ranges::end(m_groups))
+						m_groups.emplace_back().GroupingValue = grpVal;
+					// Sizes the group's activation queue, it does not allocate while filtering.
+					mappingGroup.MemberSlot = m_groups[mappingGroup.GroupSlot].AddMember(elem.ButtonVirtualKeycode);
+					m_groupedMask.set(i);
 				}
+				m_vkTable.Insert(elem.ButtonVirtualKeycode, static_cast<std::uint8_t>(i), mappingGroup.GroupSlot, mappingGroup.MemberSlot);
 			}
+			m_groupUpdates.assign(m_groups.size(), GroupUpdate_t{});
 		}
 
 		// This function is used to filter the controller state updates before they are sent to the translator.
@@ -211,137 +454,130 @@ namespace sds
 		[[nodiscard]]
 		auto GetFilteredButtonState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate) -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
 		{
-			using std::ranges::sort;
-
 			// Sorting provides an ordering to which down states with an already handled exclusivity grouping get filtered out for this iteration.
 			//sort(stateUpdate, std::ranges::less{}); // TODO <-- problem for the (current) unit testing, optional anyway
 
-			stateUpdate = FilterStateUpdateForUniqueExclusivityGroups(std::move(stateUpdate));
-
-			auto filteredForDown = FilterDownTranslation(stateUpdate);
-
-			// There appears to be no reason to report additional VKs that will become 'down' after a key is moved to up,
-			// because for the key to still be in the overtaken queue, it would need to still be 'down' as well, and thus handled
-			// by the down filter.
-			FilterUpTranslation(stateUpdate);
+			BeginUpdate();
+			for (const auto vk : stateUpdate)
+			{
+				if (const auto* entry = m_vkTable.Find(vk); entry != nullptr && entry->GroupSlot != VkMappingTable::NoGroupSlot)
+					ClassifyDownMember(entry->GroupSlot, entry->MemberSlot);
+			}
+			ResolveGroups();
 
-			return filteredForDown;
+			// Compacted in place, the VKs without an exclusivity grouping are all forwarded.
+			std::erase_if(stateUpdate, [this](const auto vk)
+			{
+				const auto* entry = m_vkTable.Find(vk);
+				return entry != nullptr && entry->GroupSlot != VkMappingTable::NoGroupSlot && !IsTargetMember(entry->GroupSlot, entry->MemberSlot);
+			});
+			return std::move(stateUpdate);
 		}
 
-	private:
+		/**
+		 * \brief Filters a dense down mask (indexed by mapping index, as with <c>KeyIndexMap</c>), the down keys are processed in mapping index order.
+		 *	The same as <c>GetFilteredButtonState</c> with the down VKs in mapping order, without building the VK range. Does not allocate.
+		 */
 		[[nodiscard]]
-		auto FilterDownTranslation(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& stateUpdate)
+		auto GetFilteredDownMask(const keyboardtypes::DownMask_t& downMask) noexcept -> keyboardtypes::DownMask_t
 		{
-			using std::ranges::find;
-			using std::ranges::cend;
-			using std::ranges::views::transform;
-			using std::ranges::views::filter;
-			using std::erase;
-
-			auto stateUpdateCopy = stateUpdate;
-
-			// filters for all mappings of interest per the current 'down' VK buffer.
-			const auto vkHasMappingPred = [this](const auto vk)
+			const auto groupedDownMask = downMask & m_groupedMask;
+			BeginUpdate();
+			ForEachSetBit(groupedDownMask, [this](const keyboardtypes::Index_t i)
 			{
-				const auto findResult = find(m_mappings, vk, &CBActionMap::ButtonVirtualKeycode);
-				return findResult != cend(m_mappings);
-			};
-			const auto exGroupPred = [this](const auto ind) { return GetMappingAt(ind).ExclusivityGrouping.has_value(); };
-			const auto mappingIndexPred = [this](const auto vk) { return GetMappingIndexForVk(vk, m_mappings); };
-
-			keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> vksToRemoveRange;
+				ClassifyDownMember(m_mappingGroups[i].GroupSlot, m_mappingGroups[i].MemberSlot);
+			});
+			ResolveGroups();
 
-			for(const auto index : stateUpdateCopy | filter(vkHasMappingPred) | transform(mappingIndexPred) | filter(exGroupPred))
+			auto filteredMask = downMask;
+			ForEachSetBit(groupedDownMask, [&](const keyboardtypes::Index_t i)
 			{
-				const auto& currentMapping = GetMappingAt(index);
-				auto& currentGroup = m_groupMap[*currentMapping.ExclusivityGrouping];
-
-				const auto& [shouldFilter, upOpt] = currentGroup.UpdateForNewMatchingGroupingDown(currentMapping.ButtonVirtualKeycode);
-				if(shouldFilter)
-				{
-					vksToRemoveRange.emplace_back(currentMapping.ButtonVirtualKeycode);
-				}
-				if(upOpt)
-				{
-					vksToRemoveRange.emplace_back(*upOpt);
-				}
-			}
-
-			EraseValuesFromRange(stateUpdateCopy, vksToRemoveRange);
-
-			return stateUpdateCopy;
+				if (!IsTargetMember(m_mappingGroups[i].GroupSlot, m_mappingGroups[i].MemberSlot))
+					filteredMask.reset(i);
+			});
+			return filteredMask;
 		}
 
-		// it will process only one key per ex. group per iteration. The others will be filtered out and handled on the next iteration.
+		/**
+		 * \brief True when filtering the same input again gives the same output: the last update did not leave a down member to overtake, nor a
+		 *	newly activated member to forward, on a following update. Always true with <c>OvertakingFilterMode::SettledKeyPerUpdate</c>, it settles in one update.
+		 */
 		[[nodiscard]]
-		auto FilterUpTranslation(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& stateUpdate)
+		auto IsSettled() const noexcept -> bool
 		{
-			using std::ranges::views::filter;
-
-			// filters for all mappings of interest per the current 'down' VK buffer (the UP mappings in this case).
-			const auto exGroupPred = [](const CBActionMap& currentMapping) { return currentMapping.ExclusivityGrouping.has_value(); };
-			const auto stateUpdateUpPred = [&stateUpdate](const CBActionMap& currentMapping) { return !IsMappingInRange(currentMapping, stateUpdate); };
-
-			for (const auto& currentMapping : m_mappings | filter(exGroupPred) | filter(stateUpdateUpPred))
-			{
-				auto& currentGroup = m_groupMap[*currentMapping.ExclusivityGrouping];
-				currentGroup.UpdateForNewMatchingGroupingUp(currentMapping.ButtonVirtualKeycode);
-			}
+			return m_isSettled;
 		}
 
 	private:
-		[[nodiscard]]
-		constexpr
-		auto GetMappingAt(const std::size_t index) noexcept -> const CBActionMap&
+		void BeginUpdate() noexcept
 		{
-			return m_mappings[index];
+			for (auto& groupUpdate : m_groupUpdates)
+				groupUpdate = GroupUpdate_t{};
+			m_isSettled = true;
 		}
 
 		/**
-		 * \brief Used to remove VKs with an exclusivity grouping that another state update VK already has. Processed from begin to end, so the first processed VK will be the left-most and
-		 *	duplicates to the right will be removed.
-		 * \remarks This is essential because processing more than one exclusivity grouping having mapping in a single iteration of a filter will mean the first ex. group vks were not actually processed
-		 *	by the translator, yet their state would be updated by the filter incorrectly. Also, VKs in the state update must be unique! One VK per mapping is a hard precondition.
-		 * \return "filtered" state update.
+		 * \brief Records a 'down' member. A member not already activated or overtaken overtakes the activated member, only one per group per update,
+		 *	the others are not forwarded (nor recorded as down) and will be handled on a following iteration.
 		 */
-		[[nodiscard]]
-		auto FilterStateUpdateForUniqueExclusivityGroups(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate) -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
+		void ClassifyDownMember(const std::uint8_t groupSlot, const Slot_t memberSlot) noexcept
 		{
-			using std::ranges::find, std::ranges::cend;
-			using StateRange_t = std::remove_cvref_t<decltype(stateUpdate)>;
-
-			keyboardtypes::SmallVector_t<keyboardtypes::GrpVal_t> groupingValueBuffer;
-			StateRange_t virtualKeycodesToRemove;
-			groupingValueBuffer.reserve(stateUpdate.size());
-			virtualKeycodesToRemove.reserve(stateUpdate.size());
-			
-			for (const auto vk : stateUpdate)
+			auto& group = m_groups[groupSlot];
+			auto& groupUpdate = m_groupUpdates[groupSlot];
+			if (group.IsMemberActivatedOrOvertaken(memberSlot))
+			{
+				groupUpdate.DownMembers.set(memberSlot);
+			}
+			else if (m_mode == OvertakingFilterMode::SettledKeyPerUpdate)
+			{
+				// Overtakes now, the members classified after it see it as queued.
+				std::ignore = group.UpdateForMemberDown(memberSlot);
+				groupUpdate.DownMembers.set(memberSlot);
+				groupUpdate.OvertakingMember = memberSlot;
+			}
+			else if (groupUpdate.OvertakingMember == GroupActivationInfo::NoSlot)
+			{
+				groupUpdate.OvertakingMember = memberSlot;
+			}
+			else
+			{
+				m_isSettled = false;
+			}
+		}
+
+		/**
+		 * \brief Determines each group's target member, then updates the activation queue: members no longer down are removed, the overtaking
+		 *	member is activated (the previously activated member is moved in line behind it).
+		 */
+		void ResolveGroups() noexcept
+		{
+			for (std::size_t groupSlot{}; groupSlot < m_groups.size(); ++groupSlot)
 			{
-				const auto foundMappingForVk = find(m_mappings, vk, &CBActionMap::ButtonVirtualKeycode);
-				if (foundMappingForVk != cend(m_mappings))
+				auto& group = m_groups[groupSlot];
+				auto& groupUpdate = m_groupUpdates[groupSlot];
+				// The chain is already in the queue, the target is the activated member once the released members are removed.
+				if (m_mode == OvertakingFilterMode::SettledKeyPerUpdate)
 				{
-					if (foundMappingForVk->ExclusivityGrouping)
-					{
-						const auto grpVal = *foundMappingForVk->ExclusivityGrouping;
-						auto& currentGroup = m_groupMap[grpVal];
-						if (!currentGroup.IsMappingActivatedOrOvertaken(vk))
-						{
-							const auto groupingFindResult = find(groupingValueBuffer, grpVal);
-
-							// If already in located, being handled groupings, add to remove buffer.
-							if (groupingFindResult != cend(groupingValueBuffer))
-								virtualKeycodesToRemove.emplace_back(vk);
-							// Otherwise, add this new grouping to the grouping value buffer.
-							else
-								groupingValueBuffer.emplace_back(grpVal);
-						}
-					}
+					group.RemoveQueuedMembersNotIn(groupUpdate.DownMembers);
+					groupUpdate.TargetMember = group.GetActivatedSlot();
+					continue;
 				}
+				const bool isOvertaking = groupUpdate.OvertakingMember != GroupActivationInfo::NoSlot;
+				groupUpdate.TargetMember = isOvertaking ? groupUpdate.OvertakingMember : group.GetActivatedSlot();
+
+				group.RemoveQueuedMembersNotIn(groupUpdate.DownMembers);
+				if (isOvertaking)
+					std::ignore = group.UpdateForMemberDown(groupUpdate.OvertakingMember);
+				// The activated member was released, the queued member now activated is forwarded on the next update.
+				if (const auto activatedSlot = group.GetActivatedSlot(); activatedSlot != GroupActivationInfo::NoSlot && activatedSlot != groupUpdate.TargetMember)
+					m_isSettled = false;
 			}
+		}
 
-			EraseValuesFromRange(stateUpdate, virtualKeycodesToRemove);
-
-			return stateUpdate;
+		[[nodiscard]]
+		auto IsTargetMember(const std::uint8_t groupSlot, const Slot_t memberSlot) const noexcept -> bool
+		{
+			return m_groupUpdates[groupSlot].TargetMember == memberSlot;
 		}
 	};
 	static_assert(std::copyable<KeyboardOvertakingFilter>);
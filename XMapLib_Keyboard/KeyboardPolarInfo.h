@@ -1,5 +1,6 @@
 #pragma once
 #include <cassert>
+#include <cmath>
 #include <functional>
 #include <algorithm>
 #include <numeric>
@@ -0,0 +1,189 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardCustomTypes.h"
+#include "KeyboardDeadlineQueue.h"
+#include "KeyboardOvertakingFilter.h"
+
+namespace sds
+{
+	/**
+	 * \brief	Priority-ordered overtaking filter: of the keys held down in an exclusivity group, only the one with the highest
+	 *	<c>CBActionMap::ExclusivityPriority</c> is forwarded to the translator, whatever the press order. Equal priorities are ordered by mapping order,
+	 *	the earlier mapping wins.
+	 * \remarks A drop-in alternative to the last-pressed-wins <c>KeyboardOvertakingFilter</c>, selected with the translator's filter type parameter.
+	 *	When a higher priority key is pressed, the activated key is filtered out (the translator sends its key-up) and the new key is forwarded. When the
+	 *	activated key is released, the highest priority key still held is forwarded in the same update.
+	 *	<p><c>SetMappingRange</c> ranks the grouped mappings once, by descending priority, and the rank of a mapping is a bit position in a per group rank
+	 *	mask (the highest priority is the highest bit). Each update sets the rank bits of the held keys, and a group's activated key is found with a count
+	 *	leading zeros of the mask, so a key-down or key-up is O(1) whatever the number of held keys. Nothing is carried between updates but the tables,
+	 *	and filtering does not allocate.</p>
+	 */
+	class KeyboardPriorityOvertakingFilter final
+	{
+		using Word_t = std::uint64_t;
+		static constexpr std::size_t WordBits{ std::numeric_limits<Word_t>::digits };
+		static constexpr std::size_t WordCount{ (keyboardtypes::MaxMappingCount + WordBits - 1) / WordBits };
+		static constexpr std::uint8_t NoRank{ 0xFF };
+		static constexpr std::uint8_t NoMapping{ 0xFF };
+		static_assert(keyboardtypes::MaxMappingCount < NoRank);
+
+		// Bit N set means the mapping of rank N is held, the highest priority rank is the highest bit.
+		using RankMask_t = std::array<Word_t, WordCount>;
+
+		// Mapping index to group slot and rank.
+		struct MappingRank_t final
+		{
+			std::uint8_t GroupSlot{ VkMappingTable::NoGroupSlot };
+			std::uint8_t Rank{ NoRank };
+		};
+
+		// VK to mapping index and group slot.
+		VkMappingTable m_vkTable;
+
+		// Mapping index to group slot and rank, and rank to mapping index.
+		keyboardtypes::SmallVector_t<MappingRank_t> m_mappingRanks;
+		std::array<std::uint8_t, keyboardtypes::MaxMappingCount> m_rankMappings{};
+		keyboardtypes::DownMask_t m_groupedMask;
+
+		// Group slot to the held ranks of the update being filtered, and the mapping index forwarded for the group.
+		keyboardtypes::SmallVector_t<RankMask_t> m_heldRanks;
+		keyboardtypes::SmallVector_t<std::uint8_t> m_targetMappings;
+	public:
+		/**
+		 * \brief Builds the filter's tables for the mapping range, the range of the translator using the filter.
+		 * \exception std::runtime_error on more than MaxMappingCount mappings.
+		 */
+		void SetMappingRange(const std::span<const CBActionMap> mappingsList)
+		{
+			if (mappingsList.size() > keyboardtypes::MaxMappingCount)
+				throw std::runtime_error("Exception: More mappings than MaxMappingCount!");
+			m_vkTable = {};
+			m_mappingRanks = {};
+			m_rankMappings = {};
+			m_groupedMask = {};
+
+			// Group slots are assigned in order of first appearance of the grouping value in the mappings.
+			keyboardtypes::SmallVector_t<keyboardtypes::GrpVal_t> groupValues;
+			keyboardtypes::SmallVector_t<std::uint8_t> rankedMappings;
+			m_mappingRanks.reserve(mappingsList.size());
+			for (keyboardtypes::Index_t i{}; i < mappingsList.size(); ++i)
+			{
+				const auto& elem = mappingsList[i];
+				auto& mappingRank = m_mappingRanks.emplace_back();
+				if (elem.ExclusivityGrouping)
+				{
+					const auto groupResult = std::ranges::find(groupValues, *elem.ExclusivityGrouping);
+					mappingRank.GroupSlot = static_cast<std::uint8_t>(std::ranges::distance(std::ranges::begin(groupValues), groupResult));
+					if (groupResult == std::ranges::end(groupValues))
+						groupValues.emplace_back(*elem.ExclusivityGrouping);
+					rankedMappings.emplace_back(static_cast<std::uint8_t>(i));
+					m_groupedMask.set(i);
+				}
+				m_vkTable.Insert(elem.ButtonVirtualKeycode, static_cast<std::uint8_t>(i), mappingRank.GroupSlot);
+			}
+
+			// Rank 0 is the lowest priority, ties are ranked so the earlier mapping is higher.
+			std::ranges::sort(rankedMappings, [&mappingsList](const auto lhs, const auto rhs)
+			{
+				const auto lhsPriority = mappingsList[lhs].ExclusivityPriority;
+				const auto rhsPriority = mappingsList[rhs].ExclusivityPriority;
+				return lhsPriority != rhsPriority ? lhsPriority < rhsPriority : lhs > rhs;
+			});
+			for (std::size_t rank{}; rank < rankedMappings.size(); ++rank)
+			{
+				m_mappingRanks[rankedMappings[rank]].Rank = static_cast<std::uint8_t>(rank);
+				m_rankMappings[rank] = rankedMappings[rank];
+			}
+			m_heldRanks.assign(groupValues.size(), RankMask_t{});
+			m_targetMappings.assign(groupValues.size(), NoMapping);
+		}
+
+		// Filters the controller state update, the grouped VKs that are not the highest priority held key of their group are removed.
+		[[nodiscard]]
+		auto GetFilteredButtonState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate) -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
+		{
+			BeginUpdate();
+			for (const auto vk : stateUpdate)
+			{
+				if (const auto* entry = m_vkTable.Find(vk); entry != nullptr && entry->GroupSlot != VkMappingTable::NoGroupSlot)
+					SetHeld(entry->MappingIndex);
+			}
+			ResolveGroups();
+
+			std::erase_if(stateUpdate, [this](const auto vk)
+			{
+				const auto* entry = m_vkTable.Find(vk);
+				return entry != nullptr && entry->GroupSlot != VkMappingTable::NoGroupSlot && m_targetMappings[entry->GroupSlot] != entry->MappingIndex;
+			});
+			return std::move(stateUpdate);
+		}
+
+		/**
+		 * \brief Filters a dense down mask (indexed by mapping index, as with <c>KeyIndexMap</c>). Does not allocate.
+		 */
+		[[nodiscard]]
+		auto GetFilteredDownMask(const keyboardtypes::DownMask_t& downMask) noexcept -> keyboardtypes::DownMask_t
+		{
+			BeginUpdate();
+			ForEachSetBit(downMask & m_groupedMask, [this](const keyboardtypes::Index_t i) { SetHeld(i); });
+			ResolveGroups();
+
+			auto filteredMask = downMask & ~m_groupedMask;
+			for (const auto mappingIndex : m_targetMappings)
+			{
+				if (mappingIndex != NoMapping)
+					filteredMask.set(mappingIndex);
+			}
+			return filteredMask;
+		}
+
+		/**
+		 * \brief Always true, the filter keeps no state between updates: the same input gives the same output.
+		 */
+		[[nodiscard]]
+		auto IsSettled() const noexcept -> bool
+		{
+			return true;
+		}
+	private:
+		void BeginUpdate() noexcept
+		{
+			std::ranges::fill(m_heldRanks, RankMask_t{});
+		}
+
+		void SetHeld(const keyboardtypes::Index_t mappingIndex) noexcept
+		{
+			const auto [groupSlot, rank] = m_mappingRanks[mappingIndex];
+			m_heldRanks[groupSlot][rank / WordBits] |= Word_t{ 1 } << (rank % WordBits);
+		}
+
+		// The highest held rank of each group is its target.
+		void ResolveGroups() noexcept
+		{
+			for (std::size_t groupSlot{}; groupSlot < m_heldRanks.size(); ++groupSlot)
+			{
+				const auto& heldRanks = m_heldRanks[groupSlot];
+				m_targetMappings[groupSlot] = NoMapping;
+				for (std::size_t word{ WordCount }; word-- > 0; )
+				{
+					if (heldRanks[word] != 0)
+					{
+						const auto rank = word * WordBits + (WordBits - 1 - std::countl_zero(heldRanks[word]));
+						m_targetMappings[groupSlot] = m_rankMappings[rank];
+						break;
+					}
+				}
+			}
+		}
+	};
+	static_assert(std::copyable<KeyboardPriorityOvertakingFilter>);
+	static_assert(std::movable<KeyboardPriorityOvertakingFilter>);
+}
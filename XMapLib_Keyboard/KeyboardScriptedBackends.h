@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardKeystrokeDecoder.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+/*
+ * Scripted stand-ins for the device backends, so that the acquisition side (connection monitoring, event queue) runs and is tested without a controller,
+ * on any platform. Each replays a timeline given at construction, against the clock policy's time.
+ */
+namespace sds
+{
+	/**
+	 * \brief	A connection or disconnection of a player slot, at an offset from the timeline's start.
+	 */
+	struct ScriptedConnectionChange final
+	{
+		TimeManagement::Nanos_t Offset{};
+		std::size_t PlayerId{};
+		bool IsConnected{};
+	};
+
+	/**
+	 * \brief	Connection probe (<c>ConnectionProbe_c</c>) replaying a connect/disconnect timeline: a slot is connected if its last change at or before the
+	 *	probe time connected it, every slot starts disconnected. Counts the probes of each slot, as an expensive OS API call would be counted.
+	 * \remarks The probe counts may be read from another thread than the one probing.
+	 */
+	template<TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
+	class ScriptedConnectionProbe final
+	{
+		std::vector<ScriptedConnectionChange> m_timeline;
+		TimeManagement::TimePoint_t m_startTime{};
+		std::array<std::atomic<std::uint64_t>, controllercodes::MaxPlayerCount> m_probeCounts{};
+	public:
+		/**
+		 * \param timeline The connection changes, in any order (sorted by offset, stable for changes at the same offset).
+		 * \param startTime The time point the offsets are from.
+		 */
+		explicit ScriptedConnectionProbe(std::vector<ScriptedConnectionChange> timeline, const TimeManagement::TimePoint_t startTime = ClockPolicy_t::now())
+			: m_timeline(std::move(timeline)), m_startTime(startTime)
+		{
+			std::ranges::stable_sort(m_timeline, {}, &ScriptedConnectionChange::Offset);
+		}
+
+		ScriptedConnectionProbe(ScriptedConnectionProbe&& other) noexcept
+			: m_timeline(std::move(other.m_timeline)), m_startTime(other.m_startTime)
+		{
+			for (std::size_t playerId{}; playerId < m_probeCounts.size(); ++playerId)
+				m_probeCounts[playerId].store(other.m_probeCounts[playerId].load());
+		}
+
+		[[nodiscard]]
+		auto IsConnected(const std::size_t playerId) -> bool
+		{
+			if (playerId < m_probeCounts.size())
+				m_probeCounts[playerId].fetch_add(1, std::memory_order_relaxed);
+			return IsConnectedAt(playerId, ClockPolicy_t::now());
+		}
+
+		/**
+		 * \brief The scripted connection state of the slot at the time point, without counting a probe.
+		 */
+		[[nodiscard]]
+		auto IsConnectedAt(const std::size_t playerId, const TimeManagement::TimePoint_t timePoint) const noexcept -> bool
+		{
+			bool isConnected{};
+			for (const auto& change : m_timeline)
+			{
+				if (m_startTime + change.Offset > timePoint)
+					break;
+				if (change.PlayerId == playerId)
+					isConnected = change.IsConnected;
+			}
+			return isConnected;
+		}
+
+		[[nodiscard]]
+		auto GetProbeCount(const std::size_t playerId) const noexcept -> std::uint64_t
+		{
+			return playerId < m_probeCounts.size() ? m_probeCounts[playerId].load(std::memory_order_relaxed) : 0;
+		}
+	};
+
+	/**
+	 * \brief	A keystroke queued at an offset from the timeline's start.
+	 */
+	struct ScriptedKeystroke final
+	{
+		TimeManagement::Nanos_t Offset{};
+		ControllerKeystroke Keystroke;
+	};
+
+	/**
+	 * \brief	Keystroke source (<c>KeystrokeSource_c</c>) replaying a keystroke timeline: each drain appends the keystrokes queued since the last one,
+	 *	in order. The controller is always connected.
+	 */
+	template<TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
+	class ScriptedKeystrokeSource final
+	{
+		std::vector<ScriptedKeystroke> m_timeline;
+		TimeManagement::TimePoint_t m_startTime{};
+		std::size_t m_nextKeystroke{};
+	public:
+		/**
+		 * \param timeline The keystrokes, in any order (sorted by offset, stable for keystrokes at the same offset).
+		 * \param startTime The time point the offsets are from.
+		 */
+		explicit ScriptedKeystrokeSource(std::vector<ScriptedKeystroke> timeline, const TimeManagement::TimePoint_t startTime = ClockPolicy_t::now())
+			: m_timeline(std::move(timeline)), m_startTime(startTime)
+		{
+			std::ranges::stable_sort(m_timeline, {}, &ScriptedKeystroke::Offset);
+		}
+
+		auto DrainKeystrokes(KeystrokeBuffer_t& keystrokes) -> bool
+		{
+			const auto timePoint = ClockPolicy_t::now();
+			for (; m_nextKeystroke < m_timeline.size() && m_startTime + m_timeline[m_nextKeystroke].Offset <= timePoint; ++m_nextKeystroke)
+				keystrokes.emplace_back(m_timeline[m_nextKeystroke].Keystroke);
+			return true;
+		}
+
+		/**
+		 * \brief True once every keystroke of the timeline was drained.
+		 */
+		[[nodiscard]]
+		auto IsDone() const noexcept -> bool
+		{
+			return m_nextKeystroke == m_timeline.size();
+		}
+	};
+}
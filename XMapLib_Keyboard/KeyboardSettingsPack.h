@@ -1,19 +1,13 @@
 #pragma once
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
-#endif
-#include <Windows.h>
-#include <Xinput.h>
-
+#include "KeyboardControllerState.h"
 #include "KeyboardCustomTypes.h"
 
 #include <array>
 #include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <numbers>
+#include <string>
 
 namespace sds
 {
@@ -66,6 +60,15 @@ namespace sds
 		}
 	}
 
+	/**
+	 * \brief How the state decoders compute a thumbstick's direction and deadzone test.
+	 */
+	enum class StickClassifier : std::uint8_t
+	{
+		PolarFloat, // Float polar radius and angle (hypot, atan2), and the angle bounds of GetDirectionForPolarTheta.
+		IntegerOctant // Integer only, squared magnitude and slope comparisons, see GetDirectionForStickValues.
+	};
+
 	/**
 	 * \brief A data structure to hold player information. A default constructed
 	 * KeyboardPlayerInfo struct has default values that are usable. 
@@ -76,10 +79,15 @@ namespace sds
 	};
 
 	/**
-	 * \brief Some constants that are not configurable.
+	 * \brief Some constants that are not configurable, and the stick classifier selection.
 	 */
 	struct KeyboardSettings final
 	{
+		/**
+		 * \brief Thumbstick direction and deadzone computation, the integer classifier avoids the float trig functions on every poll.
+		 */
+		StickClassifier StickDirectionClassifier{ StickClassifier::PolarFloat };
+
 		/**
 		 * \brief Delay each iteration of a polling loop, short enough to not miss information, long enough to not waste CPU cycles.
 		 */
@@ -90,49 +98,49 @@ namespace sds
 		static constexpr keyboardtypes::NanosDelay_t KeyRepeatDelay{ std::chrono::microseconds{100'000} };
 
 		// Controller buttons
-		static constexpr keyboardtypes::VirtualKey_t ButtonA{ XINPUT_GAMEPAD_A };
-		static constexpr keyboardtypes::VirtualKey_t ButtonB{ XINPUT_GAMEPAD_B };
-		static constexpr keyboardtypes::VirtualKey_t ButtonX{ XINPUT_GAMEPAD_X };
-		static constexpr keyboardtypes::VirtualKey_t ButtonY{ XINPUT_GAMEPAD_Y };
+		static constexpr keyboardtypes::VirtualKey_t ButtonA{ controllercodes::A };
+		static constexpr keyboardtypes::VirtualKey_t ButtonB{ controllercodes::B };
+		static constexpr keyboardtypes::VirtualKey_t ButtonX{ controllercodes::X };
+		static constexpr keyboardtypes::VirtualKey_t ButtonY{ controllercodes::Y };
 
 		// Dpad buttons
-		static constexpr keyboardtypes::VirtualKey_t DpadUp{ XINPUT_GAMEPAD_DPAD_UP };
-		static constexpr keyboardtypes::VirtualKey_t DpadDown{ XINPUT_GAMEPAD_DPAD_DOWN };
-		static constexpr keyboardtypes::VirtualKey_t DpadLeft{ XINPUT_GAMEPAD_DPAD_LEFT };
-		static constexpr keyboardtypes::VirtualKey_t DpadRight{ XINPUT_GAMEPAD_DPAD_RIGHT };
+		static constexpr keyboardtypes::VirtualKey_t DpadUp{ controllercodes::DpadUp };
+		static constexpr keyboardtypes::VirtualKey_t DpadDown{ controllercodes::DpadDown };
+		static constexpr keyboardtypes::VirtualKey_t DpadLeft{ controllercodes::DpadLeft };
+		static constexpr keyboardtypes::VirtualKey_t DpadRight{ controllercodes::DpadRight };
 
 		// Left thumbstick directions
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUp{ VK_GAMEPAD_LEFT_THUMBSTICK_UP }; // UP
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpRight{ VK_PAD_LTHUMB_UPRIGHT }; // UP-RIGHT
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickRight{ VK_GAMEPAD_LEFT_THUMBSTICK_RIGHT }; // RIGHT
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownRight{ VK_PAD_LTHUMB_DOWNRIGHT }; // RIGHT-DOWN
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDown{ VK_GAMEPAD_LEFT_THUMBSTICK_DOWN }; // DOWN
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownLeft{ VK_PAD_LTHUMB_DOWNLEFT }; // DOWN-LEFT
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickLeft{VK_GAMEPAD_LEFT_THUMBSTICK_LEFT }; // LEFT
-		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpLeft{ VK_PAD_LTHUMB_UPLEFT }; // UP-LEFT
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUp{ controllercodes::LeftThumbstickUp }; // UP
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpRight{ controllercodes::LeftThumbstickUpRight }; // UP-RIGHT
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickRight{ controllercodes::LeftThumbstickRight }; // RIGHT
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownRight{ controllercodes::LeftThumbstickDownRight }; // RIGHT-DOWN
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDown{ controllercodes::LeftThumbstickDown }; // DOWN
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickDownLeft{ controllercodes::LeftThumbstickDownLeft }; // DOWN-LEFT
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickLeft{ controllercodes::LeftThumbstickLeft }; // LEFT
+		static constexpr keyboardtypes::VirtualKey_t LeftThumbstickUpLeft{ controllercodes::LeftThumbstickUpLeft }; // UP-LEFT
 
 		// Right thumbstick directions
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUp{ VK_GAMEPAD_RIGHT_THUMBSTICK_UP }; // UP
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUpRight{ VK_PAD_RTHUMB_UPRIGHT }; //UP-RIGHT
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickRight{ VK_GAMEPAD_RIGHT_THUMBSTICK_RIGHT }; // RIGHT
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDownRight{ VK_PAD_RTHUMB_DOWNRIGHT }; // RIGHT-DOWN
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDown{ VK_GAMEPAD_RIGHT_THUMBSTICK_DOWN }; // DOWN
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDownLeft{ VK_PAD_RTHUMB_DOWNLEFT }; // DOWN-LEFT
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickLeft{ VK_GAMEPAD_RIGHT_THUMBSTICK_LEFT }; // LEFT
-		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUpLeft{ VK_PAD_RTHUMB_UPLEFT }; // UP-LEFT
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUp{ controllercodes::RightThumbstickUp }; // UP
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUpRight{ controllercodes::RightThumbstickUpRight }; //UP-RIGHT
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickRight{ controllercodes::RightThumbstickRight }; // RIGHT
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDownRight{ controllercodes::RightThumbstickDownRight }; // RIGHT-DOWN
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDown{ controllercodes::RightThumbstickDown }; // DOWN
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickDownLeft{ controllercodes::RightThumbstickDownLeft }; // DOWN-LEFT
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickLeft{ controllercodes::RightThumbstickLeft }; // LEFT
+		static constexpr keyboardtypes::VirtualKey_t RightThumbstickUpLeft{ controllercodes::RightThumbstickUpLeft }; // UP-LEFT
 
 		// Other buttons
-		static constexpr keyboardtypes::VirtualKey_t ButtonStart{ XINPUT_GAMEPAD_START };
-		static constexpr keyboardtypes::VirtualKey_t ButtonBack{ XINPUT_GAMEPAD_BACK };
-		static constexpr keyboardtypes::VirtualKey_t ButtonShoulderLeft{ XINPUT_GAMEPAD_LEFT_SHOULDER };
-		static constexpr keyboardtypes::VirtualKey_t ButtonShoulderRight{ XINPUT_GAMEPAD_RIGHT_SHOULDER };
-		static constexpr keyboardtypes::VirtualKey_t ThumbLeftClick{ XINPUT_GAMEPAD_LEFT_THUMB };
-		static constexpr keyboardtypes::VirtualKey_t ThumbRightClick{ XINPUT_GAMEPAD_RIGHT_THUMB };
+		static constexpr keyboardtypes::VirtualKey_t ButtonStart{ controllercodes::Start };
+		static constexpr keyboardtypes::VirtualKey_t ButtonBack{ controllercodes::Back };
+		static constexpr keyboardtypes::VirtualKey_t ButtonShoulderLeft{ controllercodes::LeftShoulder };
+		static constexpr keyboardtypes::VirtualKey_t ButtonShoulderRight{ controllercodes::RightShoulder };
+		static constexpr keyboardtypes::VirtualKey_t ThumbLeftClick{ controllercodes::LeftThumb };
+		static constexpr keyboardtypes::VirtualKey_t ThumbRightClick{ controllercodes::RightThumb };
 
 		// used internally to denote left or right triggers, similar to the button VKs though they may
 		// not be used by the OS API state updates in the same way--we virtualize them.
-		static constexpr keyboardtypes::VirtualKey_t LeftTrigger{ VK_GAMEPAD_LEFT_TRIGGER };
-		static constexpr keyboardtypes::VirtualKey_t RightTrigger{ VK_GAMEPAD_RIGHT_TRIGGER };
+		static constexpr keyboardtypes::VirtualKey_t LeftTrigger{ controllercodes::LeftTrigger };
+		static constexpr keyboardtypes::VirtualKey_t RightTrigger{ controllercodes::RightTrigger };
 
 		/**
 		 * \brief The button virtual keycodes as a flat array.
@@ -155,17 +163,17 @@ namespace sds
 			ButtonY
 		};
 
-		static constexpr keyboardtypes::ThumbstickValue_t LeftStickDeadzone{XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE};
-		static constexpr keyboardtypes::ThumbstickValue_t RightStickDeadzone{XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE};
+		static constexpr keyboardtypes::ThumbstickValue_t LeftStickDeadzone{ controllercodes::LeftStickDeadzone };
+		static constexpr keyboardtypes::ThumbstickValue_t RightStickDeadzone{ controllercodes::RightStickDeadzone };
 
-		static constexpr keyboardtypes::TriggerValue_t LeftTriggerThreshold{XINPUT_GAMEPAD_TRIGGER_THRESHOLD};
-		static constexpr keyboardtypes::TriggerValue_t RightTriggerThreshold{XINPUT_GAMEPAD_TRIGGER_THRESHOLD};
+		static constexpr keyboardtypes::TriggerValue_t LeftTriggerThreshold{ controllercodes::TriggerThreshold };
+		static constexpr keyboardtypes::TriggerValue_t RightTriggerThreshold{ controllercodes::TriggerThreshold };
 
 		// The type of the button buffer without const/volatile/reference.
 		using ButtonBuffer_t = std::remove_reference_t< std::remove_cv_t<decltype(ButtonCodeArray)> >;
 
-		// TODO update this if the values become non-const
-		friend auto hash_value([[maybe_unused]] const KeyboardSettings& obj) -> std::size_t { return 0x0ED35098; }
+		// TODO update this if more values become non-const
+		friend auto hash_value(const KeyboardSettings& obj) -> std::size_t { return 0x0ED35098 ^ static_cast<std::size_t>(obj.StickDirectionClassifier); }
 	};
 
 	static_assert(std::copyable<KeyboardSettings>);
@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+namespace sds
+{
+	/**
+	 * \brief	Bounded lock-free single-producer/single-consumer ring buffer of trivially copyable elements.
+	 * \remarks Exactly one thread may push and exactly one (other) thread may pop. Capacity must be a power of two. The producer and consumer
+	 *	indices are on separate cache lines, each side keeps a cached copy of the other side's index and only re-reads it (acquire) when the
+	 *	ring appears full or empty. Not copyable or movable.
+	 */
+	template<typename Element_t, std::size_t Capacity>
+		requires std::is_trivially_copyable_v<Element_t> && (Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0)
+	class SpscRing final
+	{
+		static constexpr std::size_t CacheLineSize{ 64 };
+		static constexpr std::size_t IndexMask{ Capacity - 1 };
+
+		// Consumer side: next index to pop, and the consumer's copy of the producer index.
+		alignas(CacheLineSize) std::atomic<std::size_t> m_head{};
+		std::size_t m_cachedTail{};
+		// Producer side: next index to push, and the producer's copy of the consumer index.
+		alignas(CacheLineSize) std::atomic<std::size_t> m_tail{};
+		std::size_t m_cachedHead{};
+		alignas(CacheLineSize) std::array<Element_t, Capacity> m_buffer{};
+	public:
+		SpscRing() = default;
+		SpscRing(const SpscRing&) = delete;
+		auto operator=(const SpscRing&) -> SpscRing& = delete;
+
+		/**
+		 * \brief Producer only. Pushes the element, returns false (and does nothing) if the ring is full.
+		 */
+		[[nodiscard]]
+		auto TryPush(const Element_t& element) noexcept -> bool
+		{
+			const auto tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_cachedHead == Capacity)
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				if (tail - m_cachedHead == Capacity)
+					return false;
+			}
+			m_buffer[tail & IndexMask] = element;
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * \brief Consumer only. Pops the oldest element, returns nothing if the ring is empty.
+		 */
+		[[nodiscard]]
+		auto TryPop() noexcept -> std::optional<Element_t>
+		{
+			const auto head = m_head.load(std::memory_order_relaxed);
+			if (head == m_cachedTail)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				if (head == m_cachedTail)
+					return {};
+			}
+			const Element_t element = m_buffer[head & IndexMask];
+			m_head.store(head + 1, std::memory_order_release);
+			return element;
+		}
+
+		/**
+		 * \brief Number of elements in the ring, only a snapshot when called while the other side is active.
+		 */
+		[[nodiscard]]
+		auto SizeApprox() const noexcept -> std::size_t
+		{
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]]
+		static constexpr auto GetCapacity() noexcept -> std::size_t
+		{
+			return Capacity;
+		}
+	};
+}
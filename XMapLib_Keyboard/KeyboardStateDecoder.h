@@ -0,0 +1,278 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardCustomTypes.h"
+#include "KeyboardKeyIndexMap.h"
+#include "KeyboardSettingsPack.h"
+#include "KeyboardPolarInfo.h"
+#include "KeyboardStickDirection.h"
+#include "KeyboardStickQuantizer.h"
+
+namespace sds
+{
+	// TODO for thumbstick and trigger magnitudes.
+	//struct DownKeyInfo
+	//{
+	//	keyboardtypes::VirtualKey_t VirtualCode;
+	//	int Magnitude;
+	//};
+
+	/**
+	 * \brief The buttons member of the state update is ONLY for the buttons, triggers are not set there on a key-down.
+	 */
+	[[nodiscard]] constexpr bool IsLeftTriggerBeyondThreshold(const keyboardtypes::TriggerValue_t triggerValue, const keyboardtypes::TriggerValue_t triggerThreshold) noexcept
+	{
+		return triggerValue > triggerThreshold;
+	}
+
+	[[nodiscard]] constexpr bool IsRightTriggerBeyondThreshold(const keyboardtypes::TriggerValue_t triggerValue, const keyboardtypes::TriggerValue_t triggerThreshold) noexcept
+	{
+		return triggerValue > triggerThreshold;
+	}
+
+	/**
+	 * \brief	Calls the provided function with each button and trigger VK that is 'down' in the controller state update, the sticks are not decoded.
+	 */
+	inline
+	void ForEachDownButtonVirtualKeycode(const KeyboardSettings& settingsPack, const ControllerState& controllerState, std::invocable<keyboardtypes::VirtualKey_t> auto&& onDownKey)
+	{
+		// Keys
+		for (const auto elem : settingsPack.ButtonCodeArray)
+		{
+			if (controllerState.Buttons & elem)
+				onDownKey(elem);
+		}
+
+		// Triggers
+		if (IsLeftTriggerBeyondThreshold(controllerState.LeftTrigger, settingsPack.LeftTriggerThreshold))
+			onDownKey(settingsPack.LeftTrigger);
+		if (IsRightTriggerBeyondThreshold(controllerState.RightTrigger, settingsPack.RightTriggerThreshold))
+			onDownKey(settingsPack.RightTrigger);
+	}
+
+	/**
+	 * \brief	Decomposes the bit masked controller state update, calling the provided function with each button VK that is 'down'.
+	 * \param settingsPack	Settings pertaining to deadzone info and virtual keycodes.
+	 * \param controllerState	The controller state update.
+	 * \param onDownKey	Callable taking a single <c>VirtualKey_t</c>, called for each 'down' button.
+	 */
+	inline
+	void ForEachDownVirtualKeycode(const KeyboardSettings& settingsPack, const ControllerState& controllerState, std::invocable<keyboardtypes::VirtualKey_t> auto&& onDownKey)
+	{
+		ForEachDownButtonVirtualKeycode(settingsPack, controllerState, onDownKey);
+
+		// Stick axes
+		if (settingsPack.StickDirectionClassifier == StickClassifier::IntegerOctant)
+		{
+			if (IsStickBeyondDeadzone(controllerState.LeftStickX, controllerState.LeftStickY, settingsPack.LeftStickDeadzone))
+				onDownKey(GetVirtualKeyFromDirection(settingsPack, GetDirectionForStickValues(controllerState.LeftStickX, controllerState.LeftStickY), ControllerStick::LeftStick).value());
+			if (IsStickBeyondDeadzone(controllerState.RightStickX, controllerState.RightStickY, settingsPack.RightStickDeadzone))
+				onDownKey(GetVirtualKeyFromDirection(settingsPack, GetDirectionForStickValues(controllerState.RightStickX, controllerState.RightStickY), ControllerStick::RightStick).value());
+			return;
+		}
+
+		constexpr auto LeftStickDz{ settingsPack.LeftStickDeadzone };
+		constexpr auto RightStickDz{ settingsPack.RightStickDeadzone };
+
+		const auto leftThumbstickX{ controllerState.LeftStickX };
+		const auto rightThumbstickX{ controllerState.RightStickX };
+
+		const auto leftThumbstickY{ controllerState.LeftStickY };
+		const auto rightThumbstickY{ controllerState.RightStickY };
+
+		const auto leftStickPolarInfo{ ComputePolarPair(leftThumbstickX, leftThumbstickY) };
+		const auto rightStickPolarInfo{ ComputePolarPair(rightThumbstickX, rightThumbstickY) };
+
+		const auto leftDirection{ GetDirectionForPolarTheta(leftStickPolarInfo.second) };
+		const auto rightDirection{ GetDirectionForPolarTheta(rightStickPolarInfo.second) };
+
+		const auto leftThumbstickVk{ GetVirtualKeyFromDirection(settingsPack, leftDirection, ControllerStick::LeftStick) };
+		const auto rightThumbstickVk{ GetVirtualKeyFromDirection(settingsPack, rightDirection, ControllerStick::RightStick) };
+
+		// TODO deadzone appears too low on left stick, check this part.
+		const bool leftIsDown = leftStickPolarInfo.first > LeftStickDz && leftThumbstickVk.has_value();
+		const bool rightIsDown = rightStickPolarInfo.first > RightStickDz && rightThumbstickVk.has_value();
+
+		if (leftIsDown)
+			onDownKey(leftThumbstickVk.value());
+		if (rightIsDown)
+			onDownKey(rightThumbstickVk.value());
+	}
+
+	/**
+	 * \brief	Decomposes the controller state update as <c>ForEachDownVirtualKeycode</c>, with the stick keys produced by the provided quantizers (any sector
+	 *	count and magnitude bands) instead of the eight direction keys of the settings.
+	 * \param settingsPack	Settings pertaining to trigger thresholds and button virtual keycodes.
+	 * \param controllerState	The controller state update.
+	 * \param leftStick	Quantizer of the left stick.
+	 * \param rightStick	Quantizer of the right stick.
+	 * \param onDownKey	Callable taking a single <c>VirtualKey_t</c>, called for each 'down' button.
+	 */
+	inline
+	void ForEachDownVirtualKeycode(const KeyboardSettings& settingsPack, const ControllerState& controllerState, const StickQuantizer& leftStick, const StickQuantizer& rightStick, std::invocable<keyboardtypes::VirtualKey_t> auto&& onDownKey)
+	{
+		ForEachDownButtonVirtualKeycode(settingsPack, controllerState, onDownKey);
+		if (const auto leftVk = leftStick.GetVirtualKey(controllerState.LeftStickX, controllerState.LeftStickY))
+			onDownKey(*leftVk);
+		if (const auto rightVk = rightStick.GetVirtualKey(controllerState.RightStickX, controllerState.RightStickY))
+			onDownKey(*rightVk);
+	}
+
+	/**
+	 * \brief	Important helper function to build a small vector of button VKs that are 'down'. Essential function
+	 *	is to decompose bit masked state updates into an array.
+	 * \param settingsPack	Settings pertaining to deadzone info and virtual keycodes.
+	 * \param controllerState	The controller state update.
+	 * \return	small vector of down buttons.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetDownVirtualKeycodesRange(const KeyboardSettings& settingsPack, const ControllerState& controllerState) -> keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>
+	{
+		keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> allKeys{};
+		ForEachDownVirtualKeycode(settingsPack, controllerState, [&allKeys](const keyboardtypes::VirtualKey_t vk) { allKeys.emplace_back(vk); });
+		return allKeys;
+	}
+
+	/**
+	 * \brief	Builds the translator's dense down mask directly from the controller state update, no intermediate buffer of VKs is built.
+	 * \param settingsPack	Settings pertaining to deadzone info and virtual keycodes.
+	 * \param controllerState	The controller state update.
+	 * \param keyIndices	The translator's VK to dense index mapping, see <c>KeyboardTranslator::GetKeyIndexMap()</c>
+	 * \return	bitmask of down mappings.
+	 */
+	[[nodiscard]]
+	inline
+	auto GetDownVirtualKeycodesMask(const KeyboardSettings& settingsPack, const ControllerState& controllerState, const KeyIndexMap& keyIndices) noexcept -> keyboardtypes::DownMask_t
+	{
+		keyboardtypes::DownMask_t downMask;
+		ForEachDownVirtualKeycode(settingsPack, controllerState, [&](const keyboardtypes::VirtualKey_t vk) { keyIndices.SetVkInMask(downMask, vk); });
+		return downMask;
+	}
+
+	/**
+	 * \brief	Every 'down' controller key of a state update, one fixed bit per key: bits 0 to 15 are the <c>ControllerState::Buttons</c> bits, with the two bits
+	 *	the buttons do not use holding the triggers, bits 16 to 23 the left stick direction and bits 24 to 31 the right stick direction
+	 *	(the bit is the first stick bit plus the <c>ThumbstickDirection</c> value).
+	 */
+	using ControllerKeyMask_t = std::uint32_t;
+
+	namespace detail
+	{
+		inline constexpr int LeftTriggerBit{ 10 };
+		inline constexpr int RightTriggerBit{ 11 };
+		inline constexpr int LeftStickFirstBit{ 16 };
+		inline constexpr int RightStickFirstBit{ 24 };
+		inline constexpr int ControllerKeyBitCount{ std::numeric_limits<ControllerKeyMask_t>::digits };
+
+		// The button bits of the buttons in KeyboardSettings, each button VK is its own button bit.
+		inline constexpr ControllerKeyMask_t ButtonBits = []()
+		{
+			ControllerKeyMask_t buttonBits{};
+			for (const auto vk : KeyboardSettings::ButtonCodeArray)
+				buttonBits |= static_cast<ControllerKeyMask_t>(vk);
+			return buttonBits;
+		}();
+		static_assert(std::ranges::all_of(KeyboardSettings::ButtonCodeArray, [](const auto vk) { return std::has_single_bit(static_cast<std::uint32_t>(vk)) && vk <= 0xFFFF; }),
+			"Button VKs must be the button bits.");
+		static_assert(static_cast<std::size_t>(std::popcount(ButtonBits)) == KeyboardSettings::ButtonCodeArray.size());
+		static_assert((ButtonBits & ((1u << LeftTriggerBit) | (1u << RightTriggerBit))) == 0, "Trigger bits must be unused by the buttons.");
+
+		// The direction bit of the stick, relative to its first bit, or 0 when within the deadzone. Comparisons are summed instead of branched on.
+		[[nodiscard]]
+		inline
+		auto GetStickDirectionBit(const StickClassifier classifier, const keyboardtypes::ThumbstickValue_t x, const keyboardtypes::ThumbstickValue_t y, const keyboardtypes::ThumbstickValue_t deadzone) noexcept -> ControllerKeyMask_t
+		{
+			if (classifier == StickClassifier::IntegerOctant)
+			{
+				const auto isBeyondDeadzone = static_cast<ControllerKeyMask_t>(IsStickBeyondDeadzone(x, y, deadzone));
+				return isBeyondDeadzone << static_cast<int>(GetDirectionForStickValues(x, y));
+			}
+			const auto [radius, theta] = ComputePolarPair(x, y);
+			const auto isDown = static_cast<ControllerKeyMask_t>(radius > deadzone);
+			return isDown << static_cast<int>(GetDirectionForPolarTheta(theta));
+		}
+	}
+
+	/**
+	 * \brief	Decodes the controller state update into a fixed width mask of the 'down' controller keys, with no per button branch and no buffer.
+	 * \remarks The buttons are a mask of <c>Buttons</c>, the triggers a compare each, a stick direction is a count of the sector boundaries below the polar
+	 *	angle (<c>GetDirectionForPolarTheta</c>), or with <c>StickClassifier::IntegerOctant</c> the integer slope comparisons of <c>GetDirectionForStickValues</c>. The result is the same set of keys as <c>ForEachDownVirtualKeycode</c>, use a <c>ControllerKeyIndexTable</c> to get the translator's down mask.
+	 */
+	[[nodiscard]]
+	inline
+	auto DecodeControllerKeyMask(const KeyboardSettings& settingsPack, const ControllerState& controllerState) noexcept -> ControllerKeyMask_t
+	{
+		using namespace detail;
+		auto downKeys = static_cast<ControllerKeyMask_t>(controllerState.Buttons) & ButtonBits;
+		downKeys |= static_cast<ControllerKeyMask_t>(controllerState.LeftTrigger > settingsPack.LeftTriggerThreshold) << LeftTriggerBit;
+		downKeys |= static_cast<ControllerKeyMask_t>(controllerState.RightTrigger > settingsPack.RightTriggerThreshold) << RightTriggerBit;
+		downKeys |= GetStickDirectionBit(settingsPack.StickDirectionClassifier, controllerState.LeftStickX, controllerState.LeftStickY, settingsPack.LeftStickDeadzone) << LeftStickFirstBit;
+		downKeys |= GetStickDirectionBit(settingsPack.StickDirectionClassifier, controllerState.RightStickX, controllerState.RightStickY, settingsPack.RightStickDeadzone) << RightStickFirstBit;
+		return downKeys;
+	}
+
+	/**
+	 * \brief	The virtual keycode of each controller key bit.
+	 */
+	[[nodiscard]]
+	constexpr
+	auto GetControllerKeyVirtualKeycodes(const KeyboardSettings& settingsPack) -> std::array<keyboardtypes::VirtualKey_t, detail::ControllerKeyBitCount>
+	{
+		using namespace detail;
+		std::array<keyboardtypes::VirtualKey_t, ControllerKeyBitCount> virtualKeys{};
+		for (const auto vk : settingsPack.ButtonCodeArray)
+			virtualKeys[std::countr_zero(static_cast<std::uint32_t>(vk))] = vk;
+		virtualKeys[LeftTriggerBit] = settingsPack.LeftTrigger;
+		virtualKeys[RightTriggerBit] = settingsPack.RightTrigger;
+		for (int direction{}; direction < static_cast<int>(ThumbstickDirection::Invalid); ++direction)
+		{
+			virtualKeys[LeftStickFirstBit + direction] = GetVirtualKeyFromDirection(settingsPack, static_cast<ThumbstickDirection>(direction), ControllerStick::LeftStick).value();
+			virtualKeys[RightStickFirstBit + direction] = GetVirtualKeyFromDirection(settingsPack, static_cast<ThumbstickDirection>(direction), ControllerStick::RightStick).value();
+		}
+		return virtualKeys;
+	}
+
+	/**
+	 * \brief	Controller key bit to the translator's dense mapping index, built once from the translator's <c>KeyIndexMap</c>. Converting a
+	 *	<c>ControllerKeyMask_t</c> to the translator's down mask costs one bit scan per down key that has a mapping, and does not allocate.
+	 */
+	class ControllerKeyIndexTable final
+	{
+		std::array<std::uint8_t, detail::ControllerKeyBitCount> m_mappingIndices{};
+		// Controller keys with a mapping.
+		ControllerKeyMask_t m_mappedKeys{};
+	public:
+		ControllerKeyIndexTable() = default;
+
+		ControllerKeyIndexTable(const KeyIndexMap& keyIndices, const KeyboardSettings& settingsPack)
+		{
+			const auto virtualKeys = GetControllerKeyVirtualKeycodes(settingsPack);
+			for (std::size_t bit{}; bit < virtualKeys.size(); ++bit)
+			{
+				if (const auto index = keyIndices.GetIndexForVk(virtualKeys[bit]))
+				{
+					m_mappingIndices[bit] = static_cast<std::uint8_t>(*index);
+					m_mappedKeys |= ControllerKeyMask_t{ 1 } << bit;
+				}
+			}
+		}
+
+		[[nodiscard]]
+		auto GetDownMask(const ControllerKeyMask_t downKeys) const noexcept -> keyboardtypes::DownMask_t
+		{
+			keyboardtypes::DownMask_t downMask;
+			for (auto keys = downKeys & m_mappedKeys; keys != 0; keys &= keys - 1)
+				downMask.set(m_mappingIndices[std::countr_zero(keys)]);
+			return downMask;
+		}
+	};
+
+	static_assert(std::copyable<ControllerKeyIndexTable>);
+}
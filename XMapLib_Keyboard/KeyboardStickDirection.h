@@ -1,76 +1,86 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <numbers>
-#include <tuple>
 #include "KeyboardSettingsPack.h"
 
 namespace sds
 {
 	namespace detail
 	{
-		// Apparently std::tuple can't be used for non-type template param
-		struct DirectionTuple
+		// Direction sector bounds of the polar angle, ascending, and the direction of each sector: the number of bounds below the angle is the sector.
+		// A bound belongs to the sector below it, except -pi/8 which belongs to Right, so Right is [-pi/8, pi/8] and Left is both ends of the range.
+		inline constexpr std::array<keyboardtypes::ComputationFloat_t, 8> SectorBounds
 		{
-			keyboardtypes::ComputationFloat_t Low;
-			keyboardtypes::ComputationFloat_t High;
-			ThumbstickDirection Direction;
-			constexpr DirectionTuple(keyboardtypes::ComputationFloat_t low, keyboardtypes::ComputationFloat_t high, ThumbstickDirection dir) noexcept
-				: Low(low), High(high), Direction(dir) { }
+			7 * -MY_PI8, 5 * -MY_PI8, 3 * -MY_PI8, -MY_PI8, MY_PI8, 3 * MY_PI8, 5 * MY_PI8, 7 * MY_PI8
 		};
-
-		using DirectionTuple_t = DirectionTuple;
-
-		// Direction boundary value tuples, with diagonal directions, and translation.
-		static constexpr auto StickRight{ DirectionTuple_t(-MY_PI8, MY_PI8, ThumbstickDirection::Right) };
-		static constexpr auto StickUpRight{ DirectionTuple_t(MY_PI8, 3 * MY_PI8, ThumbstickDirection::UpRight) };
-		static constexpr auto StickUp{ DirectionTuple_t(3 * MY_PI8, 5 * MY_PI8, ThumbstickDirection::Up) };
-		static constexpr auto StickUpLeft{ DirectionTuple_t(5 * MY_PI8, 7 * MY_PI8, ThumbstickDirection::LeftUp) };
-
-		static constexpr auto StickDownRight{ DirectionTuple_t(3 * -MY_PI8, -MY_PI8, ThumbstickDirection::RightDown) };
-		static constexpr auto StickDown{ DirectionTuple_t(5 * -MY_PI8, 3 * -MY_PI8, ThumbstickDirection::Down) };
-		static constexpr auto StickDownLeft{ DirectionTuple_t(7 * -MY_PI, 5 * -MY_PI8, ThumbstickDirection::DownLeft) };
-		static constexpr auto StickLeft{ DirectionTuple_t(7 * MY_PI8, 7 * -MY_PI8, ThumbstickDirection::Left) };
-
-		// Primary function template for a directional bounds checker.
-		template<DirectionTuple_t bounds>
-		constexpr auto GetDirection(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>
+		inline constexpr std::size_t InclusiveBoundIndex{ 3 };
+		inline constexpr std::array<ThumbstickDirection, SectorBounds.size() + 1> SectorDirections
 		{
-			return (theta >= bounds.Low && theta <= bounds.High) ? bounds.Direction : std::optional<ThumbstickDirection>{};
-		}
+			ThumbstickDirection::Left, ThumbstickDirection::DownLeft, ThumbstickDirection::Down, ThumbstickDirection::RightDown,
+			ThumbstickDirection::Right, ThumbstickDirection::UpRight, ThumbstickDirection::Up, ThumbstickDirection::LeftUp, ThumbstickDirection::Left
+		};
+	}
 
-		// Explicit instantiations for specific boundary pair and direction type.
-		template auto GetDirection<StickRight>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
-		template auto GetDirection<StickUpRight>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
-		template auto GetDirection<StickUp>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
-		template auto GetDirection<StickUpLeft>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
+	/**
+	 * \brief	Direction of the polar angle (radians, as from <c>atan2</c>), a count of the sector bounds below it and a table lookup, no branches.
+	 */
+	[[nodiscard]]
+	constexpr
+	auto GetDirectionForPolarTheta(const keyboardtypes::ComputationFloat_t theta) noexcept -> ThumbstickDirection
+	{
+		using namespace detail;
+		std::size_t sector{};
+		for (std::size_t i{}; i < SectorBounds.size(); ++i)
+			sector += i == InclusiveBoundIndex ? theta >= SectorBounds[i] : theta > SectorBounds[i];
+		return SectorDirections[sector];
+	}
 
-		// This specialization requires custom logic in the bounds check to work.
-		template<>
-		constexpr auto GetDirection<StickLeft>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>
-		{
-			const bool isThetaPositive = theta >= decltype(theta){};
-			const bool isWithinBounds = isThetaPositive ? theta >= StickLeft.Low : theta <= StickLeft.High;
-			return isWithinBounds ? StickLeft.Direction : std::optional<ThumbstickDirection>{};
-		}
+	/**
+	 * \brief	Integer-only form of <c>GetDirectionForPolarTheta</c>, for the raw stick values: no polar computation, the sector is found by comparing
+	 *	the absolute values of the axes against the tan(22.5 degrees) slope, in 32 bit fixed point.
+	 * \remarks The fixed point slope is exact for the stick value range (no stick value pair lies within the rounding of the slope), so this is the
+	 *	exact sector of the stick vector. The float path may differ only for values whose float polar angle lands within a float rounding of a sector
+	 *	bound (504 pairs of the 2^32, all within 3.2e-7 radians of a bound), there the float path is the one that is off. The centered stick (0, 0) has no angle, both
+	 *	paths report a direction but a stick is never beyond the deadzone there.
+	 */
+	[[nodiscard]]
+	constexpr
+	auto GetDirectionForStickValues(const keyboardtypes::ThumbstickValue_t xStickValue, const keyboardtypes::ThumbstickValue_t yStickValue) noexcept -> ThumbstickDirection
+	{
+		// tan(pi/8) = sqrt(2) - 1, scaled by 2^32.
+		constexpr std::int64_t TanPi8Fixed{ 1'779'033'704 };
+		constexpr int FixedShift{ 32 };
+		// Near horizontal, near vertical and diagonal, by the signs of the axes (x negative, y negative).
+		constexpr std::array<std::array<ThumbstickDirection, 4>, 3> Directions
+		{ {
+			{ ThumbstickDirection::Right, ThumbstickDirection::Left, ThumbstickDirection::Right, ThumbstickDirection::Left },
+			{ ThumbstickDirection::Up, ThumbstickDirection::Up, ThumbstickDirection::Down, ThumbstickDirection::Down },
+			{ ThumbstickDirection::UpRight, ThumbstickDirection::LeftUp, ThumbstickDirection::RightDown, ThumbstickDirection::DownLeft }
+		} };
 
-		template auto GetDirection<StickDownLeft>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
-		template auto GetDirection<StickDown>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
-		template auto GetDirection<StickDownRight>(const keyboardtypes::ComputationFloat_t theta) noexcept -> std::optional<ThumbstickDirection>;
+		const std::int64_t absX{ xStickValue < 0 ? -static_cast<std::int64_t>(xStickValue) : xStickValue };
+		const std::int64_t absY{ yStickValue < 0 ? -static_cast<std::int64_t>(yStickValue) : yStickValue };
+		const bool isHorizontal = (absY << FixedShift) < absX * TanPi8Fixed;
+		const bool isVertical = (absX << FixedShift) < absY * TanPi8Fixed;
+		const auto sectorKind = static_cast<std::size_t>(isVertical) + 2 * static_cast<std::size_t>(!isHorizontal && !isVertical);
+		const auto signs = static_cast<std::size_t>(xStickValue < 0) + 2 * static_cast<std::size_t>(yStickValue < 0);
+		return Directions[sectorKind][signs];
 	}
 
+	/**
+	 * \brief	Integer-only deadzone test, the squared magnitude of the stick vector against the squared deadzone.
+	 * \remarks The float path compares the float <c>hypot</c>, it differs only for the magnitudes within a float rounding above the deadzone (16 pairs for the
+	 *	default left stick deadzone), which the float path rounds down to the deadzone.
+	 */
 	[[nodiscard]]
 	constexpr
-	auto GetDirectionForPolarTheta(const keyboardtypes::ComputationFloat_t theta) noexcept -> ThumbstickDirection
+	bool IsStickBeyondDeadzone(const keyboardtypes::ThumbstickValue_t xStickValue, const keyboardtypes::ThumbstickValue_t yStickValue, const keyboardtypes::ThumbstickValue_t deadzone) noexcept
 	{
-		using namespace detail;
-		const auto dir = GetDirection<StickRight>(theta)
-			.or_else([theta]() { return GetDirection<StickUpRight>(theta); })
-			.or_else([theta]() { return GetDirection<StickUp>(theta); })
-			.or_else([theta]() { return GetDirection<StickUpLeft>(theta); })
-			.or_else([theta]() { return GetDirection<StickLeft>(theta); })
-			.or_else([theta]() { return GetDirection<StickDownLeft>(theta); })
-			.or_else([theta]() { return GetDirection<StickDown>(theta); })
-			.or_else([theta]() { return GetDirection<StickDownRight>(theta); });
-		return dir.value_or(ThumbstickDirection::Invalid);
+		const std::int64_t x{ xStickValue };
+		const std::int64_t y{ yStickValue };
+		const std::int64_t dz{ deadzone };
+		return x * x + y * y > dz * dz;
 	}
 
 	[[nodiscard]]
@@ -0,0 +1,199 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "KeyboardCustomTypes.h"
+#include "KeyboardSettingsPack.h"
+#include "KeyboardStickDirection.h"
+
+namespace sds
+{
+	/**
+	 * \brief	Quantizes a thumbstick's raw (x, y) value into one of N angular sectors (4, 8, 16 or 32) and one of a set of magnitude bands, each
+	 *	sector of each band producing its own virtual key.
+	 * \remarks Sector 0 is centered on the +x axis (right), sectors are numbered counter-clockwise, so with 8 sectors they are in the order right,
+	 *	up-right, up, up-left, left, down-left, down, down-right. A point exactly on a sector bound (only possible with 4 sectors, on the diagonals)
+	 *	belongs to the sector nearer the x axis. The bands are given as ascending magnitude thresholds, the first being the deadzone: a stick beyond
+	 *	B of the thresholds is in band B - 1, a stick not beyond the deadzone produces no key.
+	 *	<p>The classification is exact. The constructor builds, once, a lookup table over the first quadrant quantized to 128 units per axis, holding the
+	 *	band and quadrant sector of every cell that lies entirely in one band and one sector. A poll is then the absolute values of the axes, one table
+	 *	load and a reflection of the quadrant sector by the signs of the axes, whatever the number of sectors or bands. Only the cells straddling a bound
+	 *	are classified on the poll, with integer comparisons against the 2^40 fixed point bound slopes (exact for the stick value range) and the
+	 *	squared thresholds.</p>
+	 */
+	class StickQuantizer final
+	{
+		static constexpr int CellShift{ 7 };
+		static constexpr std::size_t CellsPerAxis{ std::size_t{ 1 } << (15 - CellShift) };
+		static constexpr std::uint8_t AmbiguousCell{ 0xFF };
+		static constexpr int FixedShift{ 40 };
+		static constexpr std::size_t MaxBandCount{ 8 };
+
+		struct BoundSlope_t final
+		{
+			std::int64_t CosFixed{};
+			std::int64_t SinFixed{};
+		};
+
+		std::uint32_t m_sectorCount{};
+		// Bounds of the quadrant's sectors, ascending angle.
+		keyboardtypes::SmallVector_t<BoundSlope_t> m_quadrantBounds;
+		// Squared band thresholds, ascending.
+		keyboardtypes::SmallVector_t<std::int64_t> m_squaredThresholds;
+		// Thresholds beyond (high nibble) and quadrant sector (low nibble) per first quadrant cell, or AmbiguousCell.
+		std::vector<std::uint8_t> m_cells;
+		// Zone (band, then sector) to virtual key.
+		keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t> m_zoneVirtualKeys;
+	public:
+		/**
+		 * \brief Builds the quantizer and its lookup table.
+		 * \param sectorCount Number of angular sectors, 4, 8, 16 or 32.
+		 * \param bandThresholds Ascending magnitude thresholds, the first is the deadzone, at most 8.
+		 * \param zoneVirtualKeys Virtual key of each sector of each band, band major: the key of band B, sector S is at B * sectorCount + S.
+		 * \exception std::runtime_error on an unsupported sector count, no or non-ascending thresholds, or a virtual key count not bands times sectors.
+		 */
+		StickQuantizer(const std::uint32_t sectorCount, const std::span<const keyboardtypes::ThumbstickValue_t> bandThresholds, const std::span<const keyboardtypes::VirtualKey_t> zoneVirtualKeys)
+			: m_sectorCount(sectorCount)
+		{
+			if (sectorCount != 4 && sectorCount != 8 && sectorCount != 16 && sectorCount != 32)
+				throw std::runtime_error("Exception: Stick quantizer sector count must be 4, 8, 16 or 32.");
+			if (bandThresholds.empty() || bandThresholds.size() > MaxBandCount || bandThresholds.front() < 0 || !std::ranges::is_sorted(bandThresholds, std::ranges::less_equal{}))
+				throw std::runtime_error("Exception: Stick quantizer band thresholds must be 1 to 8 ascending non-negative values.");
+			if (zoneVirtualKeys.size() != bandThresholds.size() * sectorCount)
+				throw std::runtime_error("Exception: Stick quantizer virtual key count must be the band count times the sector count.");
+
+			// Bound J of the quadrant is at angle (2J + 1) * pi / sectorCount, its sine is the cosine of the mirrored bound so the slopes are symmetric.
+			const auto quadrantBoundCount = sectorCount / 4;
+			const auto GetCosFixed = [sectorCount](const std::uint32_t bound)
+			{
+				const auto angle = static_cast<double>(2 * bound + 1) * std::numbers::pi / static_cast<double>(sectorCount);
+				return std::llround(std::cos(angle) * static_cast<double>(std::int64_t{ 1 } << FixedShift));
+			};
+			for (std::uint32_t bound{}; bound < quadrantBoundCount; ++bound)
+				m_quadrantBounds.emplace_back(BoundSlope_t{ .CosFixed = GetCosFixed(bound), .SinFixed = GetCosFixed(quadrantBoundCount - 1 - bound) });
+			for (const auto threshold : bandThresholds)
+				m_squaredThresholds.emplace_back(std::int64_t{ threshold } * threshold);
+			m_zoneVirtualKeys.assign(zoneVirtualKeys.begin(), zoneVirtualKeys.end());
+
+			// A cell is in one sector if its lowest and highest angle corners are, and in one band if its nearest and farthest corners are.
+			m_cells.resize(CellsPerAxis * CellsPerAxis);
+			for (std::size_t cellY{}; cellY < CellsPerAxis; ++cellY)
+			{
+				for (std::size_t cellX{}; cellX < CellsPerAxis; ++cellX)
+				{
+					const auto [lowX, highX] = GetCellRange(cellX);
+					const auto [lowY, highY] = GetCellRange(cellY);
+					const auto sector = GetQuadrantSector(highX, lowY);
+					const auto thresholdCount = GetThresholdCount(lowX, lowY);
+					const bool isOneZone = sector == GetQuadrantSector(lowX, highY) && thresholdCount == GetThresholdCount(highX, highY);
+					m_cells[cellY * CellsPerAxis + cellX] = isOneZone ? PackCell(thresholdCount, sector) : AmbiguousCell;
+				}
+			}
+		}
+
+		/**
+		 * \brief Builds the eight direction quantizer equivalent to <c>GetDirectionForStickValues</c> and <c>IsStickBeyondDeadzone</c>, producing the
+		 *	settings' thumbstick direction keys.
+		 */
+		[[nodiscard]]
+		static auto GetDirectionQuantizer(const KeyboardSettings& settingsPack, const ControllerStick whichStick) -> StickQuantizer
+		{
+			const bool isLeftStick = whichStick == ControllerStick::LeftStick;
+			const std::array<keyboardtypes::ThumbstickValue_t, 1> deadzone{ isLeftStick ? settingsPack.LeftStickDeadzone : settingsPack.RightStickDeadzone };
+			constexpr std::array DirectionsBySector
+			{
+				ThumbstickDirection::Right, ThumbstickDirection::UpRight, ThumbstickDirection::Up, ThumbstickDirection::LeftUp,
+				ThumbstickDirection::Left, ThumbstickDirection::DownLeft, ThumbstickDirection::Down, ThumbstickDirection::RightDown
+			};
+			std::array<keyboardtypes::VirtualKey_t, DirectionsBySector.size()> virtualKeys{};
+			std::ranges::transform(DirectionsBySector, virtualKeys.begin(), [&](const auto direction) { return GetVirtualKeyFromDirection(settingsPack, direction, whichStick).value(); });
+			return StickQuantizer{ static_cast<std::uint32_t>(DirectionsBySector.size()), deadzone, virtualKeys };
+		}
+
+		/**
+		 * \brief The zone of the stick value, band major (band B, sector S is zone B * sectorCount + S), or none within the deadzone.
+		 */
+		[[nodiscard]]
+		auto GetZone(const keyboardtypes::ThumbstickValue_t xStickValue, const keyboardtypes::ThumbstickValue_t yStickValue) const noexcept -> std::optional<std::uint32_t>
+		{
+			const std::int64_t absX{ xStickValue < 0 ? -static_cast<std::int64_t>(xStickValue) : xStickValue };
+			const std::int64_t absY{ yStickValue < 0 ? -static_cast<std::int64_t>(yStickValue) : yStickValue };
+			auto cell = m_cells[GetCellIndex(absY) * CellsPerAxis + GetCellIndex(absX)];
+			if (cell == AmbiguousCell)
+				cell = PackCell(GetThresholdCount(absX, absY), GetQuadrantSector(absX, absY));
+			// Thresholds the magnitude is beyond, the band is one less.
+			const auto thresholdCount = static_cast<std::uint32_t>(cell >> 4);
+			if (thresholdCount == 0)
+				return {};
+
+			// Reflects the quadrant sector by the signs of the axes: (x, y), (-x, y), (x, -y), (-x, -y) quadrants.
+			const std::array<std::uint32_t, 4> quadrantBase{ 0, m_sectorCount / 2, m_sectorCount, m_sectorCount / 2 };
+			constexpr std::array<std::int32_t, 4> QuadrantSign{ 1, -1, -1, 1 };
+			const auto quadrant = static_cast<std::size_t>(xStickValue < 0) + 2 * static_cast<std::size_t>(yStickValue < 0);
+			const auto quadrantSector = static_cast<std::int32_t>(cell & 0x0F);
+			const auto sector = static_cast<std::uint32_t>(static_cast<std::int32_t>(quadrantBase[quadrant]) + QuadrantSign[quadrant] * quadrantSector) & (m_sectorCount - 1);
+			return (thresholdCount - 1) * m_sectorCount + sector;
+		}
+
+		/**
+		 * \brief The virtual key of the stick value's zone, or none within the deadzone.
+		 */
+		[[nodiscard]]
+		auto GetVirtualKey(const keyboardtypes::ThumbstickValue_t xStickValue, const keyboardtypes::ThumbstickValue_t yStickValue) const noexcept -> std::optional<keyboardtypes::VirtualKey_t>
+		{
+			return GetZone(xStickValue, yStickValue).transform([this](const auto zone) { return m_zoneVirtualKeys[zone]; });
+		}
+
+		[[nodiscard]] auto GetSectorCount() const noexcept -> std::uint32_t { return m_sectorCount; }
+		[[nodiscard]] auto GetBandCount() const noexcept -> std::size_t { return m_squaredThresholds.size(); }
+	private:
+		static constexpr auto GetCellIndex(const std::int64_t absValue) noexcept -> std::size_t
+		{
+			return static_cast<std::size_t>(std::min<std::int64_t>(absValue, 0x7FFF) >> CellShift);
+		}
+
+		// Absolute value range of the cell, the last cell also holds 32768 (the absolute value of the lowest stick value).
+		static constexpr auto GetCellRange(const std::size_t cell) noexcept -> std::pair<std::int64_t, std::int64_t>
+		{
+			const auto low = static_cast<std::int64_t>(cell) << CellShift;
+			const auto high = cell + 1 == CellsPerAxis ? std::int64_t{ 0x8000 } : low + (std::int64_t{ 1 } << CellShift) - 1;
+			return { low, high };
+		}
+
+		static constexpr auto PackCell(const std::uint32_t thresholdCount, const std::uint32_t quadrantSector) noexcept -> std::uint8_t
+		{
+			return static_cast<std::uint8_t>(thresholdCount << 4 | quadrantSector);
+		}
+
+		// Number of quadrant bounds strictly below the angle of (absX, absY), from 0 (right) to a quarter of the sector count (up).
+		[[nodiscard]]
+		auto GetQuadrantSector(const std::int64_t absX, const std::int64_t absY) const noexcept -> std::uint32_t
+		{
+			std::uint32_t sector{};
+			for (const auto& [cosFixed, sinFixed] : m_quadrantBounds)
+				sector += absY * cosFixed > absX * sinFixed;
+			return sector;
+		}
+
+		// Number of thresholds the magnitude is beyond, 0 is within the deadzone.
+		[[nodiscard]]
+		auto GetThresholdCount(const std::int64_t absX, const std::int64_t absY) const noexcept -> std::uint32_t
+		{
+			const auto squaredMagnitude = absX * absX + absY * absY;
+			std::uint32_t thresholdCount{};
+			for (const auto squaredThreshold : m_squaredThresholds)
+				thresholdCount += squaredMagnitude > squaredThreshold;
+			return thresholdCount;
+		}
+	};
+
+	static_assert(std::copyable<StickQuantizer>);
+	static_assert(std::movable<StickQuantizer>);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <concepts>
+#include <span>
+#include <type_traits>
+
+#include "KeyboardCustomTypes.h"
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardTranslationHelpers.h"
+#include "../XMapLib_Utils/TimeManagement.h"
+
+namespace sds
+{
+	/**
+	 * \brief	TranslationEvent is the plain data form of a TranslationResult, it records the transition a mapping performs without
+	 *	type-erased callables. Trivially copyable, so a range of events may be logged, queued across threads, or batched as-is.
+	 *	The transition is performed (callback called and mapping state advanced) by a <c>TranslationEventDispatcher</c>.
+	 */
+	struct TranslationEvent final
+	{
+		// Virtual keycode of the mapping it refers to
+		keyboardtypes::VirtualKey_t MappingVk{};
+		// Dense index of the mapping in the translator's mapping buffer
+		keyboardtypes::Index_t MappingIndex{};
+		// The transition the mapping performs
+		TransitionKind Transition{};
+		// Exclusivity grouping value, if any
+		keyboardtypes::OptGrp_t ExclusivityGrouping;
+		// Time of the update that produced the event
+		TimeManagement::TimePoint_t TimePoint{};
+	};
+
+	static_assert(std::is_trivially_copyable_v<TranslationEvent>);
+
+	// Contiguous range of translation events, re-used by the caller for each update.
+	using TranslationEventBuffer_t = keyboardtypes::SmallVector_t<TranslationEvent>;
+
+	/**
+	 * \brief	Performs translation events against the mappings and mapping state they were produced from: calls the mapping's callback for the
+	 *	transition, then advances the mapping's state.
+	 * \remarks Holds a view of the mappings and mapping state, it is only valid for as long as the translator that provided it (neither buffer is
+	 *	re-allocated after construction, so moving the translator does not invalidate it). Events must be dispatched, in order, before the next update.
+	 */
+	class TranslationEventDispatcher final
+	{
+		std::span<const CBActionMap> m_mappings;
+		std::span<MappingStateManager> m_states;
+	public:
+		TranslationEventDispatcher() = default;
+		TranslationEventDispatcher(const std::span<const CBActionMap> mappings, const std::span<MappingStateManager> states) noexcept
+			: m_mappings(mappings), m_states(states) { }
+
+		void operator()(const TranslationEvent& translationEvent) const
+		{
+			CallCallback(translationEvent);
+			AdvanceState(translationEvent);
+		}
+
+		void operator()(const std::span<const TranslationEvent> translationEvents) const
+		{
+			for (const auto& elem : translationEvents)
+				operator()(elem);
+		}
+
+		/**
+		 * \brief Calls the mapping's callback for the event's transition only, the mapping state is not touched.
+		 */
+		void CallCallback(const TranslationEvent& translationEvent) const
+		{
+			CallMappingCallback(m_mappings[translationEvent.MappingIndex], translationEvent.Transition);
+		}
+
+		/**
+		 * \brief Advances the mapping's state for the event's transition only, the callback is not called.
+		 */
+		void AdvanceState(const TranslationEvent& translationEvent) const noexcept
+		{
+			AdvanceMappingState(m_states[translationEvent.MappingIndex], translationEvent.Transition, translationEvent.TimePoint);
+		}
+	};
+
+	static_assert(std::copyable<TranslationEventDispatcher>);
+}
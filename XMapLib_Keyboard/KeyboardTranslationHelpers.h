@@ -8,11 +8,29 @@
 #include <type_traits>
 #include <span>
 #include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstdint>
 #include <map>
 
 namespace sds
 {
+	/**
+	 * \brief	The kind of state transition a translation performs for a mapping.
+	 */
+	enum class TransitionKind : std::uint8_t
+	{
+		KeyDown,
+		KeyUp,
+		KeyRepeat,
+		Reset // Up to initial, ready for another cycle.
+	};
+
+	// Order the transitions of an update are performed in, matches the call operator of TranslationPack.
+	inline constexpr std::array TransitionOrder{ TransitionKind::KeyUp, TransitionKind::KeyDown, TransitionKind::KeyRepeat, TransitionKind::Reset };
+	// Mask of the mappings performing each transition of an update, indexed by TransitionKind.
+	using TransitionMasks_t = std::array<keyboardtypes::DownMask_t, TransitionOrder.size()>;
+
 	/**
 	 * \brief	TranslationResult holds info from a translated state change, typically the operation to perform (if any) and
 	 *	a function to call to advance the state to the next state to continue to receive proper translation results.
@@ -64,6 +82,17 @@ namespace sds
 		keyboardtypes::SmallVector_t<TranslationResult> RepeatRequests{}; // repeats
 		keyboardtypes::SmallVector_t<TranslationResult> UpdateRequests{}; // resets
 		// TODO might wrap the vectors in a struct with a call operator to have individual call operators for range of TranslationResult.
+
+		/**
+		 * \brief Empties the pack, the capacity of the ranges is retained so that a re-used pack does not re-allocate.
+		 */
+		void Clear() noexcept
+		{
+			UpRequests.clear();
+			DownRequests.clear();
+			RepeatRequests.clear();
+			UpdateRequests.clear();
+		}
 	};
 
 	static_assert(std::copyable<TranslationPack>);
@@ -82,19 +111,78 @@ namespace sds
 			mappingElem.LastAction.DelayBeforeFirstRepeat.Reset(mappingElem.DelayBeforeFirstRepeat.value());
 	}
 
+	/**
+	 * \brief	Advances the mapping state to the state following the transition, resetting the timers the next transition waits on.
+	 *	This is what the <c>AdvanceStateFn</c> of a translation result performs, it may be called directly when not building translation results.
+	 * \param lastAction	The mapping state to advance.
+	 * \param transition	The transition that was performed.
+	 * \param timePoint	The time of the update that produced the transition.
+	 */
+	inline
+	void AdvanceMappingState(MappingStateManager& lastAction, const TransitionKind transition, const TimeManagement::TimePoint_t timePoint) noexcept
+	{
+		switch (transition)
+		{
+		case TransitionKind::KeyDown:
+			// Reset timer after activation, to wait for elapsed before another next state translation is returned.
+			lastAction.LastSentTime.Reset(timePoint);
+			lastAction.DelayBeforeFirstRepeat.Reset(timePoint);
+			lastAction.SetDown();
+			break;
+		case TransitionKind::KeyRepeat:
+			lastAction.LastSentTime.Reset(timePoint);
+			lastAction.SetRepeat();
+			break;
+		case TransitionKind::KeyUp:
+			lastAction.SetUp();
+			break;
+		case TransitionKind::Reset:
+			lastAction.SetInitial();
+			lastAction.LastSentTime.Reset(timePoint);
+			break;
+		}
+	}
+
+	inline
+	void AdvanceMappingState(CBActionMap& currentMapping, const TransitionKind transition, const TimeManagement::TimePoint_t timePoint) noexcept
+	{
+		AdvanceMappingState(currentMapping.LastAction, transition, timePoint);
+	}
+
+	/**
+	 * \brief	Calls the mapping's callback for the transition, if it has one.
+	 */
+	inline
+	void CallMappingCallback(const CBActionMap& currentMapping, const TransitionKind transition)
+	{
+		const auto CallIfSet = [](const keyboardtypes::Fn_t& fn) { if (fn) fn(); };
+		switch (transition)
+		{
+		case TransitionKind::KeyDown: CallIfSet(currentMapping.OnDown); break;
+		case TransitionKind::KeyRepeat: CallIfSet(currentMapping.OnRepeat); break;
+		case TransitionKind::KeyUp: CallIfSet(currentMapping.OnUp); break;
+		case TransitionKind::Reset: CallIfSet(currentMapping.OnReset); break;
+		}
+	}
+
+	/*
+	 *	Note: The translation results that reset a mapping's timers take the time point of the update that produced them, so that every transition
+	 *	in an update is judged against the same instant, and the clock is sampled once per update.
+	 *	The overloads taking the mapping state separately are for state held apart from the mapping (configuration), as with a shared
+	 *	<c>MappingProfile</c>. The operation calls the mapping's callback, the state advance operates on the state.
+	 */
+
 	[[nodiscard]]
 	inline
-	auto GetResetTranslationResult(CBActionMap& currentMapping) noexcept -> TranslationResult
+	auto GetResetTranslationResult(const CBActionMap& currentMapping, MappingStateManager& lastAction, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
 	{
 		return TranslationResult
 		{
 			.OperationToPerform = [&currentMapping]() {
-				if (currentMapping.OnReset)
-					currentMapping.OnReset();
+				CallMappingCallback(currentMapping, TransitionKind::Reset);
 			},
-			.AdvanceStateFn = [&currentMapping]() {
-				currentMapping.LastAction.SetInitial();
-				currentMapping.LastAction.LastSentTime.Reset();
+			.AdvanceStateFn = [&lastAction, timePoint]() {
+				AdvanceMappingState(lastAction, TransitionKind::Reset, timePoint);
 			},
 			.MappingVk = currentMapping.ButtonVirtualKeycode,
 			.ExclusivityGrouping = currentMapping.ExclusivityGrouping
@@ -103,23 +191,35 @@ namespace sds
 
 	[[nodiscard]]
 	inline
-	auto GetRepeatTranslationResult(CBActionMap& currentMapping) noexcept -> TranslationResult
+	auto GetResetTranslationResult(CBActionMap& currentMapping, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
+	{
+		return GetResetTranslationResult(currentMapping, currentMapping.LastAction, timePoint);
+	}
+
+	[[nodiscard]]
+	inline
+	auto GetRepeatTranslationResult(const CBActionMap& currentMapping, MappingStateManager& lastAction, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
 	{
 		return TranslationResult
 		{
 			.OperationToPerform = [&currentMapping]() {
-				if (currentMapping.OnRepeat)
-					currentMapping.OnRepeat();
-				currentMapping.LastAction.LastSentTime.Reset();
+				CallMappingCallback(currentMapping, TransitionKind::KeyRepeat);
 			},
-			.AdvanceStateFn = [&currentMapping]() {
-				currentMapping.LastAction.SetRepeat();
+			.AdvanceStateFn = [&lastAction, timePoint]() {
+				AdvanceMappingState(lastAction, TransitionKind::KeyRepeat, timePoint);
 			},
 			.MappingVk = currentMapping.ButtonVirtualKeycode,
 			.ExclusivityGrouping = currentMapping.ExclusivityGrouping
 		};
 	}
 
+	[[nodiscard]]
+	inline
+	auto GetRepeatTranslationResult(CBActionMap& currentMapping, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
+	{
+		return GetRepeatTranslationResult(currentMapping, currentMapping.LastAction, timePoint);
+	}
+
 	[[nodiscard]]
 	inline
 	auto GetOvertakenTranslationResult(CBActionMap& overtakenMapping) noexcept -> TranslationResult
@@ -128,8 +228,7 @@ namespace sds
 		{
 			.OperationToPerform = [&overtakenMapping]()
 			{
-				if (overtakenMapping.OnUp)
-					overtakenMapping.OnUp();
+				CallMappingCallback(overtakenMapping, TransitionKind::KeyUp);
 			},
 			.AdvanceStateFn = [&overtakenMapping]()
 			{
@@ -142,18 +241,17 @@ namespace sds
 
 	[[nodiscard]]
 	inline
-	auto GetKeyUpTranslationResult(CBActionMap& currentMapping) noexcept -> TranslationResult
+	auto GetKeyUpTranslationResult(const CBActionMap& currentMapping, MappingStateManager& lastAction) noexcept -> TranslationResult
 	{
 		return TranslationResult
 		{
 			.OperationToPerform = [&currentMapping]()
 			{
-				if (currentMapping.OnUp)
-					currentMapping.OnUp();
+				CallMappingCallback(currentMapping, TransitionKind::KeyUp);
 			},
-			.AdvanceStateFn = [&currentMapping]()
+			.AdvanceStateFn = [&lastAction]()
 			{
-				currentMapping.LastAction.SetUp();
+				lastAction.SetUp();
 			},
 			.MappingVk = currentMapping.ButtonVirtualKeycode,
 			.ExclusivityGrouping = currentMapping.ExclusivityGrouping
@@ -162,27 +260,37 @@ namespace sds
 
 	[[nodiscard]]
 	inline
-	auto GetInitialKeyDownTranslationResult(CBActionMap& currentMapping) noexcept -> TranslationResult
+	auto GetKeyUpTranslationResult(CBActionMap& currentMapping) noexcept -> TranslationResult
+	{
+		return GetKeyUpTranslationResult(currentMapping, currentMapping.LastAction);
+	}
+
+	[[nodiscard]]
+	inline
+	auto GetInitialKeyDownTranslationResult(const CBActionMap& currentMapping, MappingStateManager& lastAction, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
 	{
 		return TranslationResult
 		{
 			.OperationToPerform = [&currentMapping]()
 			{
-				if (currentMapping.OnDown)
-					currentMapping.OnDown();
-				// Reset timer after activation, to wait for elapsed before another next state translation is returned.
-				currentMapping.LastAction.LastSentTime.Reset();
-				currentMapping.LastAction.DelayBeforeFirstRepeat.Reset();
+				CallMappingCallback(currentMapping, TransitionKind::KeyDown);
 			},
-			.AdvanceStateFn = [&currentMapping]()
+			.AdvanceStateFn = [&lastAction, timePoint]()
 			{
-				currentMapping.LastAction.SetDown();
+				AdvanceMappingState(lastAction, TransitionKind::KeyDown, timePoint);
 			},
 			.MappingVk = currentMapping.ButtonVirtualKeycode,
 			.ExclusivityGrouping = currentMapping.ExclusivityGrouping
 		};
 	}
 
+	[[nodiscard]]
+	inline
+	auto GetInitialKeyDownTranslationResult(CBActionMap& currentMapping, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationResult
+	{
+		return GetInitialKeyDownTranslationResult(currentMapping, currentMapping.LastAction, timePoint);
+	}
+
 	/**
 	 * \brief	Checks a list of mappings for having multiple mappings mapped to a single controller button.
 	 * \param	mappingsList Span of controller button to action mappings.
@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "KeyboardCustomTypes.h"
+#include "KeyboardMappingProfile.h"
+#include "KeyboardSpscRing.h"
+#include "KeyboardTranslationEvents.h"
+#include "KeyboardTranslationHelpers.h"
+
+namespace sds
+{
+	/**
+	 * \brief	What <c>TranslationEventPipeline::Submit</c> does with an event when the ring is full.
+	 */
+	enum class RingFullPolicy : std::uint8_t
+	{
+		// Wait (yielding) for the executor to make room, the polling thread is held up.
+		Wait,
+		// Drop a repeat event's callback, the polling thread is not held up by repeats. The mapping state is still advanced. Key-down, key-up
+		// and reset events are never dropped, they wait as with <c>Wait</c>: a key sent down is always sent up.
+		Drop
+	};
+
+	/**
+	 * \brief	Counters of a <c>TranslationEventPipeline</c>.
+	 */
+	struct TranslationPipelineStats final
+	{
+		// Events submitted by the polling thread.
+		std::size_t SubmittedCount{};
+		// Event callbacks run by the executor thread.
+		std::size_t ExecutedCount{};
+		// Events that found the ring full (backpressure), whatever the policy.
+		std::size_t BackpressureCount{};
+		// Repeat events whose callback was dropped, with <c>RingFullPolicy::Drop</c>.
+		std::size_t OverflowCount{};
+	};
+
+	/**
+	 * \brief	Pipelined mode: the polling thread polls, filters and translates (producing <c>TranslationEvent</c>s), the mapping callbacks are run
+	 *	on a dedicated executor thread. The events are passed through a bounded lock-free SPSC ring, so polling cadence does not depend on callback cost.
+	 * \remarks On submit, the mapping state is advanced on the polling thread, the executor only calls the callbacks (read-only access to the shared
+	 *	<c>MappingProfile</c>). So the translator is only ever touched by the polling thread, and callbacks run in submit order, on one thread.
+	 *	<p>Submit must only be called from one thread. The events must come from a translator using the same profile as the pipeline.</p>
+	 *	<p><c>Stop()</c> (or the destructor) runs the callbacks of the events still in the ring before joining the executor thread.</p>
+	 */
+	template<std::size_t RingCapacity = 256>
+	class TranslationEventPipeline final
+	{
+		std::shared_ptr<const MappingProfile> m_profile;
+		SpscRing<TranslationEvent, RingCapacity> m_ring;
+		// Incremented by the polling thread (and Stop) to wake the executor, which waits on it when the ring is empty.
+		std::atomic<std::uint32_t> m_wakeSignal{};
+		std::atomic<std::size_t> m_submittedCount{};
+		std::atomic<std::size_t> m_executedCount{};
+		std::atomic<std::size_t> m_backpressureCount{};
+		std::atomic<std::size_t> m_overflowCount{};
+		RingFullPolicy m_policy{};
+		// Last member, started after everything it uses is constructed.
+		std::jthread m_executor;
+	public:
+		TranslationEventPipeline(const TranslationEventPipeline&) = delete;
+		auto operator=(const TranslationEventPipeline&) -> TranslationEventPipeline& = delete;
+
+		/**
+		 * \brief Ctor, starts the executor thread.
+		 * \param profile The mapping profile of the translator whose events are submitted.
+		 * \param policy What to do when the ring is full.
+		 * \exception std::runtime_error on null profile.
+		 */
+		explicit TranslationEventPipeline(std::shared_ptr<const MappingProfile> profile, const RingFullPolicy policy = RingFullPolicy::Wait)
+			: m_profile(std::move(profile)), m_policy(policy)
+		{
+			if (!m_profile)
+				throw std::runtime_error("Exception: Null mapping profile!");
+			m_executor = std::jthread{ [this](const std::stop_token stopToken) { ExecutorLoop(stopToken); } };
+		}
+
+		~TranslationEventPipeline()
+		{
+			Stop();
+		}
+
+		/**
+		 * \brief Polling thread only. Advances the mapping state for each event, and queues the event's callback for the executor thread.
+		 * \param dispatcher The event dispatcher of the translator that produced the events.
+		 * \param translationEvents The events of an update, in order.
+		 */
+		void Submit(const TranslationEventDispatcher& dispatcher, const std::span<const TranslationEvent> translationEvents) noexcept
+		{
+			if (translationEvents.empty())
+				return;
+			m_submittedCount.fetch_add(translationEvents.size(), std::memory_order_relaxed);
+			for (const auto& translationEvent : translationEvents)
+			{
+				dispatcher.AdvanceState(translationEvent);
+				if (m_ring.TryPush(translationEvent))
+					continue;
+
+				m_backpressureCount.fetch_add(1, std::memory_order_relaxed);
+				if (m_policy == RingFullPolicy::Drop && translationEvent.Transition == TransitionKind::KeyRepeat)
+				{
+					m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				// The executor may be waiting for a signal from before the ring filled.
+				WakeExecutor();
+				while (!m_ring.TryPush(translationEvent))
+					std::this_thread::yield();
+			}
+			WakeExecutor();
+		}
+
+		/**
+		 * \brief Runs the callbacks still queued, then stops and joins the executor thread. Events must not be submitted after stopping.
+		 */
+		void Stop() noexcept
+		{
+			if (!m_executor.joinable())
+				return;
+			m_executor.request_stop();
+			WakeExecutor();
+			m_executor.join();
+		}
+
+		[[nodiscard]]
+		auto GetStats() const noexcept -> TranslationPipelineStats
+		{
+			return TranslationPipelineStats
+			{
+				.SubmittedCount = m_submittedCount.load(std::memory_order_relaxed),
+				.ExecutedCount = m_executedCount.load(std::memory_order_relaxed),
+				.BackpressureCount = m_backpressureCount.load(std::memory_order_relaxed),
+				.OverflowCount = m_overflowCount.load(std::memory_order_relaxed)
+			};
+		}
+
+		[[nodiscard]]
+		auto GetProfile() const noexcept -> const std::shared_ptr<const MappingProfile>&
+		{
+			return m_profile;
+		}
+	private:
+		void WakeExecutor() noexcept
+		{
+			m_wakeSignal.fetch_add(1, std::memory_order_release);
+			m_wakeSignal.notify_one();
+		}
+
+		void ExecutorLoop(const std::stop_token stopToken)
+		{
+			while (true)
+			{
+				// Read before draining, a push after the drain changes the signal so the wait below returns.
+				const auto signal = m_wakeSignal.load(std::memory_order_acquire);
+				DrainRing();
+				if (stopToken.stop_requested())
+				{
+					DrainRing();
+					return;
+				}
+				m_wakeSignal.wait(signal, std::memory_order_acquire);
+			}
+		}
+
+		void DrainRing()
+		{
+			while (const auto translationEvent = m_ring.TryPop())
+			{
+				CallMappingCallback(m_profile->GetMappingAt(translationEvent->MappingIndex), translationEvent->Transition);
+				m_executedCount.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	};
+}
@@ -1,11 +1,20 @@
 #pragma once
+#include <array>
 #include <stdexcept>
 #include <concepts>
+#include <memory>
 #include <ranges>
+#include <span>
 #include <type_traits>
 
 #include "KeyboardCustomTypes.h"
+#include "KeyboardDeadlineQueue.h"
+#include "KeyboardKeyIndexMap.h"
+#include "KeyboardMappingProfile.h"
+#include "KeyboardMappingStateBlock.h"
+#include "KeyboardMappingStateStore.h"
 #include "KeyboardTranslationHelpers.h"
+#include "KeyboardTranslationEvents.h"
 #include "KeyboardOvertakingFilter.h"
 
 /*
@@ -30,104 +39,9 @@ namespace sds
 		{ std::ranges::random_access_range<T> == true };
 	};
 
-	// Concept for a filter class, used to apply a specific "overtaking" behavior (exclusivity grouping behavior) implementation.
-	template<typename FilterType_t>
-	concept ValidFilterType_c = requires(FilterType_t & t)
-	{
-		{ t.SetMappingRange(std::span<CBActionMap>{}) };
-		{ t.GetFilteredButtonState({1,2,3}) } -> std::convertible_to<keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>>;
-		{ std::movable<FilterType_t> == true };
-	};
-
-	/*
-	 *	NOTE: Testing these functions may be quite easy, pass a single CBActionMap in a certain state to all of these functions,
-	 *	and if more than one TranslationResult is produced (aside from perhaps the reset translation), then it would obviously be in error.
-	 */
-
-	/**
-	 * \brief For a single mapping, search the controller state update buffer and produce a TranslationResult appropriate to the current mapping state and controller state.
-	 * \param downKeys Wrapper class containing the results of a controller state update polling.
-	 * \param singleButton The mapping type for a single virtual key of the controller.
-	 * \returns Optional, <c>TranslationResult</c>
-	 */
-	[[nodiscard]]
-	inline
-	auto GetButtonTranslationForInitialToDown(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& downKeys, CBActionMap& singleButton) noexcept -> std::optional<TranslationResult>
-	{
-		using
-		std::ranges::find,
-		std::ranges::end;
-
-		if (singleButton.LastAction.IsInitialState())
-		{
-			const auto findResult = find(downKeys, singleButton.ButtonVirtualKeycode);
-			// If VK *is* found in the down list, create the down translation.
-			if(findResult != end(downKeys))
-				return GetInitialKeyDownTranslationResult(singleButton);
-		}
-		return {};
-	}
-
-	[[nodiscard]]
-	inline
-	auto GetButtonTranslationForDownToRepeat(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& downKeys, CBActionMap& singleButton) noexcept -> std::optional<TranslationResult>
-	{
-		using std::ranges::find, std::ranges::end;
-		const bool isDownAndUsesRepeat = singleButton.LastAction.IsDown() && (singleButton.UsesInfiniteRepeat || singleButton.SendsFirstRepeatOnly);
-		const bool isDelayElapsed = singleButton.LastAction.DelayBeforeFirstRepeat.IsElapsed();
-		if (isDownAndUsesRepeat && isDelayElapsed)
-		{
-			const auto findResult = find(downKeys, singleButton.ButtonVirtualKeycode);
-			// If VK *is* found in the down list, create the repeat translation.
-			if (findResult != end(downKeys))
-				return GetRepeatTranslationResult(singleButton);
-		}
-		return {};
-	}
-
-	[[nodiscard]]
-	inline
-	auto GetButtonTranslationForRepeatToRepeat(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& downKeys, CBActionMap& singleButton) noexcept -> std::optional<TranslationResult>
-	{
-		using std::ranges::find, std::ranges::end;
-		const bool isRepeatAndUsesInfinite = singleButton.LastAction.IsRepeating() && singleButton.UsesInfiniteRepeat;
-		if (isRepeatAndUsesInfinite && singleButton.LastAction.LastSentTime.IsElapsed())
-		{
-			const auto findResult = find(downKeys, singleButton.ButtonVirtualKeycode);
-			// If VK *is* found in the down list, create the repeat translation.
-			if (findResult != end(downKeys))
-				return GetRepeatTranslationResult(singleButton);
-		}
-		return {};
-	}
-
-	[[nodiscard]]
-	inline
-	auto GetButtonTranslationForDownOrRepeatToUp(const keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>& downKeys, CBActionMap& singleButton) noexcept -> std::optional<TranslationResult>
-	{
-		using std::ranges::find, std::ranges::end;
-		if (singleButton.LastAction.IsDown() || singleButton.LastAction.IsRepeating())
-		{
-			const auto findResult = find(downKeys, singleButton.ButtonVirtualKeycode);
-			// If VK is not found in the down list, create the up translation.
-			if(findResult == end(downKeys))
-				return GetKeyUpTranslationResult(singleButton);
-		}
-		return {};
-	}
-
-	// This is the reset translation
-	[[nodiscard]]
-	inline
-	auto GetButtonTranslationForUpToInitial(CBActionMap& singleButton) noexcept -> std::optional<TranslationResult>
-	{
-		// if the timer has elapsed, update back to the initial state.
-		if(singleButton.LastAction.IsUp() && singleButton.LastAction.LastSentTime.IsElapsed())
-		{
-			return GetResetTranslationResult(singleButton);
-		}
-		return {};
-	}
+	// A sink for the zero-allocation translation output, called with the virtual keycode of the mapping and the transition it performs.
+	template<typename Sink_t>
+	concept TranslationSink_c = std::invocable<Sink_t&, keyboardtypes::VirtualKey_t, TransitionKind>;
 
 	/**
 	 * \brief Encapsulates the mapping buffer, processes controller state updates, returns translation packs.
@@ -135,13 +49,29 @@ namespace sds
 	 *	make use of the <c>GetCleanupActions()</c> function. Not copyable. Is movable.
 	 *	<p></p>
 	 *	<p>An invariant exists such that: <b>There must be only one mapping per virtual keycode.</b></p>
+	 *	<p>The mappings (callbacks and configuration) are held in an immutable <c>MappingProfile</c> that may be shared by many translators, each
+	 *	translator holds only its own mapping state (<c>MappingStateBlock</c>). Constructing from a mapping vector makes a profile for the translator alone.</p>
+	 *	<p>Each mapping is assigned a dense index (its position in the mapping buffer) at construction, the 'down' state for an update is held
+	 *	as a bitmask of these indices. A poller may produce the mask directly with <c>GetKeyIndexMap()</c> and call <c>GetUpdatedStateFromMask(...)</c>.</p>
+	 *	<p>Only mappings that may transition are evaluated on an update: those with a changed down state, and those with a passed repeat/reset deadline
+	 *	in the translator's <c>DeadlineQueue</c>. Mappings that produced a translation are re-scheduled on the following update, after the translation has been performed.</p>
+	 *	<p>An update is evaluated against the <c>MappingStateStore</c>, a structure-of-arrays copy of the mappings' per-update state; the mapping structs
+	 *	and mapping state (callbacks, timers) are only touched to build translation results and to re-load the store for mappings that transitioned.</p>
+	 *	<p>The clock (<c>ClockPolicy_t::now()</c>) is sampled once per update, or the caller may provide the time point of the update.</p>
+	 *	<p>For allocation free output, the caller may own a <c>TranslationPack</c> that is re-used for every update (<c>FillUpdatedState...</c>), or provide
+	 *	a sink called with each transition (<c>VisitUpdatedStateFromMask</c>). With a filter, the filtering of the update may still allocate.</p>
+	 *	<p>In event mode (<c>FillUpdatedEventsFromMask</c>) the update produces plain <c>TranslationEvent</c> records, performed later by the
+	 *	dispatcher from <c>GetEventDispatcher()</c>.</p>
+	 *	<p>In pipelined mode the events are submitted to a <c>TranslationEventPipeline</c>, which runs the callbacks on its own executor thread.</p>
 	 */
-	template<ValidFilterType_c OvertakingFilter_t = KeyboardOvertakingFilter>
+	template<ValidFilterType_c OvertakingFilter_t = KeyboardOvertakingFilter, TimeManagement::IsClockPolicy ClockPolicy_t = TimeManagement::Clock_t>
 	class KeyboardTranslator final
 	{
 		using MappingVector_t = std::vector<CBActionMap>;
 		static_assert(MappingRange_c<MappingVector_t>);
-		MappingVector_t m_mappings;
+		std::shared_ptr<const MappingProfile> m_profile;
+		// Mapping state of this instance, and the per-update state an update is evaluated against.
+		MappingStateBlock m_state;
 		std::optional<OvertakingFilter_t> m_filter;
 	public:
 		KeyboardTranslator() = delete; // no default
@@ -155,15 +85,11 @@ namespace sds
 		/**
 		 * \brief Mapping Vector move Ctor, may throw on exclusivity group error, OR more than one mapping per VK.
 		 * \param keyMappings Rv ref to a mapping vector type.
-		 * \exception std::runtime_error on exclusivity group error during construction, OR more than one mapping per VK.
+		 * \exception std::runtime_error on exclusivity group error during construction, OR more than one mapping per VK, OR more than MaxMappingCount mappings.
 		 */
 		explicit KeyboardTranslator(MappingVector_t&& keyMappings )
-		: m_mappings(std::move(keyMappings))
+		: KeyboardTranslator(std::make_shared<const MappingProfile>(std::move(keyMappings)))
 		{
-			for (auto& e : m_mappings)
-				InitCustomTimers(e);
-			if (!AreMappingsUniquePerVk(m_mappings) || !AreMappingVksNonZero(m_mappings))
-				throw std::runtime_error("Exception: More than 1 mapping per VK!");
 		}
 
 		/**
@@ -173,13 +99,34 @@ namespace sds
 		 * \exception std::runtime_error on exclusivity group error during construction, OR more than one mapping per VK.
 		 */
 		KeyboardTranslator(MappingVector_t&& keyMappings, OvertakingFilter_t&& filter)
-			: m_mappings(std::move(keyMappings)), m_filter(std::move(filter))
+			: KeyboardTranslator(std::make_shared<const MappingProfile>(std::move(keyMappings)), std::move(filter))
+		{
+		}
+
+		/**
+		 * \brief Shared profile Ctor, the translator holds only its own mapping state.
+		 * \param profile The mapping profile, shared with any other translators using it.
+		 * \exception std::runtime_error on null profile.
+		 */
+		explicit KeyboardTranslator(std::shared_ptr<const MappingProfile> profile)
+			: m_profile(std::move(profile))
 		{
-			for (auto& e : m_mappings)
-				InitCustomTimers(e);
-			if (!AreMappingsUniquePerVk(m_mappings) || !AreMappingVksNonZero(m_mappings))
-				throw std::runtime_error("Exception: More than 1 mapping per VK!");
-			m_filter->SetMappingRange(m_mappings);
+			if (!m_profile)
+				throw std::runtime_error("Exception: Null mapping profile!");
+			m_state = MappingStateBlock{ *m_profile };
+		}
+
+		/**
+		 * \brief Shared profile Ctor used with adding a filter, note the filter is expected to be std::move'd in.
+		 * \param profile The mapping profile, shared with any other translators using it.
+		 * \param filter Rv ref to a filter type.
+		 * \exception std::runtime_error on null profile.
+		 */
+		KeyboardTranslator(std::shared_ptr<const MappingProfile> profile, OvertakingFilter_t&& filter)
+			: KeyboardTranslator(std::move(profile))
+		{
+			m_filter.emplace(std::move(filter));
+			m_filter->SetMappingRange(m_profile->GetMappings());
 		}
 	public:
 		[[nodiscard]]
@@ -188,52 +135,249 @@ namespace sds
 			return GetUpdatedState(std::move(stateUpdate));
 		}
 
+		/**
+		 * \brief Overload taking the time point of the update, see <c>FillUpdatedState</c> taking a span.
+		 */
+		[[nodiscard]]
+		auto operator()(const std::span<const keyboardtypes::VirtualKey_t> stateUpdate, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationPack
+		{
+			TranslationPack translations;
+			FillUpdatedState(stateUpdate, timePoint, translations);
+			return translations;
+		}
+
 		[[nodiscard]]
 		auto GetUpdatedState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate) noexcept -> TranslationPack
 		{
-			auto stateUpdateFiltered = m_filter.has_value() ? m_filter->GetFilteredButtonState(std::move(stateUpdate)) : std::move(stateUpdate);
+			return GetUpdatedState(std::move(stateUpdate), ClockPolicy_t::now());
+		}
 
+		/**
+		 * \brief Overload taking the time point of the update, every transition in the update is judged against it and the clock is not sampled.
+		 * \param stateUpdate The 'down' virtual keycodes.
+		 * \param timePoint The time of the update.
+		 */
+		[[nodiscard]]
+		auto GetUpdatedState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationPack
+		{
 			TranslationPack translations;
-			for(auto& mapping : m_mappings)
+			FillUpdatedState(std::move(stateUpdate), timePoint, translations);
+			return translations;
+		}
+
+		/**
+		 * \brief Overload filling a caller-owned translation pack, which is cleared first. Re-using the pack for each update avoids allocating the translation ranges.
+		 * \param stateUpdate The 'down' virtual keycodes.
+		 * \param timePoint The time of the update.
+		 * \param translations [out] The translation pack to fill.
+		 */
+		void FillUpdatedState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>&& stateUpdate, const TimeManagement::TimePoint_t timePoint, TranslationPack& translations) noexcept
+		{
+			auto stateUpdateFiltered = m_filter.has_value() ? m_filter->GetFilteredButtonState(std::move(stateUpdate)) : std::move(stateUpdate);
+			FillTranslationsForMask(GetKeyIndexMap().GetDownMask(stateUpdateFiltered), timePoint, translations);
+		}
+
+		/**
+		 * \brief Overload taking a view of the update, as with a recorded update that is not the translator's to consume. With a filter that
+		 *	filters the down mask (or no filter) the update is not copied, it is translated on the mask update path, the down VKs in mapping order.
+		 * \param stateUpdate The 'down' virtual keycodes.
+		 * \param timePoint The time of the update.
+		 * \param translations [out] The translation pack to fill.
+		 */
+		void FillUpdatedState(const std::span<const keyboardtypes::VirtualKey_t> stateUpdate, const TimeManagement::TimePoint_t timePoint, TranslationPack& translations) noexcept
+		{
+			if constexpr (!DownMaskFilterType_c<OvertakingFilter_t>)
 			{
-				if (const auto upToInitial = GetButtonTranslationForUpToInitial(mapping))
-				{
-					translations.UpdateRequests.emplace_back(*upToInitial);
-				}
-				else if (const auto initialToDown = GetButtonTranslationForInitialToDown(stateUpdateFiltered, mapping))
+				// The filter consumes the VK range.
+				if (m_filter.has_value())
 				{
-					// Advance to next state.
-					translations.DownRequests.emplace_back(*initialToDown);
-				}
-				else if (const auto downToFirstRepeat = GetButtonTranslationForDownToRepeat(stateUpdateFiltered, mapping))
-				{
-					translations.RepeatRequests.emplace_back(*downToFirstRepeat);
-				}
-				else if (const auto repeatToRepeat = GetButtonTranslationForRepeatToRepeat(stateUpdateFiltered, mapping))
-				{
-					translations.RepeatRequests.emplace_back(*repeatToRepeat);
-				}
-				else if (const auto repeatToUp = GetButtonTranslationForDownOrRepeatToUp(stateUpdateFiltered, mapping))
-				{
-					translations.UpRequests.emplace_back(*repeatToUp);
+					FillUpdatedState(keyboardtypes::SmallVector_t<keyboardtypes::VirtualKey_t>(stateUpdate.begin(), stateUpdate.end()), timePoint, translations);
+					return;
 				}
 			}
+			FillUpdatedStateFromMask(GetKeyIndexMap().GetDownMask(stateUpdate), timePoint, translations);
+		}
+
+		/**
+		 * \brief Used with a poller that produces the down mask directly, see <c>GetKeyIndexMap()</c>.
+		 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+		 */
+		[[nodiscard]]
+		auto GetUpdatedStateFromMask(const keyboardtypes::DownMask_t& downMask) noexcept -> TranslationPack
+		{
+			return GetUpdatedStateFromMask(downMask, ClockPolicy_t::now());
+		}
+
+		[[nodiscard]]
+		auto GetUpdatedStateFromMask(const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint) noexcept -> TranslationPack
+		{
+			TranslationPack translations;
+			FillUpdatedStateFromMask(downMask, timePoint, translations);
 			return translations;
 		}
 
+		/**
+		 * \brief Overload filling a caller-owned translation pack, which is cleared first. Re-using the pack for each update avoids allocating the translation ranges.
+		 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+		 * \param timePoint The time of the update.
+		 * \param translations [out] The translation pack to fill.
+		 */
+		void FillUpdatedStateFromMask(const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint, TranslationPack& translations) noexcept
+		{
+			FillTranslationsForMask(GetFilteredMask(downMask), timePoint, translations);
+		}
+
+		/**
+		 * \brief Visits each transition of the update with the sink, no translation results are built. The sink is called with the virtual keycode of
+		 *	the mapping and the transition, in the same order as the call operator of the translation pack (key-ups, key-downs, repeats, resets).
+		 * \remarks The sink takes the place of performing a translation result: the mapping's own callbacks are <b>not</b> called, and the mapping's
+		 *	state is advanced as soon as the sink returns.
+		 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+		 * \param timePoint The time of the update.
+		 * \param sink Called with (virtual keycode, transition kind) for each transition.
+		 */
+		template<TranslationSink_c Sink_t>
+		void VisitUpdatedStateFromMask(const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint, Sink_t&& sink)
+		{
+			const auto transitionMasks = m_state.GetTransitionMasks(*m_profile, GetFilteredMask(downMask), timePoint);
+			for (const auto transition : TransitionOrder)
+			{
+				ForEachSetBit(transitionMasks[static_cast<std::size_t>(transition)], [&](const keyboardtypes::Index_t i)
+				{
+					sink(m_profile->GetMappingAt(i).ButtonVirtualKeycode, transition);
+					m_state.Advance(i, transition, timePoint);
+				});
+			}
+		}
+
+		/**
+		 * \brief Event mode, fills a caller-owned buffer (cleared first) with a <c>TranslationEvent</c> for each transition, in the same order as the
+		 *	call operator of the translation pack. The events are performed with the dispatcher from <c>GetEventDispatcher()</c>, before the next update.
+		 * \param downMask Bitmask of 'down' mappings, indexed by the dense mapping index.
+		 * \param timePoint The time of the update.
+		 * \param translationEvents [out] The event buffer to fill.
+		 */
+		void FillUpdatedEventsFromMask(const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint, TranslationEventBuffer_t& translationEvents) noexcept
+		{
+			m_state.FillTranslationEvents(*m_profile, GetFilteredMask(downMask), timePoint, translationEvents);
+		}
+
+		/**
+		 * \brief Dispatcher for the events produced by <c>FillUpdatedEventsFromMask</c>, calls the mapping callbacks and advances the mapping state.
+		 */
+		[[nodiscard]]
+		auto GetEventDispatcher() noexcept -> TranslationEventDispatcher
+		{
+			return TranslationEventDispatcher{ m_profile->GetMappings(), m_state.GetMappingStates() };
+		}
+
+		/**
+		 * \brief The VK to dense index mapping used by this translator, for pollers producing the down mask directly.
+		 */
+		[[nodiscard]]
+		auto GetKeyIndexMap() const noexcept -> const KeyIndexMap&
+		{
+			return m_profile->GetKeyIndexMap();
+		}
+
+		/**
+		 * \brief The (possibly shared) mapping profile of this translator.
+		 */
+		[[nodiscard]]
+		auto GetProfile() const noexcept -> const std::shared_ptr<const MappingProfile>&
+		{
+			return m_profile;
+		}
+
+		/**
+		 * \brief The mapping state of this translator for the mapping index.
+		 */
+		[[nodiscard]]
+		auto GetMappingState(const keyboardtypes::Index_t index) const noexcept -> const MappingStateManager&
+		{
+			return m_state.GetMappingState(index);
+		}
+
 		[[nodiscard]]
 		auto GetCleanupActions() noexcept -> keyboardtypes::SmallVector_t<TranslationResult>
 		{
 			keyboardtypes::SmallVector_t<TranslationResult> translations;
-			for(auto & mapping : m_mappings)
+			const auto states = m_state.GetMappingStates();
+			ForEachSetBit(m_state.GetCleanupMask(), [&](const keyboardtypes::Index_t i)
 			{
-				if(DoesMappingNeedCleanup(mapping.LastAction))
-				{
-					translations.emplace_back(GetKeyUpTranslationResult(mapping));
-				}
-			}
+				translations.emplace_back(GetKeyUpTranslationResult(m_profile->GetMappingAt(i), states[i]));
+				m_state.MarkPending(i);
+			});
 			return translations;
 		}
+
+		/**
+		 * \brief Returns the time point of the earliest pending repeat or reset transition (plus the coalescing slack), an update after this time
+		 *	point will perform it. Returns nothing if every mapping is idle, in which case only a change in the controller state produces a transition.
+		 * \remarks The translations of the last update should be performed before calling, as the mappings that transitioned are re-scheduled here.
+		 *	A driver loop may sleep until the earlier of this and its next poll, rather than for a fixed period.
+		 */
+		[[nodiscard]]
+		auto GetNextDeadline() noexcept -> std::optional<TimeManagement::TimePoint_t>
+		{
+			return m_state.GetNextDeadline(*m_profile);
+		}
+
+		/**
+		 * \brief True when an update at the time point with the last update's down mask would produce no transition: the filter is settled, the
+		 *	mapping states match the filtered mask and no repeat/reset deadline has passed. A driver loop may then skip the update (and the state decoding, if the input is known to be unchanged).
+		 * \remarks As with <c>GetNextDeadline</c>, the translations of the last update should be performed before calling. A filter that does not
+		 *	satisfy <c>SettlingFilterType_c</c> is assumed not settled, the translator is then never idle.
+		 */
+		[[nodiscard]]
+		auto IsIdleAt(const TimeManagement::TimePoint_t timePoint) noexcept -> bool
+		{
+			return IsFilterSettled() && m_state.IsIdleAt(*m_profile, timePoint);
+		}
+
+		/**
+		 * \brief Sets the timer coalescing slack, the amount of time a repeat/reset deadline may be serviced late so that deadlines falling close together
+		 *	are serviced in the same update. Defaults to zero.
+		 */
+		void SetTimerCoalescingSlack(const TimeManagement::Nanos_t slack) noexcept
+		{
+			m_state.SetTimerCoalescingSlack(slack);
+		}
+
+	private:
+		[[nodiscard]]
+		auto IsFilterSettled() const noexcept -> bool
+		{
+			if constexpr (SettlingFilterType_c<OvertakingFilter_t>)
+				return !m_filter.has_value() || m_filter->IsSettled();
+			else
+				return !m_filter.has_value();
+		}
+
+		[[nodiscard]]
+		auto GetFilteredMask(const keyboardtypes::DownMask_t& downMask) -> keyboardtypes::DownMask_t
+		{
+			return GetFilteredDownMask(m_filter, GetKeyIndexMap(), downMask);
+		}
+
+		void FillTranslationsForMask(const keyboardtypes::DownMask_t& downMask, const TimeManagement::TimePoint_t timePoint, TranslationPack& translations) noexcept
+		{
+			translations.Clear();
+			const auto transitionMasks = m_state.GetTransitionMasks(*m_profile, downMask, timePoint);
+			const auto states = m_state.GetMappingStates();
+			const auto AddTranslations = [&](const TransitionKind transition, auto& translationRange, const auto& getTranslation)
+			{
+				ForEachSetBit(transitionMasks[static_cast<std::size_t>(transition)], [&](const keyboardtypes::Index_t i)
+				{
+					translationRange.emplace_back(getTranslation(m_profile->GetMappingAt(i), states[i]));
+				});
+			};
+			using State_t = MappingStateManager;
+			AddTranslations(TransitionKind::KeyUp, translations.UpRequests, [](const CBActionMap& mapping, State_t& state) { return GetKeyUpTranslationResult(mapping, state); });
+			AddTranslations(TransitionKind::KeyDown, translations.DownRequests, [timePoint](const CBActionMap& mapping, State_t& state) { return GetInitialKeyDownTranslationResult(mapping, state, timePoint); });
+			AddTranslations(TransitionKind::KeyRepeat, translations.RepeatRequests, [timePoint](const CBActionMap& mapping, State_t& state) { return GetRepeatTranslationResult(mapping, state, timePoint); });
+			AddTranslations(TransitionKind::Reset, translations.UpdateRequests, [timePoint](const CBActionMap& mapping, State_t& state) { return GetResetTranslationResult(mapping, state, timePoint); });
+		}
 	};
 
 	static_assert(InputTranslator_c<KeyboardTranslator<>>);
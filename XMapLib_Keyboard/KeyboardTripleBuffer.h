@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace sds
+{
+	/**
+	 * \brief	Wait-free latest-value triple buffer, for one writer thread and one reader thread.
+	 * \remarks The writer fills its back slot and publishes it by swapping it with the middle slot, the reader takes the middle slot by swapping
+	 *	it with its front slot, only if it holds a value newer than the last one taken. Values published between two reads are overwritten, so the
+	 *	reader always sees the newest value and never a stale queued one. Neither side ever waits for the other. Not copyable or movable.
+	 */
+	template<std::copyable Value_t>
+	class TripleBuffer final
+	{
+		static constexpr std::uint8_t IndexMask{ 0b011 };
+		// Set in the middle index when the middle slot holds a value not yet taken by the reader.
+		static constexpr std::uint8_t FreshBit{ 0b100 };
+		static constexpr std::size_t CacheLineSize{ 64 };
+
+		struct alignas(CacheLineSize) Slot_t final
+		{
+			Value_t Value{};
+		};
+
+		std::array<Slot_t, 3> m_slots{};
+		alignas(CacheLineSize) std::atomic<std::uint8_t> m_middle{ 1 };
+		// Writer only.
+		alignas(CacheLineSize) std::uint8_t m_back{ 0 };
+		// Reader only.
+		alignas(CacheLineSize) std::uint8_t m_front{ 2 };
+	public:
+		TripleBuffer() = default;
+		TripleBuffer(const TripleBuffer&) = delete;
+		auto operator=(const TripleBuffer&) -> TripleBuffer& = delete;
+
+		/**
+		 * \brief Writer only. The back slot, to be filled before <c>Publish()</c>.
+		 */
+		[[nodiscard]]
+		auto GetWriteSlot() noexcept -> Value_t&
+		{
+			return m_slots[m_back].Value;
+		}
+
+		/**
+		 * \brief Writer only. Publishes the back slot as the newest value.
+		 */
+		void Publish() noexcept
+		{
+			const auto oldMiddle = m_middle.exchange(static_cast<std::uint8_t>(m_back | FreshBit), std::memory_order_acq_rel);
+			m_back = oldMiddle & IndexMask;
+		}
+
+		/**
+		 * \brief Writer only. Copies the value to the back slot and publishes it.
+		 */
+		void Publish(const Value_t& value) noexcept(std::is_nothrow_copy_assignable_v<Value_t>)
+		{
+			GetWriteSlot() = value;
+			Publish();
+		}
+
+		/**
+		 * \brief Reader only. Takes the newest published value into the read slot, if one was published since the last call.
+		 * \return True if the read slot was updated.
+		 */
+		auto Consume() noexcept -> bool
+		{
+			if (!(m_middle.load(std::memory_order_relaxed) & FreshBit))
+				return false;
+			const auto oldMiddle = m_middle.exchange(m_front, std::memory_order_acq_rel);
+			m_front = oldMiddle & IndexMask;
+			return true;
+		}
+
+		/**
+		 * \brief Reader only. The value taken by the last successful <c>Consume()</c>, or a value-initialized one before that.
+		 */
+		[[nodiscard]]
+		auto GetReadSlot() const noexcept -> const Value_t&
+		{
+			return m_slots[m_front].Value;
+		}
+	};
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "KeyboardControllerState.h"
+#include "KeyboardCustomTypes.h"
+
+namespace sds
+{
+	/**
+	 * \brief	Counts of the polls seen by an <c>UnchangedInputGate</c>, the hit rate of the fast path is the sum of the skip counts over the poll count.
+	 */
+	struct UnchangedInputStats final
+	{
+		// Polls seen by the gate.
+		std::size_t PollCount{};
+		// Polls skipped without decoding, the packet number was that of the last translated state.
+		std::size_t PacketSkipCount{};
+		// Polls decoded but not translated, the down mask was that of the last translated state.
+		std::size_t DownMaskSkipCount{};
+	};
+
+	/**
+	 * \brief	Skip-unchanged fast path of a driver loop: a polled state that is the last translated one, while the translator is idle, is neither
+	 *	decoded nor translated.
+	 * \remarks For a backend that provides a packet number (XInput does, it changes when the state changes) an unchanged packet number skips the
+	 *	decoding too, otherwise each poll is decoded and the down mask compared with the last translated one. Skipping is exact, the translator would
+	 *	produce no transition for the update: the translator must be idle, see <c>KeyboardTranslator::IsIdleAt</c>.
+	 *	<p>Every update of the translator must go through the gate, <c>Reset</c> it when the translator or the settings are replaced.</p>
+	 */
+	class UnchangedInputGate final
+	{
+		std::optional<std::uint32_t> m_lastPacketNumber;
+		std::optional<keyboardtypes::DownMask_t> m_lastDownMask;
+		UnchangedInputStats m_stats;
+		bool m_hasPacketNumbers{ true };
+	public:
+		UnchangedInputGate() = default;
+
+		/**
+		 * \param hasPacketNumbers False for a backend that does not provide a packet number, each poll is then decoded.
+		 */
+		explicit UnchangedInputGate(const bool hasPacketNumbers) noexcept : m_hasPacketNumbers(hasPacketNumbers) { }
+
+		/**
+		 * \brief Returns the down mask to translate for the polled state, or nothing when the update can be skipped.
+		 * \param state The polled state.
+		 * \param isTranslatorIdle The result of the translator's <c>IsIdleAt</c> for the update's time point.
+		 * \param decode Decodes the state to the translator's down mask, called unless the packet number is unchanged.
+		 */
+		template<std::invocable<const ControllerState&> Decode_t>
+		[[nodiscard]]
+		auto GetChangedDownMask(const ControllerState& state, const bool isTranslatorIdle, Decode_t&& decode) -> std::optional<keyboardtypes::DownMask_t>
+		{
+			++m_stats.PollCount;
+			if (isTranslatorIdle && m_hasPacketNumbers && m_lastPacketNumber == state.PacketNumber)
+			{
+				++m_stats.PacketSkipCount;
+				return {};
+			}
+			const keyboardtypes::DownMask_t downMask = decode(state);
+			// Either translated, or the same down mask as the last translated state.
+			m_lastPacketNumber = state.PacketNumber;
+			if (isTranslatorIdle && m_lastDownMask == downMask)
+			{
+				++m_stats.DownMaskSkipCount;
+				return {};
+			}
+			m_lastDownMask = downMask;
+			return downMask;
+		}
+
+		/**
+		 * \brief Forgets the last translated state, the next poll is decoded and translated.
+		 */
+		void Reset() noexcept
+		{
+			m_lastPacketNumber.reset();
+			m_lastDownMask.reset();
+		}
+
+		[[nodiscard]]
+		auto GetStats() const noexcept -> const UnchangedInputStats&
+		{
+			return m_stats;
+		}
+	};
+
+	static_assert(std::copyable<UnchangedInputGate>);
+	static_assert(std::movable<UnchangedInputGate>);
+}
@@ -4,250 +4,257 @@
 #include "ControllerButtonToActionMap.h"
 #include "KeyboardTranslator.h"
 #include "KeyboardLegacyApiFunctions.h"
+#include "KeyboardStateDecoder.h"
 #include "KeyboardOvertakingFilter.h"
+#include "KeyboardTranslationPipeline.h"
+#include "KeyboardLatestValuePoller.h"
+#include "KeyboardUnchangedInputGate.h"
+#include "KeyboardConnectionMonitor.h"
 #include "../XMapLib_Utils/nanotime.h"
 #include "../XMapLib_Utils/SendMouseInput.h"
 #include "../XMapLib_Utils/ControllerStatus.h"
 
 #include <iostream>
+#include <format>
 #include <print>
 #include <chrono>
+#include <optional>
 
 // Crude mechanism to keep the loop running until [enter] is pressed.
 struct GetterExitCallable final
 {
-    std::atomic<bool> IsDone{ false };
-    void GetExitSignal()
-    {
-        std::string buf;
-        std::getline(std::cin, buf);
-        IsDone.store(true, std::memory_order_relaxed);
-    }
+	std::atomic<bool> IsDone{ false };
+	void GetExitSignal()
+	{
+		std::string buf;
+		std::getline(std::cin, buf);
+		IsDone.store(true, std::memory_order_relaxed);
+	}
 };
 
 auto GetEpochTimestamp()
 {
-    const auto currentTime = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::seconds>(currentTime.time_since_epoch());
+	const auto currentTime = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::seconds>(currentTime.time_since_epoch());
 }
 
 auto GetDriverButtonMappings()
 {
-    using std::vector, sds::CBActionMap, std::cout;
-    using namespace std::chrono_literals;
-    using namespace sds;
-
-    constexpr int PadButtonsGroup = 111; // Buttons exclusivity grouping.
-    constexpr int LeftThumbGroup = 101; // Left thumbstick exclusivity grouping.
-    const auto PrintMessageAndTime = [](std::string_view msg)
-    {
-        cout << msg << " @" << GetEpochTimestamp() << '\n';
-    };
-    const auto GetDownLambdaForKeyNamed = [=](const std::string& keyName)
+	using std::vector, sds::CBActionMap, std::cout;
+	using namespace std::chrono_literals;
+	using namespace sds;
+
+	constexpr int PadButtonsGroup = 111; // Buttons exclusivity grouping.
+	constexpr int LeftThumbGroup = 101; // Left thumbstick exclusivity grouping.
+	const auto PrintMessageAndTime = [](std::string_view msg)
+	{
+		cout << msg << " @" << GetEpochTimestamp() << '\n';
+	};
+	const auto GetDownLambdaForKeyNamed = [=](const std::string& keyName)
+	{
+		return [=]() { PrintMessageAndTime(keyName + "=[DOWN]"); };
+	};
+	const auto GetUpLambdaForKeyNamed = [=](const std::string& keyName)
+	{
+		return [=]() { PrintMessageAndTime(keyName + "=[UP]"); };
+	};
+	const auto GetRepeatLambdaForKeyNamed = [=](const std::string& keyName)
+	{
+		return [=]() { PrintMessageAndTime(keyName + "=[REPEAT]"); };
+	};
+	const auto GetResetLambdaForKeyNamed = [=](const std::string& keyName)
+	{
+		return [=]() { PrintMessageAndTime(keyName + "=[RESET]"); };
+	};
+
+	const auto GetBuiltMapForKeyNamed = [&](const std::string & keyName, const auto virtualKey, const int exGroup, const auto firstDelay)
 	{
-        return [=]() { PrintMessageAndTime(keyName + "=[DOWN]"); };
-    };
-    const auto GetUpLambdaForKeyNamed = [=](const std::string& keyName)
-    {
-        return [=]() { PrintMessageAndTime(keyName + "=[UP]"); };
-    };
-    const auto GetRepeatLambdaForKeyNamed = [=](const std::string& keyName)
-    {
-        return [=]() { PrintMessageAndTime(keyName + "=[REPEAT]"); };
-    };
-    const auto GetResetLambdaForKeyNamed = [=](const std::string& keyName)
-    {
-        return [=]() { PrintMessageAndTime(keyName + "=[RESET]"); };
-    };
-
-    const auto GetBuiltMapForKeyNamed = [&](const std::string & keyName, const auto virtualKey, const int exGroup, const auto firstDelay)
-    {
-        return CBActionMap
-        {
-            .ButtonVirtualKeycode = virtualKey,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = exGroup,
-            .OnDown = GetDownLambdaForKeyNamed(keyName),
-            .OnUp = GetUpLambdaForKeyNamed(keyName),
-            .OnRepeat = GetRepeatLambdaForKeyNamed(keyName),
-            .OnReset = GetResetLambdaForKeyNamed(keyName),
-            .DelayBeforeFirstRepeat = firstDelay
-        };
-    };
-
-    KeyboardSettings ksp;
-
-    vector mapBuffer
-    {
-        // Pad buttons
-        GetBuiltMapForKeyNamed("[PAD_A]", ksp.ButtonA, PadButtonsGroup, 500ms),
-        GetBuiltMapForKeyNamed("[PAD_B]", ksp.ButtonB, PadButtonsGroup, 500ms),
-        GetBuiltMapForKeyNamed("[PAD_X]", ksp.ButtonX, PadButtonsGroup, 500ms),
-        GetBuiltMapForKeyNamed("[PAD_Y]", ksp.ButtonY, PadButtonsGroup, 500ms),
-        // Left thumbstick directional stuff
-        GetBuiltMapForKeyNamed("[LTHUMB_UP]", ksp.LeftThumbstickUp, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_DOWN]", ksp.LeftThumbstickDown, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_RIGHT]", ksp.LeftThumbstickRight, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_LEFT]", ksp.LeftThumbstickLeft, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_DOWN_RIGHT]", ksp.LeftThumbstickDownRight, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_DOWN_LEFT]", ksp.LeftThumbstickDownLeft, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_UP_RIGHT]", ksp.LeftThumbstickUpRight, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTHUMB_UP_LEFT]", ksp.LeftThumbstickUpLeft, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[LTRIGGER]", ksp.LeftTrigger, LeftThumbGroup, 500ms),
-        GetBuiltMapForKeyNamed("[RTRIGGER]", ksp.RightTrigger, LeftThumbGroup, 500ms),
-        // Shoulder buttons
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.ButtonShoulderRight,
-            .UsesInfiniteRepeat = false,
-            .OnDown = []() { system("cls"); std::cout << "Cleared.\n"; }
-        },
-    	CBActionMap{
-            .ButtonVirtualKeycode = ksp.ButtonShoulderLeft,
-            .UsesInfiniteRepeat = false,
-            .OnDown = []()
-            {
-                // Add impl for something to do here
-            }
-        },
-    };
-
-    return mapBuffer;
+		return CBActionMap
+		{
+			.ButtonVirtualKeycode = virtualKey,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = exGroup,
+			.OnDown = GetDownLambdaForKeyNamed(keyName),
+			.OnUp = GetUpLambdaForKeyNamed(keyName),
+			.OnRepeat = GetRepeatLambdaForKeyNamed(keyName),
+			.OnReset = GetResetLambdaForKeyNamed(keyName),
+			.DelayBeforeFirstRepeat = firstDelay
+		};
+	};
+
+	KeyboardSettings ksp;
+
+	vector mapBuffer
+	{
+		// Pad buttons
+		GetBuiltMapForKeyNamed("[PAD_A]", ksp.ButtonA, PadButtonsGroup, 500ms),
+		GetBuiltMapForKeyNamed("[PAD_B]", ksp.ButtonB, PadButtonsGroup, 500ms),
+		GetBuiltMapForKeyNamed("[PAD_X]", ksp.ButtonX, PadButtonsGroup, 500ms),
+		GetBuiltMapForKeyNamed("[PAD_Y]", ksp.ButtonY, PadButtonsGroup, 500ms),
+		// Left thumbstick directional stuff
+		GetBuiltMapForKeyNamed("[LTHUMB_UP]", ksp.LeftThumbstickUp, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_DOWN]", ksp.LeftThumbstickDown, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_RIGHT]", ksp.LeftThumbstickRight, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_LEFT]", ksp.LeftThumbstickLeft, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_DOWN_RIGHT]", ksp.LeftThumbstickDownRight, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_DOWN_LEFT]", ksp.LeftThumbstickDownLeft, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_UP_RIGHT]", ksp.LeftThumbstickUpRight, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTHUMB_UP_LEFT]", ksp.LeftThumbstickUpLeft, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[LTRIGGER]", ksp.LeftTrigger, LeftThumbGroup, 500ms),
+		GetBuiltMapForKeyNamed("[RTRIGGER]", ksp.RightTrigger, LeftThumbGroup, 500ms),
+		// Shoulder buttons
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.ButtonShoulderRight,
+			.UsesInfiniteRepeat = false,
+			.OnDown = []() { system("cls"); std::cout << "Cleared.\n"; }
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.ButtonShoulderLeft,
+			.UsesInfiniteRepeat = false,
+			.OnDown = []()
+			{
+				// Add impl for something to do here
+			}
+		},
+	};
+
+	return mapBuffer;
 }
 
 auto GetDriverMouseMappings()
 {
-    using std::vector, std::cout;
-    using namespace std::chrono_literals;
-    using namespace sds;
-    static constexpr KeyboardSettings ksp{};
-    constexpr auto FirstDelay = 0ns; // mouse move delays
-    constexpr auto RepeatDelay = 1200us;
-    constexpr int MouseExGroup = 102;
-
-    vector mapBuffer
-    {
-        // Mouse move stuff
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickUp,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(0, 1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(0, 1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickUpRight,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(1, 1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(1, 1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickUpLeft,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(-1, 1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(-1, 1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickDown,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(0, -1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(0, -1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickLeft,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(-1, 0);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(-1, 0);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickRight,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(1, 0);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(1, 0);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickDownRight,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(1, -1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(1, -1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-        CBActionMap{
-            .ButtonVirtualKeycode = ksp.RightThumbstickDownLeft,
-            .UsesInfiniteRepeat = true,
-            .ExclusivityGrouping = MouseExGroup,
-            .OnDown = []()
-            {
-                Utilities::SendMouseMove(-1, -1);
-            },
-            .OnRepeat = []()
-            {
-                Utilities::SendMouseMove(-1, -1);
-            },
-            .DelayBeforeFirstRepeat = FirstDelay,
-            .DelayForRepeats = RepeatDelay
-        },
-    };
+	using std::vector, std::cout;
+	using namespace std::chrono_literals;
+	using namespace sds;
+	static constexpr KeyboardSettings ksp{};
+	constexpr auto FirstDelay = 0ns; // mouse move delays
+	constexpr auto RepeatDelay = 1200us;
+	constexpr int MouseExGroup = 102;
+
+	vector mapBuffer
+	{
+		// Mouse move stuff
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickUp,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(0, 1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(0, 1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickUpRight,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(1, 1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(1, 1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickUpLeft,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(-1, 1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(-1, 1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickDown,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(0, -1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(0, -1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickLeft,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(-1, 0);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(-1, 0);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickRight,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(1, 0);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(1, 0);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickDownRight,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(1, -1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(1, -1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+		CBActionMap{
+			.ButtonVirtualKeycode = ksp.RightThumbstickDownLeft,
+			.UsesInfiniteRepeat = true,
+			.ExclusivityGrouping = MouseExGroup,
+			.OnDown = []()
+			{
+				Utilities::SendMouseMove(-1, -1);
+			},
+			.OnRepeat = []()
+			{
+				Utilities::SendMouseMove(-1, -1);
+			},
+			.DelayBeforeFirstRepeat = FirstDelay,
+			.DelayForRepeats = RepeatDelay
+		},
+	};
 
 	return mapBuffer;
 }
@@ -255,66 +262,241 @@ auto GetDriverMouseMappings()
 inline
 void TranslationLoop(const sds::KeyboardSettingsPack& settingsPack, sds::KeyboardTranslator<>& translator, const std::chrono::nanoseconds sleepDelay)
 {
-    using namespace std::chrono_literals;
+	using namespace std::chrono_literals;
 	const auto translation = translator.GetUpdatedState(GetWrappedLegacyApiStateUpdate(settingsPack));
 	translation();
 	nanotime_sleep(sleepDelay.count());
 }
 
+// Sleeps until the earlier of the translator's next repeat/reset deadline and the next poll, so repeats are sent on time
+// and an idle translator only wakes to poll.
+inline
+void SleepUntilNextWake(sds::KeyboardTranslator<>& translator, const TimeManagement::TimePoint_t updateTime, const std::chrono::nanoseconds pollDelay)
+{
+	auto wakeTime = updateTime + pollDelay;
+	if (const auto nextDeadline = translator.GetNextDeadline())
+		wakeTime = std::min(wakeTime, *nextDeadline);
+	const auto sleepDelay = wakeTime - TimeManagement::Clock_t::now();
+	if (sleepDelay > std::chrono::nanoseconds{})
+		nanotime_sleep(sleepDelay.count());
+}
+
+// Loop mode that sleeps until the next repeat/reset deadline or the next poll, see SleepUntilNextWake.
+inline
+void TranslationLoopUntilNextDeadline(const sds::KeyboardSettingsPack& settingsPack, sds::KeyboardTranslator<>& translator, const std::chrono::nanoseconds pollDelay)
+{
+	const auto updateTime = TimeManagement::Clock_t::now();
+	const auto translation = translator.GetUpdatedState(GetWrappedLegacyApiStateUpdate(settingsPack), updateTime);
+	translation();
+
+	SleepUntilNextWake(translator, updateTime, pollDelay);
+}
+
+// Loop mode that only polls and translates, the callbacks are run on the pipeline's executor thread so a slow callback does not delay the next poll.
+inline
+void TranslationLoopPipelined(
+	const sds::KeyboardSettingsPack& settingsPack,
+	const sds::ControllerKeyIndexTable& keyTable,
+	sds::KeyboardTranslator<>& translator,
+	sds::TranslationEventPipeline<>& pipeline,
+	sds::TranslationEventBuffer_t& translationEvents,
+	sds::UnchangedInputGate& inputGate,
+	sds::ControllerConnectionMonitor<sds::LegacyApiConnectionProbe>& connectionMonitor,
+	const std::chrono::nanoseconds pollDelay)
+{
+	const auto updateTime = TimeManagement::Clock_t::now();
+	// Only a live pad is polled, the monitor thread probes the empty slot. A disconnected pad reads as all released.
+	const auto playerId = settingsPack.PlayerInfo.PlayerId;
+	std::optional<sds::ControllerState> polledState;
+	if (connectionMonitor.IsConnected(static_cast<std::size_t>(playerId)))
+	{
+		polledState = sds::TryGetLegacyApiStateUpdate(playerId);
+		if (!polledState.has_value())
+			connectionMonitor.ReportDisconnected(static_cast<std::size_t>(playerId));
+	}
+	// An unchanged packet number (or down mask) with no deadline passed is not decoded nor translated.
+	const auto downMask = inputGate.GetChangedDownMask(polledState.value_or(sds::ControllerState{}), translator.IsIdleAt(updateTime),
+		[&](const sds::ControllerState& state) { return keyTable.GetDownMask(sds::DecodeControllerKeyMask(settingsPack.Settings, state)); });
+	if (downMask.has_value())
+	{
+		translator.FillUpdatedEventsFromMask(*downMask, updateTime, translationEvents);
+		pipeline.Submit(translator.GetEventDispatcher(), translationEvents);
+	}
+
+	SleepUntilNextWake(translator, updateTime, pollDelay);
+}
+
+// Loop mode that drains the XInput keystroke queue instead of polling the state, every key event of the tick is translated in order (a tap
+// shorter than the tick included). Callbacks are run on the pipeline's executor thread.
+inline
+void TranslationLoopKeystrokes(
+	sds::KeystrokeDecoder& keystrokeDecoder,
+	const sds::ControllerKeyIndexTable& keyTable,
+	sds::KeyboardTranslator<>& translator,
+	sds::TranslationEventPipeline<>& pipeline,
+	sds::TranslationEventBuffer_t& translationEvents,
+	const sds::LegacyApiKeystrokeSource& keystrokeSource,
+	sds::KeystrokeBuffer_t& keystrokes,
+	sds::ControllerKeyUpdates_t& keyUpdates,
+	sds::ControllerConnectionMonitor<sds::LegacyApiConnectionProbe>& connectionMonitor,
+	const std::chrono::nanoseconds pollDelay)
+{
+	const auto updateTime = TimeManagement::Clock_t::now();
+	keystrokes.clear();
+	// Only a live pad's queue is drained, the monitor thread probes the empty slot. A disconnected controller releases the keys held.
+	const auto playerId = static_cast<std::size_t>(keystrokeSource.PlayerId);
+	if (!connectionMonitor.IsConnected(playerId))
+	{
+		keystrokeDecoder.Reset();
+	}
+	else if (!keystrokeSource.DrainKeystrokes(keystrokes))
+	{
+		connectionMonitor.ReportDisconnected(playerId);
+		keystrokeDecoder.Reset();
+	}
+	keystrokeDecoder.Decode(keystrokes, keyUpdates);
+	for (const auto controllerKeys : keyUpdates)
+	{
+		translator.FillUpdatedEventsFromMask(keyTable.GetDownMask(controllerKeys), updateTime, translationEvents);
+		pipeline.Submit(translator.GetEventDispatcher(), translationEvents);
+	}
+
+	SleepUntilNextWake(translator, updateTime, pollDelay);
+}
+
+// Loop mode that translates the freshest sample published by the poller thread, acquisition happens on that thread instead of in this loop.
+inline
+void TranslationLoopFromPoller(
+	auto& poller,
+	sds::KeyboardTranslator<>& translator,
+	sds::TranslationEventPipeline<>& pipeline,
+	sds::TranslationEventBuffer_t& translationEvents,
+	const std::chrono::nanoseconds pollDelay)
+{
+	const auto updateTime = TimeManagement::Clock_t::now();
+	translator.FillUpdatedEventsFromMask(poller.GetLatest().DownMask, updateTime, translationEvents);
+	pipeline.Submit(translator.GetEventDispatcher(), translationEvents);
+
+	SleepUntilNextWake(translator, updateTime, pollDelay);
+}
+
 auto RunTestDriverLoop()
 {
-    using namespace std::chrono_literals;
-
-    // Building mappings buffer
-    auto mapBuffer = GetDriverButtonMappings();
-    mapBuffer.append_range(GetDriverMouseMappings());
-
-    std::cout << std::vformat("Created mappings buffer with {} mappings. Total size: {} bytes.\n", std::make_format_args(mapBuffer.size(), sizeof(mapBuffer.front())*mapBuffer.size()));
-
-    // Creating a few polling/translation related types
-    sds::KeyboardSettingsPack settingsPack{};
-    // The filter is constructed here, to support custom filters with their own construction needs.
-    sds::KeyboardOvertakingFilter filter{};
-    // Filter is then moved into the translator at construction.
-    sds::KeyboardTranslator translator{ std::move(mapBuffer), std::move(filter) };
-
-    constexpr auto SleepDelay = std::chrono::nanoseconds{ 500us };
-    static constexpr std::size_t IterationsForTiming{ 10'000 };
-    std::size_t iterationCount{};
-    auto startTime{ std::chrono::steady_clock::now() };
-    const auto updateLoopTimer = [&startTime, &iterationCount](const std::chrono::nanoseconds sleepDelay)
-    {
-        ++iterationCount;
-        if(iterationCount >= IterationsForTiming)
-        {
-            const auto endTime = std::chrono::steady_clock::now();
-            const auto diffTime = endTime - startTime;
-            const auto timePerIter = std::chrono::duration_cast<std::chrono::microseconds>(diffTime / IterationsForTiming - sleepDelay);
-            std::cout << "Average time over " << IterationsForTiming << " iterations, per iteration: " << timePerIter << '\n';
-
-            iterationCount = {};
-            startTime = std::chrono::steady_clock::now();
-        }
-    };
-
-    GetterExitCallable gec;
-    const auto exitFuture = std::async(std::launch::async, [&]() { gec.GetExitSignal(); });
-    while (!gec.IsDone)
-    {
-        TranslationLoop(settingsPack, translator, SleepDelay);
-        updateLoopTimer(SleepDelay);
-    }
-    std::cout << "Performing cleanup actions...\n";
-    const auto cleanupTranslations = translator.GetCleanupActions();
-    for (auto& cleanupAction : cleanupTranslations)
-        cleanupAction();
-
-    exitFuture.wait();
+	using namespace std::chrono_literals;
+
+	// Building mappings buffer
+	auto mapBuffer = GetDriverButtonMappings();
+	mapBuffer.append_range(GetDriverMouseMappings());
+
+	std::cout << std::vformat("Created mappings buffer with {} mappings. Total size: {} bytes.\n", std::make_format_args(mapBuffer.size(), sizeof(mapBuffer.front())*mapBuffer.size()));
+
+	// Creating a few polling/translation related types
+	sds::KeyboardSettingsPack settingsPack{};
+	// Integer stick direction classification, no float trig functions on every poll.
+	settingsPack.Settings.StickDirectionClassifier = sds::StickClassifier::IntegerOctant;
+	// The filter is constructed here, to support custom filters with their own construction needs.
+	sds::KeyboardOvertakingFilter filter{};
+	// Filter is then moved into the translator at construction.
+	sds::KeyboardTranslator translator{ std::move(mapBuffer), std::move(filter) };
+
+	constexpr auto SleepDelay = std::chrono::nanoseconds{ 500us };
+	// Sleep until the next repeat/reset deadline (or the next poll), instead of a fixed period.
+	constexpr bool SleepsUntilNextDeadline{ true };
+	// Run the mapping callbacks on an executor thread, instead of on the polling thread.
+	constexpr bool RunsCallbacksOnExecutorThread{ true };
+	sds::TranslationEventPipeline<> pipeline{ translator.GetProfile() };
+	sds::TranslationEventBuffer_t translationEvents;
+	// Acquire the controller state on a poller thread, the loop translates the freshest sample (needs the executor thread mode).
+	constexpr bool AcquiresOnPollerThread{ false };
+	// Acquire from the XInput keystroke queue instead of polling the state (needs the executor thread mode).
+	constexpr bool AcquiresKeystrokes{ false };
+	// Controller key to mapping index table, for the branchless state decoder.
+	const sds::ControllerKeyIndexTable keyTable{ translator.GetKeyIndexMap(), settingsPack.Settings };
+	// Skip-unchanged fast path of the pipelined loop, keyed on the XInput packet number.
+	sds::UnchangedInputGate inputGate{};
+	// Hot-plug monitor of the player's slot, the pipelined and keystroke loops read its cached connected flag instead of calling XInput on an empty slot.
+	sds::ControllerConnectionMonitor<sds::LegacyApiConnectionProbe> connectionMonitor{ {}, static_cast<std::size_t>(settingsPack.PlayerInfo.PlayerId) + 1 };
+	auto pollDownMask = [&settingsPack, &keyTable]()
+	{
+		return GetWrappedLegacyApiStateUpdate(settingsPack, keyTable);
+	};
+	// Event queue acquisition state, used with AcquiresKeystrokes.
+	sds::KeystrokeDecoder keystrokeDecoder{ static_cast<std::size_t>(settingsPack.PlayerInfo.PlayerId) };
+	const sds::LegacyApiKeystrokeSource keystrokeSource{ .PlayerId = settingsPack.PlayerInfo.PlayerId };
+	sds::KeystrokeBuffer_t keystrokes;
+	sds::ControllerKeyUpdates_t keyUpdates;
+	std::optional<sds::LatestValuePoller<decltype(pollDownMask)>> poller;
+	if constexpr (AcquiresOnPollerThread)
+		poller.emplace(pollDownMask, SleepDelay);
+	static constexpr std::size_t IterationsForTiming{ 10'000 };
+	std::size_t iterationCount{};
+	auto startTime{ std::chrono::steady_clock::now() };
+	const auto updateLoopTimer = [&startTime, &iterationCount](const std::chrono::nanoseconds sleepDelay)
+	{
+		++iterationCount;
+		if(iterationCount >= IterationsForTiming)
+		{
+			const auto endTime = std::chrono::steady_clock::now();
+			const auto diffTime = endTime - startTime;
+			const auto timePerIter = std::chrono::duration_cast<std::chrono::microseconds>(diffTime / IterationsForTiming - sleepDelay);
+			std::cout << "Average time over " << IterationsForTiming << " iterations, per iteration: " << timePerIter << '\n';
+
+			iterationCount = {};
+			startTime = std::chrono::steady_clock::now();
+		}
+	};
+
+	GetterExitCallable gec;
+	const auto exitFuture = std::async(std::launch::async, [&]() { gec.GetExitSignal(); });
+	while (!gec.IsDone)
+	{
+		if constexpr (RunsCallbacksOnExecutorThread && AcquiresKeystrokes)
+			TranslationLoopKeystrokes(keystrokeDecoder, keyTable, translator, pipeline, translationEvents, keystrokeSource, keystrokes, keyUpdates, connectionMonitor, SleepDelay);
+		else if constexpr (RunsCallbacksOnExecutorThread && AcquiresOnPollerThread)
+			TranslationLoopFromPoller(*poller, translator, pipeline, translationEvents, SleepDelay);
+		else if constexpr (RunsCallbacksOnExecutorThread)
+			TranslationLoopPipelined(settingsPack, keyTable, translator, pipeline, translationEvents, inputGate, connectionMonitor, SleepDelay);
+		else if constexpr (SleepsUntilNextDeadline)
+			TranslationLoopUntilNextDeadline(settingsPack, translator, SleepDelay);
+		else
+			TranslationLoop(settingsPack, translator, SleepDelay);
+		updateLoopTimer(SleepDelay);
+	}
+	// Runs the callbacks still queued, the cleanup actions are then performed on this thread.
+	if (poller)
+		poller->Stop();
+	pipeline.Stop();
+	if (poller && poller->GetStats().ConsumedCount > 0)
+	{
+		const auto& pollerStats = poller->GetStats();
+		const auto averageQueueDelay = std::chrono::duration_cast<std::chrono::microseconds>(pollerStats.TotalQueueDelay / pollerStats.ConsumedCount);
+		const auto maxQueueDelay = std::chrono::duration_cast<std::chrono::microseconds>(pollerStats.MaxQueueDelay);
+		std::cout << std::vformat("Poller samples consumed: {}, skipped: {}, average queue delay: {}, max queue delay: {}\n",
+			std::make_format_args(pollerStats.ConsumedCount, pollerStats.SkippedCount, averageQueueDelay, maxQueueDelay));
+	}
+	connectionMonitor.Stop();
+	const auto connectionProbeCount = connectionMonitor.GetProbeCount();
+	std::cout << std::vformat("Connection probes of disconnected slots: {}\n", std::make_format_args(connectionProbeCount));
+	if (const auto& gateStats = inputGate.GetStats(); gateStats.PollCount > 0)
+	{
+		const auto skipPercent = 100.0 * static_cast<double>(gateStats.PacketSkipCount + gateStats.DownMaskSkipCount) / static_cast<double>(gateStats.PollCount);
+		std::cout << std::vformat("Polls: {}, skipped unchanged packet: {}, skipped unchanged down mask: {} ({:.1f}% skipped)\n",
+			std::make_format_args(gateStats.PollCount, gateStats.PacketSkipCount, gateStats.DownMaskSkipCount, skipPercent));
+	}
+	const auto pipelineStats = pipeline.GetStats();
+	std::cout << std::vformat("Pipeline events submitted: {}, executed: {}, backpressure: {}, overflow: {}\n",
+		std::make_format_args(pipelineStats.SubmittedCount, pipelineStats.ExecutedCount, pipelineStats.BackpressureCount, pipelineStats.OverflowCount));
+	std::cout << "Performing cleanup actions...\n";
+	const auto cleanupTranslations = translator.GetCleanupActions();
+	for (auto& cleanupAction : cleanupTranslations)
+		cleanupAction();
+
+	exitFuture.wait();
 }
 
 
 // Test driver program for keyboard mapping
 int main()
 {
-    RunTestDriverLoop();
+	RunTestDriverLoop();
 }
\ No newline at end of file
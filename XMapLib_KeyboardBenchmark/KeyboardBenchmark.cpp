@@ -0,0 +1,190 @@
+// KeyboardBenchmark.cpp : Benchmark of the platform-free keyboard core, builds and runs anywhere the core does (profile with perf on Linux).
+// Usage: XMapLib_KeyboardBenchmark [update count]
+// Prints the cost per controller state update of each stage: decoding the state to the down VKs or a down mask, and the full update (decode,
+// translate, dispatch) with and without the skip-unchanged fast path.
+#include "ControllerButtonToActionMap.h"
+#include "KeyboardControllerState.h"
+#include "KeyboardSettingsPack.h"
+#include "KeyboardStateDecoder.h"
+#include "KeyboardTranslationEvents.h"
+#include "KeyboardTranslator.h"
+#include "KeyboardUnchangedInputGate.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Clock_t = std::chrono::steady_clock;
+
+	// Scripted controller input, each state is held for a number of updates so mappings go down, repeat and come up as with a player.
+	auto GetScriptedStates(const std::size_t count) -> std::vector<sds::ControllerState>
+	{
+		std::mt19937 randomEngine{ 41 };
+		std::uniform_int_distribution<int> holdDist{ 1, 400 };
+		std::uniform_int_distribution<int> triggerDist{ 0, 255 };
+		std::uniform_int_distribution<int> stickDist{ -32768, 32767 };
+		std::bernoulli_distribution isPressed{ 0.2 };
+		std::vector<sds::ControllerState> states;
+		states.reserve(count);
+		sds::ControllerState state{};
+		while (states.size() < count)
+		{
+			++state.PacketNumber;
+			state.Buttons = 0;
+			for (const auto vk : sds::KeyboardSettings::ButtonCodeArray)
+			{
+				if (isPressed(randomEngine))
+					state.Buttons |= static_cast<std::uint16_t>(vk);
+			}
+			state.LeftTrigger = static_cast<sds::keyboardtypes::TriggerValue_t>(triggerDist(randomEngine));
+			state.RightTrigger = static_cast<sds::keyboardtypes::TriggerValue_t>(triggerDist(randomEngine));
+			state.LeftStickX = static_cast<sds::keyboardtypes::ThumbstickValue_t>(stickDist(randomEngine));
+			state.LeftStickY = static_cast<sds::keyboardtypes::ThumbstickValue_t>(stickDist(randomEngine));
+			state.RightStickX = static_cast<sds::keyboardtypes::ThumbstickValue_t>(stickDist(randomEngine));
+			state.RightStickY = static_cast<sds::keyboardtypes::ThumbstickValue_t>(stickDist(randomEngine));
+			for (auto holdCount = holdDist(randomEngine); holdCount > 0 && states.size() < count; --holdCount)
+				states.emplace_back(state);
+		}
+		return states;
+	}
+
+	// One mapping per controller key, the buttons and each stick's directions an exclusivity group as in the driver. Each callback counts its calls.
+	auto GetBenchmarkMappings(const sds::KeyboardSettings& settings, std::size_t& callbackCount) -> std::vector<sds::CBActionMap>
+	{
+		constexpr sds::keyboardtypes::GrpVal_t PadButtonsGroup{ 111 };
+		constexpr sds::keyboardtypes::GrpVal_t LeftThumbGroup{ 101 };
+		constexpr sds::keyboardtypes::GrpVal_t RightThumbGroup{ 102 };
+		const auto virtualKeys = sds::GetControllerKeyVirtualKeycodes(settings);
+		const auto Count = [&callbackCount]() { ++callbackCount; };
+		const auto GetGrouping = [&settings](const std::size_t bit, const sds::keyboardtypes::VirtualKey_t vk) -> sds::keyboardtypes::OptGrp_t
+		{
+			if (bit >= static_cast<std::size_t>(sds::detail::RightStickFirstBit))
+				return RightThumbGroup;
+			if (bit >= static_cast<std::size_t>(sds::detail::LeftStickFirstBit))
+				return LeftThumbGroup;
+			if (vk != settings.LeftTrigger && vk != settings.RightTrigger)
+				return PadButtonsGroup;
+			return {};
+		};
+		std::vector<sds::CBActionMap> mappings;
+		for (std::size_t bit{}; bit < virtualKeys.size(); ++bit)
+		{
+			const auto vk = virtualKeys[bit];
+			if (vk == 0)
+				continue;
+			mappings.emplace_back(sds::CBActionMap
+			{
+				.ButtonVirtualKeycode = vk,
+				.ExclusivityGrouping = GetGrouping(bit, vk),
+				.OnDown = Count,
+				.OnUp = Count,
+				.OnRepeat = Count,
+				.OnReset = Count,
+				.DelayBeforeFirstRepeat = {},
+				.DelayForRepeats = {},
+				.LastAction = {}
+			});
+		}
+		return mappings;
+	}
+
+	// Runs the stage over every state, returns the nanoseconds per state and the stage's checksum (summed results, so the work is not elided).
+	auto TimeStage(const std::vector<sds::ControllerState>& states, auto&& runStage) -> std::pair<double, std::size_t>
+	{
+		std::size_t checksum{};
+		const auto startTime = Clock_t::now();
+		for (const auto& state : states)
+			checksum += runStage(state);
+		const std::chrono::duration<double, std::nano> elapsed{ Clock_t::now() - startTime };
+		return { elapsed.count() / static_cast<double>(states.size()), checksum };
+	}
+
+	void PrintStage(const char* stageName, const std::pair<double, std::size_t>& result)
+	{
+		std::printf("%-44s %10.1f ns/update  (checksum %zu)\n", stageName, result.first, result.second);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t updateCount = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+	if (updateCount == 0)
+	{
+		std::fprintf(stderr, "Usage: %s [update count]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const sds::KeyboardSettings floatSettings{};
+	sds::KeyboardSettings integerSettings{};
+	integerSettings.StickDirectionClassifier = sds::StickClassifier::IntegerOctant;
+	const auto states = GetScriptedStates(updateCount);
+
+	std::size_t callbackCount{};
+	sds::KeyboardTranslator translator{ GetBenchmarkMappings(integerSettings, callbackCount), sds::KeyboardOvertakingFilter{} };
+	const auto& keyIndices = translator.GetKeyIndexMap();
+	const sds::ControllerKeyIndexTable keyTable{ keyIndices, integerSettings };
+
+	PrintStage("decode, VK range (float classifier)", TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		return sds::GetDownVirtualKeycodesRange(floatSettings, state).size();
+	}));
+	PrintStage("decode, loop (float classifier)", TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		return sds::GetDownVirtualKeycodesMask(floatSettings, state, keyIndices).count();
+	}));
+	PrintStage("decode, branchless (float classifier)", TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		return keyTable.GetDownMask(sds::DecodeControllerKeyMask(floatSettings, state)).count();
+	}));
+	PrintStage("decode, branchless (integer classifier)", TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		return keyTable.GetDownMask(sds::DecodeControllerKeyMask(integerSettings, state)).count();
+	}));
+
+	// The updates are a millisecond apart on a synthetic timeline, so key-repeats are produced as when polling at 1 kHz.
+	const auto dispatcher = translator.GetEventDispatcher();
+	sds::TranslationEventBuffer_t translationEvents;
+	auto updateTime = TimeManagement::TimePoint_t{ Clock_t::now() };
+	const auto fullUpdate = TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		updateTime += std::chrono::milliseconds{ 1 };
+		translator.FillUpdatedEventsFromMask(keyTable.GetDownMask(sds::DecodeControllerKeyMask(integerSettings, state)), updateTime, translationEvents);
+		dispatcher(translationEvents);
+		return translationEvents.size();
+	});
+	PrintStage("update, decode + translate + dispatch", fullUpdate);
+	std::printf("%zu updates, %zu callbacks\n", states.size(), callbackCount);
+
+	// The same updates with a fresh translator behind the skip-unchanged gate, the states are held for many updates with the same packet number.
+	std::size_t gatedCallbackCount{};
+	sds::KeyboardTranslator gatedTranslator{ GetBenchmarkMappings(integerSettings, gatedCallbackCount), sds::KeyboardOvertakingFilter{} };
+	const auto gatedDispatcher = gatedTranslator.GetEventDispatcher();
+	sds::UnchangedInputGate inputGate{};
+	updateTime = TimeManagement::TimePoint_t{ Clock_t::now() };
+	const auto gatedUpdate = TimeStage(states, [&](const sds::ControllerState& state)
+	{
+		updateTime += std::chrono::milliseconds{ 1 };
+		const auto downMask = inputGate.GetChangedDownMask(state, gatedTranslator.IsIdleAt(updateTime), [&](const sds::ControllerState& polledState)
+		{
+			return keyTable.GetDownMask(sds::DecodeControllerKeyMask(integerSettings, polledState));
+		});
+		if (!downMask.has_value())
+			return std::size_t{};
+		gatedTranslator.FillUpdatedEventsFromMask(*downMask, updateTime, translationEvents);
+		gatedDispatcher(translationEvents);
+		return translationEvents.size();
+	});
+	PrintStage("update, skip-unchanged fast path", gatedUpdate);
+	const auto& gateStats = inputGate.GetStats();
+	std::printf("%zu polls, %zu skipped unchanged packet, %zu skipped unchanged down mask\n", gateStats.PollCount, gateStats.PacketSkipCount, gateStats.DownMaskSkipCount);
+
+	// A run that translated nothing is a broken benchmark, not a fast one. The fast path must not change the translation.
+	const bool isFullUpdateValid = fullUpdate.second > 0 && callbackCount == fullUpdate.second;
+	const bool isGatedUpdateValid = gatedUpdate.second == fullUpdate.second && gatedCallbackCount == callbackCount;
+	return isFullUpdateValid && isGatedUpdateValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,186 @@
+// EvdevReplay.cpp : Linux tool of the evdev backend, replays an input_event stream through the keyboard core's decoders.
+// Usage: XMapLib_KeyboardEvdevReplay [event device or recording]
+//        XMapLib_KeyboardEvdevReplay --self-test
+// Prints the down controller keys of each state update read from the device, a recorded event file (evemu-record does not write the raw
+// format, cat of the device node does) or stdin. The self-test writes a scripted stream to a pipe and checks the down keys decoded from it.
+#include "KeyboardControllerState.h"
+#include "KeyboardEvdevBackend.h"
+#include "KeyboardEvdevDecoder.h"
+#include "KeyboardSettingsPack.h"
+#include "KeyboardStateDecoder.h"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	constexpr sds::KeyboardSettings Settings{};
+
+	auto GetSortedDownKeys(const sds::ControllerState& state) -> std::vector<sds::keyboardtypes::VirtualKey_t>
+	{
+		const auto downKeys = sds::GetDownVirtualKeycodesRange(Settings, state);
+		std::vector<sds::keyboardtypes::VirtualKey_t> sortedKeys(downKeys.begin(), downKeys.end());
+		std::ranges::sort(sortedKeys);
+		return sortedKeys;
+	}
+
+	auto MakeRawEvent(const std::uint16_t type, const std::uint16_t code, const std::int32_t value) -> input_event
+	{
+		input_event rawEvent{};
+		rawEvent.type = type;
+		rawEvent.code = code;
+		rawEvent.value = value;
+		return rawEvent;
+	}
+
+	auto Replay(const int fd) -> int
+	{
+		sds::EvdevControllerSource source{ fd };
+		sds::ControllerStateBuffer_t states;
+		bool isConnected{ true };
+		while (isConnected)
+		{
+			std::ignore = source.WaitForEvents(std::chrono::milliseconds{ 100 });
+			states.clear();
+			isConnected = source.DrainStates(states);
+			for (const auto& state : states)
+			{
+				std::printf("packet %u: down", static_cast<unsigned>(state.PacketNumber));
+				for (const auto vk : GetSortedDownKeys(state))
+					std::printf(" 0x%X", static_cast<unsigned>(vk));
+				std::printf("\n");
+			}
+		}
+		const auto lastError = source.GetReader().GetLastError();
+		if (lastError != 0)
+			std::printf("Read error: %s\n", std::strerror(lastError));
+		return lastError == 0 || lastError == ENODEV ? 0 : 1;
+	}
+
+	// Writes the events to the pipe in small chunks, so that events are split across reads.
+	void WriteChunked(const int fd, const std::vector<input_event>& rawEvents)
+	{
+		constexpr std::size_t ChunkSize{ 10 };
+		const auto* bytes = reinterpret_cast<const char*>(rawEvents.data());
+		const auto totalSize = rawEvents.size() * sizeof(input_event);
+		for (std::size_t offset{}; offset < totalSize; offset += ChunkSize)
+		{
+			const auto chunkSize = std::min(ChunkSize, totalSize - offset);
+			if (write(fd, bytes + offset, chunkSize) != static_cast<ssize_t>(chunkSize))
+				return;
+			std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+		}
+	}
+
+	auto SelfTest() -> int
+	{
+		using namespace sds::evdevcodes;
+		int failureCount{};
+		const auto Check = [&failureCount](const bool isPassed, const char* message)
+		{
+			if (!isPassed)
+			{
+				std::printf("FAILED: %s\n", message);
+				++failureCount;
+			}
+		};
+
+		// A batch of events is read by a single read() call.
+		{
+			int pipeFds[2]{};
+			Check(pipe(pipeFds) == 0, "pipe");
+			std::vector<input_event> rawEvents;
+			for (std::size_t i{}; i < sds::EvdevEventReader::BatchSize; ++i)
+				rawEvents.emplace_back(MakeRawEvent(EventAbs, AxisX, static_cast<std::int32_t>(i)));
+			WriteChunked(pipeFds[1], rawEvents);
+			const int originalFlags = fcntl(pipeFds[0], F_GETFL);
+			{
+				sds::EvdevEventReader reader{ pipeFds[0] };
+				sds::EvdevEventBuffer_t events;
+				Check(reader.Read(events) == sds::EvdevReadStatus::Events && events.size() == sds::EvdevEventReader::BatchSize, "batch not read by one read()");
+				Check(reader.Read(events) == sds::EvdevReadStatus::WouldBlock, "empty pipe read blocked or failed");
+				close(pipeFds[1]);
+				Check(reader.Read(events) == sds::EvdevReadStatus::EndOfStream, "closed pipe not the end of the stream");
+			}
+			// The descriptor is left as the caller had it, blocking.
+			Check(fcntl(pipeFds[0], F_GETFL) == originalFlags && (originalFlags & O_NONBLOCK) == 0, "descriptor flags not restored");
+			close(pipeFds[0]);
+		}
+
+		// The down keys of a scripted stream, written in chunks that split the events.
+		int pipeFds[2]{};
+		Check(pipe(pipeFds) == 0, "pipe");
+		const std::vector<input_event> rawEvents{
+			// A tap, both reports within a read.
+			MakeRawEvent(EventKey, ButtonA, 1), MakeRawEvent(EventSyn, SynReport, 0),
+			MakeRawEvent(EventKey, ButtonA, 0), MakeRawEvent(EventSyn, SynReport, 0),
+			// Left stick up (evdev negative) and right.
+			MakeRawEvent(EventAbs, AxisX, 30000), MakeRawEvent(EventAbs, AxisY, -30000), MakeRawEvent(EventSyn, SynReport, 0),
+			// Stick centered, right trigger past the threshold.
+			MakeRawEvent(EventAbs, AxisX, 0), MakeRawEvent(EventAbs, AxisY, 0), MakeRawEvent(EventAbs, AxisRz, 200), MakeRawEvent(EventSyn, SynReport, 0),
+			// Hat up.
+			MakeRawEvent(EventAbs, AxisHat0Y, -1), MakeRawEvent(EventSyn, SynReport, 0),
+			// Dropped events, discarded up to the report.
+			MakeRawEvent(EventSyn, SynDropped, 0), MakeRawEvent(EventKey, ButtonB, 1), MakeRawEvent(EventSyn, SynReport, 0),
+			// Everything released.
+			MakeRawEvent(EventAbs, AxisHat0Y, 0), MakeRawEvent(EventAbs, AxisRz, 0), MakeRawEvent(EventSyn, SynReport, 0) };
+		std::jthread writerThread{ [&]()
+		{
+			WriteChunked(pipeFds[1], rawEvents);
+			close(pipeFds[1]);
+		} };
+
+		sds::EvdevControllerSource source{ pipeFds[0] };
+		sds::ControllerStateBuffer_t states;
+		const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+		while (source.IsConnected() && std::chrono::steady_clock::now() < endTime)
+		{
+			std::ignore = source.WaitForEvents(std::chrono::milliseconds{ 100 });
+			source.DrainStates(states);
+		}
+		writerThread.join();
+		close(pipeFds[0]);
+
+		using VirtualKeys_t = std::vector<sds::keyboardtypes::VirtualKey_t>;
+		const std::vector<VirtualKeys_t> expectedKeys{ { Settings.ButtonA }, {}, { Settings.LeftThumbstickUpRight }, { Settings.RightTrigger },
+			{ Settings.DpadUp, Settings.RightTrigger }, {}, {} };
+		Check(!source.IsConnected(), "end of the stream not a disconnection");
+		Check(states.size() == expectedKeys.size(), "state count");
+		for (std::size_t i{}; i < std::min(states.size(), expectedKeys.size()); ++i)
+		{
+			auto expected = expectedKeys[i];
+			std::ranges::sort(expected);
+			Check(GetSortedDownKeys(states[i]) == expected, "down keys of a state");
+			Check(states[i].PacketNumber == i + 1, "packet number of a state");
+		}
+		std::printf("Evdev replay self-test: %zu states decoded, %d failures.\n", states.size(), failureCount);
+		return failureCount == 0 ? 0 : 1;
+	}
+}
+
+auto main(const int argc, char* argv[]) -> int
+{
+	if (argc > 1 && std::string_view{ argv[1] } == "--self-test")
+		return SelfTest();
+	if (argc <= 1)
+		return Replay(STDIN_FILENO);
+	const int fd = open(argv[1], O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+	{
+		std::printf("Cannot open %s: %s\n", argv[1], std::strerror(errno));
+		return 1;
+	}
+	const int result = Replay(fd);
+	close(fd);
+	return result;
+}
@@ -6,21 +6,20 @@
 #define NOMINMAX
 #endif
 #include <Windows.h>
+#include <Xinput.h>
 
 namespace sds
 {
 	namespace ControllerStatus
 	{
-		// Returns controller connected status.
+		// Returns controller connected status. A single XInputGetState call, it is expensive on an empty slot: a polling loop should read the
+		// cached flag of a ControllerConnectionMonitor instead.
 		[[nodiscard]]
 		inline
 		bool IsControllerConnected(const int pid) noexcept
 		{
-			XINPUT_KEYSTROKE keystrokeObj{};
 			XINPUT_STATE stateObj{};
-			const auto xsRet = XInputGetState(pid, &stateObj);
-			const DWORD ret = XInputGetKeystroke(pid, 0, &keystrokeObj);
-			return (ret == ERROR_SUCCESS || ret == ERROR_EMPTY) && (xsRet == ERROR_SUCCESS || xsRet == ERROR_EMPTY);
+			return XInputGetState(pid, &stateObj) == ERROR_SUCCESS;
 		}
 	}
 }
\ No newline at end of file
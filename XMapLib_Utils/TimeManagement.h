@@ -10,40 +10,52 @@ namespace TimeManagement
 	using Clock_t = chron::steady_clock;
 	using TimePoint_t = chron::time_point <Clock_t, Nanos_t>;
 
+	//concept for a clock policy, something with a static now() producing a TimePoint_t. Used to inject a clock (a fake one for testing, for example).
+	template<typename T>
+	concept IsClockPolicy = requires
+	{
+		{ T::now() } -> std::convertible_to<TimePoint_t>;
+	};
+
 	//concept for DelayTimer or something usable as such.
 	template<typename T>
 	concept IsDelayTimer = requires(T & t)
 	{
 		{ T(std::chrono::seconds(1)) };
 		{ t.IsElapsed() } -> std::convertible_to<bool>;
+		{ t.IsElapsed(TimePoint_t{}) } -> std::convertible_to<bool>;
 		{ t.Reset(std::chrono::seconds{ 5 }) };
 		{ t.Reset() };
+		{ t.Reset(TimePoint_t{}) };
 		{ t.GetTimerPeriod() } -> std::convertible_to<Nanos_t>;
 	};
 
 	/**
-	 * \brief	DelayTimer manages a non-blocking time delay, it provides functionality described by the IsDelayTimer concept.
+	 * \brief	BasicDelayTimer manages a non-blocking time delay, it provides functionality described by the IsDelayTimer concept.
 	 * \remarks	The start time begins when the object is constructed with a duration, or when Reset() is called. The current period/duration
 	 * 		can be retrieved with GetTimerPeriod(), and the timer can be reset with a new duration with Reset(...).
+	 *	<p>The overloads taking a time point use it in place of sampling the clock, so that a caller can sample the clock once and judge many timers
+	 *	against the same instant.</p>
 	 */
-	class DelayTimer
+	template<IsClockPolicy ClockPolicy_t = Clock_t>
+	class BasicDelayTimer
 	{
-		TimePoint_t m_start_time{ Clock_t::now() };
+		TimePoint_t m_start_time{ ClockPolicy_t::now() };
 		Nanos_t m_delayTime{}; // this should remain nanoseconds to ensure maximum granularity when Reset() with a different type.
 		mutable bool m_has_fired{ false };
 	public:
 		// There is not really such a thing as a default timer period, so this is deleted.
-		DelayTimer() = delete;
+		BasicDelayTimer() = delete;
 		/**
 		 * \brief	Construct a DelayTimer with a chrono duration type.
 		 * \param duration	Duration in nanoseconds (or any std::chrono duration type)
 		 */
-		explicit DelayTimer(Nanos_t duration) noexcept : m_delayTime(duration) { }
-		DelayTimer(const DelayTimer& other) = default;
-		DelayTimer(DelayTimer&& other) = default;
-		DelayTimer& operator=(const DelayTimer& other) = default;
-		DelayTimer& operator=(DelayTimer&& other) = default;
-		~DelayTimer() = default;
+		explicit BasicDelayTimer(Nanos_t duration) noexcept : m_delayTime(duration) { }
+		BasicDelayTimer(const BasicDelayTimer& other) = default;
+		BasicDelayTimer(BasicDelayTimer&& other) = default;
+		BasicDelayTimer& operator=(const BasicDelayTimer& other) = default;
+		BasicDelayTimer& operator=(BasicDelayTimer&& other) = default;
+		~BasicDelayTimer() = default;
 	public:
 		/**
 		 * \brief	Check for elapsed.
@@ -51,7 +63,16 @@ namespace TimeManagement
 		 */
 		[[nodiscard]] bool IsElapsed() const noexcept
 		{
-			if (Clock_t::now() > (m_start_time + m_delayTime))
+			return IsElapsed(ClockPolicy_t::now());
+		}
+		/**
+		 * \brief	Check for elapsed, as of the provided time point.
+		 * \param timePoint	The current time, as sampled by the caller.
+		 * \return	true if timer has elapsed, false otherwise
+		 */
+		[[nodiscard]] bool IsElapsed(const TimePoint_t timePoint) const noexcept
+		{
+			if (timePoint > (m_start_time + m_delayTime))
 			{
 				m_has_fired = true;
 				return true;
@@ -64,7 +85,16 @@ namespace TimeManagement
 		 */
 		void Reset(const Nanos_t delay) noexcept
 		{
-			m_start_time = Clock_t::now();
+			Reset(delay, ClockPolicy_t::now());
+		}
+		/**
+		 * \brief	Reset timer with chrono duration type, starting at the provided time point.
+		 * \param delay		Delay in nanoseconds (or any std::chrono duration type)
+		 * \param timePoint	The new start time, as sampled by the caller.
+		 */
+		void Reset(const Nanos_t delay, const TimePoint_t timePoint) noexcept
+		{
+			m_start_time = timePoint;
 			m_has_fired = false;
 			m_delayTime = { delay };
 		}
@@ -73,9 +103,24 @@ namespace TimeManagement
 		 */
 		void Reset() noexcept
 		{
-			m_start_time = Clock_t::now();
+			Reset(ClockPolicy_t::now());
+		}
+		/**
+		 * \brief	Reset timer to last used duration value, starting at the provided time point.
+		 * \param timePoint	The new start time, as sampled by the caller.
+		 */
+		void Reset(const TimePoint_t timePoint) noexcept
+		{
+			m_start_time = timePoint;
 			m_has_fired = false;
 		}
+		/**
+		 * \brief	Gets the time point after which the timer is elapsed.
+		 */
+		[[nodiscard]] auto GetExpiryTime() const noexcept -> TimePoint_t
+		{
+			return m_start_time + m_delayTime;
+		}
 		/**
 		 * \brief	Gets the current timer period/duration for elapsing.
 		 */
@@ -85,4 +130,7 @@ namespace TimeManagement
 		}
 	};
 
+	using DelayTimer = BasicDelayTimer<>;
+	static_assert(IsDelayTimer<DelayTimer>);
+
 }
\ No newline at end of file